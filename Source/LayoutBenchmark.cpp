@@ -0,0 +1,100 @@
+#include "PDBLayoutReader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Measures lookup latency against a layout file written with -f b:
+//   pdbex_layout_bench <layout file> [iterations]
+//
+
+namespace
+{
+    template <typename FUNC>
+    double MeasureNanosecondsPerCall(size_t iterations, size_t callsPerIteration, FUNC&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            func();
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double calls = static_cast<double>(iterations) * static_cast<double>(callsPerIteration);
+
+        return calls != 0 ? std::chrono::duration<double, std::nano>(elapsed).count() / calls : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <layout file> [iterations]" << std::endl;
+        return 1;
+    }
+
+    const size_t iterations = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100;
+
+    const auto openStart = std::chrono::steady_clock::now();
+
+    PDBLayoutReader reader;
+    if (!reader.Open(argv[1]))
+    {
+        std::cerr << "Cannot open layout file " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const auto openElapsed = std::chrono::steady_clock::now() - openStart;
+
+    std::vector<std::string> typeNames;
+    std::vector<std::string> fieldPaths;
+
+    for (uint32_t i = 0; i < reader.GetTypeCount(); ++i)
+    {
+        const auto* type = reader.GetType(i);
+        typeNames.push_back(reader.GetString(type->nameOffset));
+
+        for (uint32_t j = 0; j < type->fieldCount; ++j)
+        {
+            const auto* field = reader.GetField(type->firstField + j);
+
+            if (!(field->flags & PDBLayoutFieldStatic))
+            {
+                fieldPaths.push_back(typeNames.back() + '.' + reader.GetString(field->nameOffset));
+            }
+        }
+    }
+
+    size_t found = 0;
+
+    const double findType = MeasureNanosecondsPerCall(iterations, typeNames.size(), [&]()
+    {
+        for (const auto& typeName : typeNames)
+        {
+            found += reader.FindType(typeName) != nullptr;
+        }
+    });
+
+    const double getFieldOffset = MeasureNanosecondsPerCall(iterations, fieldPaths.size(), [&]()
+    {
+        uint32_t offset;
+        for (const auto& fieldPath : fieldPaths)
+        {
+            found += reader.GetFieldOffset(fieldPath, offset);
+        }
+    });
+
+    std::cout << "open:           " << std::chrono::duration<double, std::micro>(openElapsed).count() << " us" << std::endl;
+    std::cout << "types:          " << typeNames.size() << std::endl;
+    std::cout << "fields:         " << fieldPaths.size() << std::endl;
+    std::cout << "FindType:       " << findType << " ns/lookup" << std::endl;
+    std::cout << "GetFieldOffset: " << getFieldOffset << " ns/lookup" << std::endl;
+
+    // Keeps the lookups from being optimized away.
+    return found == 0 && !typeNames.empty() ? 1 : 0;
+}
@@ -1,13 +1,36 @@
 #include "PDB.h"
 #include "PDBCallback.h"
+#include "SymbolAddressIndex.h"
+#include "SymbolFieldIndex.h"
+#include "SymbolInlineIndex.h"
+#include "SymbolLineTable.h"
+#include "SymbolNameIndex.h"
+#include "SymbolReferenceIndex.h"
 
 #include <cassert>
 #include <functional>
 
 SymbolModuleBase::SymbolModuleBase()
 {
-    HRESULT hr = CoInitialize(nullptr);
-    assert(hr == S_OK);
+    // S_FALSE when this thread already has COM, e.g. for a second PDB
+    // opened on the same worker; both are balanced by the destructor.
+    // RPC_E_CHANGED_MODE when the thread is in the multithreaded
+    // apartment, which DIA works in as well.
+    const HRESULT hr = CoInitialize(nullptr);
+    assert(SUCCEEDED(hr) || hr == RPC_E_CHANGED_MODE);
+
+    m_comInitialized = SUCCEEDED(hr);
+}
+
+SymbolModuleBase::~SymbolModuleBase()
+{
+    // The interfaces go before COM does.
+    SymbolModuleBase::Close();
+
+    if (m_comInitialized)
+    {
+        CoUninitialize();
+    }
 }
 
 HRESULT SymbolModuleBase::LoadDiaViaCoCreateInstance()
@@ -99,8 +122,6 @@ void SymbolModuleBase::Close()
     m_globalSymbol.Release();
     m_session.Release();
     m_dataSource.Release();
-
-    CoUninitialize();
 }
 
 bool SymbolModuleBase::IsOpen() const
@@ -108,25 +129,59 @@ bool SymbolModuleBase::IsOpen() const
     return m_dataSource && m_session && m_globalSymbol;
 }
 
+bool SymbolModuleBase::GetSignature(GUID& guid, DWORD& age) const
+{
+    return m_globalSymbol &&
+           m_globalSymbol->get_guid(&guid) == S_OK &&
+           m_globalSymbol->get_age(&age) == S_OK;
+}
+
+std::string SymbolModuleBase::GetSourceFileName(IDiaSourceFile* sourceFile)
+{
+    BSTR fileNameBstr;
+    if (!sourceFile || sourceFile->get_fileName(&fileNameBstr) != S_OK)
+    {
+        return {};
+    }
+
+    std::string fileName(SysStringLen(fileNameBstr) * MB_CUR_MAX + 1, '\0');
+    const size_t length = wcstombs(fileName.data(), fileNameBstr, fileName.size());
+    fileName.resize(length == static_cast<size_t>(-1) ? 0 : length);
+
+    SysFreeString(fileNameBstr);
+    return fileName;
+}
+
 SymbolModule::~SymbolModule()
 {
     Close();
 }
 
 bool SymbolModule::Open(const std::filesystem::path& path)
+{
+    if (!OpenLazy(path))
+    {
+        return false;
+    }
+
+    BuildSymbolMap();
+    return true;
+}
+
+bool SymbolModule::OpenLazy(const std::filesystem::path& path)
 {
     if (!SymbolModuleBase::Open(path))
     {
         return false;
     }
 
+    m_path = path;
     m_globalSymbol->get_machineType(&m_machineType);
 
     DWORD language = 0;
     m_globalSymbol->get_language(&language);
     m_language = static_cast<CV_CFL_LANG>(language);
 
-    BuildSymbolMap();
     return true;
 }
 
@@ -138,6 +193,8 @@ void SymbolModule::Close()
     m_symbolMap.clear();
     m_symbolNameMap.clear();
     m_symbolSet.clear();
+    m_functionSet.clear();
+    m_approximateMemoryUsage = 0;
 }
 
 const std::filesystem::path& SymbolModule::GetPath() const
@@ -189,7 +246,65 @@ std::string SymbolModule::GetSymbolName(const DiaSymbolPtr& diaSymbol, bool raw)
 SymbolPtr SymbolModule::GetSymbolByName(const std::string& symbolName)
 {
     auto it = m_symbolNameMap.find(symbolName);
-    return it == m_symbolNameMap.end() ? nullptr : it->second;
+    if (it != m_symbolNameMap.end())
+    {
+        return it->second;
+    }
+
+    if (!m_globalSymbol)
+    {
+        return nullptr;
+    }
+
+    //
+    // Not decoded (yet): ask DIA for a type with exactly this name, so a
+    // lazily opened PDB only decodes what is looked up.
+    //
+
+    std::wstring symbolNameWide(symbolName.size() + 1, L'\0');
+    const size_t length = mbstowcs(symbolNameWide.data(), symbolName.c_str(), symbolNameWide.size());
+    if (length == static_cast<size_t>(-1))
+    {
+        return nullptr;
+    }
+    symbolNameWide.resize(length);
+
+    for (auto tag : { SymTagUDT, SymTagEnum })
+    {
+        DiaEnumSymbolsPtr diaSymbolEnumerator;
+        if (FAILED(m_globalSymbol->findChildren(tag, symbolNameWide.c_str(), nsfCaseSensitive, &diaSymbolEnumerator)))
+        {
+            continue;
+        }
+
+        // Prefer the definition over forward declarations of the same name.
+        DiaSymbolPtr firstDiaSymbol;
+        DiaSymbolPtr diaSymbol;
+        ULONG fetchedSymbolCount = 0;
+
+        while (SUCCEEDED(diaSymbolEnumerator->Next(1, &diaSymbol, &fetchedSymbolCount)) && fetchedSymbolCount == 1)
+        {
+            ULONGLONG length = 0;
+            if (diaSymbol->get_length(&length) == S_OK && length != 0)
+            {
+                return GetSymbol(diaSymbol);
+            }
+
+            if (!firstDiaSymbol)
+            {
+                firstDiaSymbol = diaSymbol;
+            }
+
+            diaSymbol.Release();
+        }
+
+        if (firstDiaSymbol)
+        {
+            return GetSymbol(firstDiaSymbol);
+        }
+    }
+
+    return nullptr;
 }
 
 SymbolPtr SymbolModule::GetSymbolBySymbolIndex(DWORD symIndex)
@@ -198,6 +313,45 @@ SymbolPtr SymbolModule::GetSymbolBySymbolIndex(DWORD symIndex)
     return it == m_symbolMap.end() ? nullptr : it->second;
 }
 
+namespace
+{
+    // Rough per-entry cost of the symbol map, name map and symbol set nodes.
+    const size_t SymbolMapEntryOverhead = 3 * 64;
+
+    size_t GetApproximateSymbolSize(const Symbol& symbol)
+    {
+        size_t size = sizeof(Symbol) + symbol.name.capacity() + SymbolMapEntryOverhead;
+
+        if (const auto* symbolEnum = std::get_if<SymbolEnum>(&symbol.variant))
+        {
+            size += symbolEnum->fields.capacity() * sizeof(SymbolEnumField);
+            for (const auto& field : symbolEnum->fields)
+            {
+                size += field.name.capacity();
+            }
+        }
+        else if (const auto* symbolUdt = std::get_if<SymbolUdt>(&symbol.variant))
+        {
+            size += symbolUdt->fields.capacity() * sizeof(SymbolUdtField);
+            size += symbolUdt->baseClassFields.capacity() * sizeof(SymbolUdtBaseClass);
+            for (const auto& field : symbolUdt->fields)
+            {
+                size += field.name.capacity();
+            }
+        }
+        else if (const auto* symbolFunction = std::get_if<SymbolFunction>(&symbol.variant))
+        {
+            size += symbolFunction->arguments.capacity() * sizeof(SymbolFunctionArg);
+            for (const auto& argument : symbolFunction->arguments)
+            {
+                size += argument.name.capacity();
+            }
+        }
+
+        return size;
+    }
+}
+
 SymbolPtr SymbolModule::GetSymbol(const DiaSymbolPtr& diaSymbol)
 {
     if (!diaSymbol)
@@ -219,6 +373,7 @@ SymbolPtr SymbolModule::GetSymbol(const DiaSymbolPtr& diaSymbol)
     m_symbolSet.insert(symbol);
 
     InitSymbol(diaSymbol, symbol);
+    m_approximateMemoryUsage += GetApproximateSymbolSize(*symbol);
 
     if (!symbol->name.empty())
     {
@@ -316,7 +471,17 @@ void SymbolModule::BuildSymbolMapFromEnumerator(const DiaEnumSymbolsPtr& diaSymb
 
 void SymbolModule::BuildFunctionSetFromEnumerator(const DiaEnumSymbolsPtr& diaSymbolEnumerator)
 {
-    ForEachDiaSymbol(diaSymbolEnumerator, [this](const DiaSymbolPtr& symbol)
+    ForEachFunctionNameFromEnumerator(diaSymbolEnumerator, [this](const std::string& functionName)
+    {
+        m_functionSet.insert(functionName);
+    });
+}
+
+void SymbolModule::ForEachFunctionNameFromEnumerator(
+    const DiaEnumSymbolsPtr& diaSymbolEnumerator,
+    const std::function<void(const std::string&)>& func)
+{
+    ForEachDiaSymbol(diaSymbolEnumerator, [this, &func](const DiaSymbolPtr& symbol)
     {
         DWORD dwordResult = 0;
         symbol->get_symTag(&dwordResult);
@@ -324,8 +489,7 @@ void SymbolModule::BuildFunctionSetFromEnumerator(const DiaEnumSymbolsPtr& diaSy
         auto tag = static_cast<enum SymTagEnum>(dwordResult);
         if (tag != SymTagThunk)
         {
-            auto functionName = GetSymbolName(symbol, false);
-            m_functionSet.insert(functionName);
+            func(GetSymbolName(symbol, false));
         }
     });
 }
@@ -365,6 +529,212 @@ const FunctionSet& SymbolModule::GetFunctionSet() const
     return m_functionSet;
 }
 
+void SymbolModule::ForEachTopLevelSymbol(const std::function<void(const SymbolPtr&)>& func)
+{
+    ForEachTopLevelSymbol(nullptr, func);
+}
+
+void SymbolModule::ForEachTopLevelSymbol(
+    const std::function<bool(const std::string&)>& namePredicate,
+    const std::function<void(const SymbolPtr&)>& func)
+{
+    for (auto tag : { SymTagEnum, SymTagUDT })
+    {
+        DiaEnumSymbolsPtr diaSymbolEnumerator;
+        if (FAILED(m_globalSymbol->findChildren(tag, nullptr, nsNone, &diaSymbolEnumerator)))
+        {
+            continue;
+        }
+
+        ForEachDiaSymbol(diaSymbolEnumerator, [this, &namePredicate, &func](const DiaSymbolPtr& diaSymbol)
+        {
+            // Reading the name is cheap; only matching types get decoded.
+            if (namePredicate && !namePredicate(GetSymbolName(diaSymbol)))
+            {
+                return;
+            }
+
+            func(GetSymbol(diaSymbol));
+        });
+    }
+}
+
+void SymbolModule::ForEachFunctionName(const std::function<void(const std::string&)>& func)
+{
+    if (DiaEnumSymbolsPtr diaSymbolEnumerator; SUCCEEDED(m_globalSymbol->findChildren(SymTagPublicSymbol, nullptr, nsNone, &diaSymbolEnumerator)))
+    {
+        ForEachFunctionNameFromEnumerator(diaSymbolEnumerator, func);
+    }
+}
+
+void SymbolModule::ForEachPublicSymbol(const std::function<void(const SymbolPublic&)>& func)
+{
+    DiaEnumSymbolsPtr diaSymbolEnumerator;
+
+    if (FAILED(m_globalSymbol->findChildren(SymTagPublicSymbol, nullptr, nsNone, &diaSymbolEnumerator)))
+    {
+        return;
+    }
+
+    SymbolPublic publicSymbol;
+
+    ForEachDiaSymbol(diaSymbolEnumerator, [this, &func, &publicSymbol](const DiaSymbolPtr& symbol)
+    {
+        publicSymbol.name = GetSymbolName(symbol, false);
+
+        publicSymbol.rva = 0;
+        symbol->get_relativeVirtualAddress(&publicSymbol.rva);
+
+        publicSymbol.section = 0;
+        symbol->get_addressSection(&publicSymbol.section);
+
+        publicSymbol.offset = 0;
+        symbol->get_addressOffset(&publicSymbol.offset);
+
+        ULONGLONG length = 0;
+        symbol->get_length(&length);
+        publicSymbol.length = static_cast<DWORD>(length);
+
+        func(publicSymbol);
+    });
+}
+
+void SymbolModule::ForEachProcedure(const std::function<void(const SymbolProcedure&)>& func)
+{
+    DiaEnumSymbolsPtr diaCompilandEnumerator;
+
+    if (FAILED(m_globalSymbol->findChildren(SymTagCompiland, nullptr, nsNone, &diaCompilandEnumerator)))
+    {
+        return;
+    }
+
+    SymbolProcedure procedure;
+
+    ForEachDiaSymbol(diaCompilandEnumerator, [this, &func, &procedure](const DiaSymbolPtr& compiland)
+    {
+        DiaEnumSymbolsPtr diaSymbolEnumerator;
+
+        if (FAILED(compiland->findChildren(SymTagFunction, nullptr, nsNone, &diaSymbolEnumerator)))
+        {
+            return;
+        }
+
+        ForEachDiaSymbol(diaSymbolEnumerator, [this, &func, &procedure](const DiaSymbolPtr& symbol)
+        {
+            procedure.name = GetSymbolName(symbol, false);
+
+            procedure.rva = 0;
+            symbol->get_relativeVirtualAddress(&procedure.rva);
+
+            ULONGLONG length = 0;
+            symbol->get_length(&length);
+            procedure.length = static_cast<DWORD>(length);
+
+            procedure.symIndexId = 0;
+            symbol->get_symIndexId(&procedure.symIndexId);
+
+            func(procedure);
+        });
+    });
+}
+
+void SymbolModule::ForEachInlineSite(DWORD procedureSymIndexId, const std::function<void(const SymbolInlineSite&)>& func)
+{
+    DiaSymbolPtr diaProcedureSymbol;
+
+    if (FAILED(m_session->symbolById(procedureSymIndexId, &diaProcedureSymbol)) || !diaProcedureSymbol)
+    {
+        return;
+    }
+
+    // DIA file ids -> names
+    std::unordered_map<DWORD, std::string> fileNames;
+    uint32_t siteCount = 0;
+
+    std::function<void(const DiaSymbolPtr&, uint32_t)> visitSites = [&](const DiaSymbolPtr& parentSymbol, uint32_t parent)
+    {
+        DiaEnumSymbolsPtr diaSymbolEnumerator;
+
+        if (FAILED(parentSymbol->findChildren(SymTagInlineSite, nullptr, nsNone, &diaSymbolEnumerator)))
+        {
+            return;
+        }
+
+        ForEachDiaSymbol(diaSymbolEnumerator, [&](const DiaSymbolPtr& siteSymbol)
+        {
+            SymbolInlineSite site;
+            site.name = GetSymbolName(siteSymbol, false);
+            site.parent = parent;
+
+            // DIA decodes the binary annotations of the site into lines.
+            ATL::CComPtr<IDiaEnumLineNumbers> diaLineEnumerator;
+
+            if (SUCCEEDED(siteSymbol->findInlineeLines(&diaLineEnumerator)))
+            {
+                ULONG fetchedLineCount = 0;
+                ATL::CComPtr<IDiaLineNumber> diaLine;
+
+                while (SUCCEEDED(diaLineEnumerator->Next(1, &diaLine, &fetchedLineCount)) && fetchedLineCount == 1)
+                {
+                    SymbolInlineRange range;
+                    diaLine->get_relativeVirtualAddress(&range.rva);
+                    diaLine->get_length(&range.length);
+                    diaLine->get_lineNumber(&range.line);
+
+                    DWORD fileId = 0;
+                    diaLine->get_sourceFileId(&fileId);
+
+                    auto it = fileNames.find(fileId);
+                    if (it == fileNames.end())
+                    {
+                        ATL::CComPtr<IDiaSourceFile> diaSourceFile;
+                        diaLine->get_sourceFile(&diaSourceFile);
+
+                        it = fileNames.emplace(fileId, GetSourceFileName(diaSourceFile)).first;
+                    }
+
+                    range.file = it->second;
+                    site.ranges.push_back(std::move(range));
+
+                    diaLine.Release();
+                }
+            }
+
+            const uint32_t siteIndex = siteCount++;
+            func(site);
+
+            visitSites(siteSymbol, siteIndex + 1);
+        });
+    };
+
+    visitSites(diaProcedureSymbol, 0);
+}
+
+void SymbolModule::ReleaseDecodedSymbols()
+{
+    //
+    // Types reach each other both ways: a struct through a pointer to
+    // itself ("struct Node { Node* Next; }"), a class through the
+    // signatures of its own methods. Such cycles would keep the graph
+    // alive after the maps are cleared, so every symbol drops its members
+    // and targets first.
+    //
+    for (const auto& symbol : m_symbolSet)
+    {
+        symbol->variant = std::monostate();
+    }
+
+    m_symbolMap.clear();
+    m_symbolNameMap.clear();
+    m_symbolSet.clear();
+    m_approximateMemoryUsage = 0;
+}
+
+size_t SymbolModule::GetApproximateMemoryUsage() const
+{
+    return m_approximateMemoryUsage;
+}
+
 void SymbolModule::InitSymbol(const DiaSymbolPtr& diaSymbol, const SymbolPtr& symbol)
 {
     assert(symbol);
@@ -463,7 +833,7 @@ void SymbolModule::ProcessSymbolEnum(const DiaSymbolPtr& diaSymbol, const Symbol
         symbolEnum.fields.push_back({});
         auto& enumValue = symbolEnum.fields.back();
 
-        enumValue.parent = symbol;
+        enumValue.parent = symbol.get();
         enumValue.name = GetSymbolName(diaSymbol);
 
         VariantInit(&enumValue.value);
@@ -626,7 +996,7 @@ void SymbolModule::ProcessSymbolUdt(const DiaSymbolPtr& diaSymbol, const SymbolP
         SymbolUdtField member;
 
         member.name = GetSymbolName(diaChildSymbol);
-        member.parent = symbol;
+        member.parent = symbol.get();
         member.isBaseClass = false;
 
         member.tag = static_cast<enum SymTagEnum>(symTag);
@@ -837,19 +1207,33 @@ namespace
 PDB::PDB()
 {
     m_impl = std::make_unique<SymbolModule>();
+    m_addressIndex = std::make_unique<SymbolAddressIndex>();
+    m_fieldIndex = std::make_unique<SymbolFieldIndex>();
+    m_inlineIndex = std::make_unique<SymbolInlineIndex>();
+    m_lineTable = std::make_unique<SymbolLineTable>();
+    m_referenceIndex = std::make_unique<SymbolReferenceIndex>();
+    m_nameIndex = std::make_unique<SymbolNameIndex>();
 }
 
 PDB::PDB(const std::filesystem::path& path)
 {
     m_impl = std::make_unique<SymbolModule>();
+    m_addressIndex = std::make_unique<SymbolAddressIndex>();
+    m_fieldIndex = std::make_unique<SymbolFieldIndex>();
+    m_inlineIndex = std::make_unique<SymbolInlineIndex>();
+    m_lineTable = std::make_unique<SymbolLineTable>();
+    m_referenceIndex = std::make_unique<SymbolReferenceIndex>();
+    m_nameIndex = std::make_unique<SymbolNameIndex>();
     m_impl->Open(path);
 }
 
+PDB::~PDB() = default;
 
-bool PDB::Open(const std::filesystem::path& path)
+
+bool PDB::Open(const std::filesystem::path& path, LoadMode loadMode)
 {
     assert(m_impl != nullptr);
-    return m_impl->Open(path);
+    return loadMode == LoadMode::Lazy ? m_impl->OpenLazy(path) : m_impl->Open(path);
 }
 
 bool PDB::IsOpened() const
@@ -865,6 +1249,12 @@ const std::filesystem::path PDB::GetPath() const
 
 void PDB::Close()
 {
+    m_addressIndex->Clear();
+    m_lineTable->Clear();
+    m_inlineIndex->Clear();
+    m_fieldIndex->Clear();
+    m_referenceIndex->Clear();
+    m_nameIndex->Clear();
     m_impl->Close();
 }
 
@@ -878,6 +1268,11 @@ CV_CFL_LANG PDB::GetLanguage() const
     return m_impl->GetLanguage();
 }
 
+bool PDB::GetSignature(GUID& guid, DWORD& age) const
+{
+    return m_impl->GetSignature(guid, age);
+}
+
 const SymbolPtr PDB::GetSymbolByName(const std::string& symbolName)
 {
     return m_impl->GetSymbolByName(symbolName);
@@ -903,6 +1298,90 @@ const FunctionSet& PDB::GetFunctionSet() const
     return m_impl->GetFunctionSet();
 }
 
+void PDB::ForEachTopLevelSymbol(const std::function<void(const SymbolPtr&)>& func)
+{
+    m_impl->ForEachTopLevelSymbol(func);
+}
+
+void PDB::ForEachTopLevelSymbol(
+    const std::function<bool(const std::string&)>& namePredicate,
+    const std::function<void(const SymbolPtr&)>& func)
+{
+    m_impl->ForEachTopLevelSymbol(namePredicate, func);
+}
+
+void PDB::ForEachFunctionName(const std::function<void(const std::string&)>& func)
+{
+    m_impl->ForEachFunctionName(func);
+}
+
+void PDB::ReleaseDecodedSymbols()
+{
+    m_fieldIndex->Clear();
+    m_referenceIndex->Clear();
+    m_nameIndex->Clear();
+    m_impl->ReleaseDecodedSymbols();
+}
+
+size_t PDB::GetApproximateMemoryUsage() const
+{
+    return m_impl->GetApproximateMemoryUsage();
+}
+
+void PDB::SymbolizeAddresses(const std::vector<DWORD>& rvas, std::vector<SymbolAddress>& addresses)
+{
+    m_addressIndex->Build(*m_impl);
+    m_addressIndex->Symbolize(rvas, addresses);
+}
+
+void PDB::LoadAddressIndex()
+{
+    m_addressIndex->Build(*m_impl);
+}
+
+bool PDB::LoadLineTable(const std::filesystem::path& cachePath, size_t threadCount)
+{
+    return m_lineTable->Load(*m_impl, cachePath, threadCount);
+}
+
+void PDB::ResolveLines(const std::vector<DWORD>& rvas, std::vector<SymbolLine>& lines)
+{
+    m_lineTable->Resolve(rvas, lines);
+}
+
+void PDB::GetInlineFrames(const std::vector<DWORD>& rvas, std::vector<SymbolFrame>& frames, std::vector<uint32_t>& frameOffsets)
+{
+    m_inlineIndex->GetFrames(*m_impl, rvas, frames, frameOffsets);
+}
+
+void PDB::GetFieldsAtOffset(const Symbol& udt, DWORD offset, std::vector<SymbolFieldLocation>& fields)
+{
+    m_fieldIndex->FindFieldsAtOffset(udt, offset, fields);
+}
+
+bool PDB::GetFieldAtPath(const Symbol& udt, const std::string& path, SymbolFieldLocation& field)
+{
+    return m_fieldIndex->FindFieldAtPath(udt, path, field);
+}
+
+void PDB::GetReferences(const Symbol& type, std::vector<SymbolReference>& references)
+{
+    m_referenceIndex->Build(m_impl->GetSymbolMap());
+    m_referenceIndex->FindReferences(type, references);
+}
+
+void PDB::GetDependents(const Symbol& type, unsigned kinds, std::vector<const Symbol*>& dependents)
+{
+    m_referenceIndex->Build(m_impl->GetSymbolMap());
+    m_referenceIndex->FindDependents(type, kinds, dependents);
+}
+
+void PDB::SearchNames(const std::string& pattern, SymbolNameSearch search, std::vector<SymbolNameMatch>& matches, unsigned maxDistance)
+{
+    m_nameIndex->Build(m_impl->GetSymbolMap(), m_impl->GetFunctionSet());
+    m_nameIndex->Search(pattern, search, maxDistance, matches);
+}
+
 const std::string PDB::GetBasicTypeString(BasicType BaseType, DWORD size)
 {
     for (int n = 0; BasicTypeMapMSVC[n].basicTypeString != nullptr; ++n)
@@ -941,6 +1420,68 @@ const std::string PDB::GetUdtKindString(UdtKind kind)
     return {};
 }
 
+void PDB::AppendTypeName(std::string& buffer, const Symbol* symbol)
+{
+    if (!symbol)
+    {
+        buffer += "void";
+        return;
+    }
+
+    switch (symbol->tag)
+    {
+    case SymTagBaseType:
+        buffer += GetBasicTypeString(*symbol);
+        break;
+
+    case SymTagPointerType:
+    {
+        const auto& symbolPointer = std::get<SymbolPointer>(symbol->variant);
+        AppendTypeName(buffer, symbolPointer.type.get());
+        buffer += symbolPointer.isReference ? '&' : '*';
+        break;
+    }
+
+    case SymTagArrayType:
+    {
+        const auto& symbolArray = std::get<SymbolArray>(symbol->variant);
+        AppendTypeName(buffer, symbolArray.elementType.get());
+        buffer += '[' + std::to_string(symbolArray.elementCount) + ']';
+        break;
+    }
+
+    case SymTagFunctionArgType:
+        AppendTypeName(buffer, std::get<SymbolFunctionArgType>(symbol->variant).type.get());
+        break;
+
+    case SymTagFunction:
+    case SymTagFunctionType:
+    {
+        const auto& symbolFunction = std::get<SymbolFunction>(symbol->variant);
+        if (symbolFunction.returnType)
+        {
+            AppendTypeName(buffer, symbolFunction.returnType.get());
+        }
+
+        buffer += '(';
+        for (size_t i = 0; i < symbolFunction.arguments.size(); ++i)
+        {
+            if (i != 0)
+            {
+                buffer += ", ";
+            }
+            AppendTypeName(buffer, symbolFunction.arguments[i].type.get());
+        }
+        buffer += ')';
+        break;
+    }
+
+    default:
+        buffer += symbol->name;
+        break;
+    }
+}
+
 bool PDB::IsUnnamedSymbol(const Symbol& symbol)
 {
     return strstr(symbol.name.c_str(), "<anonymous-") != nullptr ||
@@ -948,6 +1489,92 @@ bool PDB::IsUnnamedSymbol(const Symbol& symbol)
            strstr(symbol.name.c_str(), "__unnamed") != nullptr;
 }
 
+bool PDB::GetVariantInteger(const VARIANT& v, int64_t& value)
+{
+    switch (v.vt)
+    {
+    case VT_I1:   value = v.cVal; return true;
+    case VT_UI1:  value = v.bVal; return true;
+    case VT_I2:   value = v.iVal; return true;
+    case VT_UI2:  value = v.uiVal; return true;
+    case VT_INT:
+    case VT_I4:   value = v.lVal; return true;
+    case VT_UINT:
+    case VT_UI4:  value = v.ulVal; return true;
+    case VT_I8:   value = v.llVal; return true;
+    case VT_UI8:  value = static_cast<int64_t>(v.ullVal); return true;
+    default:      return false;
+    }
+}
+
+const Symbol* PDB::StripTypedefs(const Symbol* symbol)
+{
+    while (symbol && symbol->tag == SymTagTypedef)
+    {
+        symbol = std::get<SymbolTypedef>(symbol->variant).type.get();
+    }
+
+    return symbol;
+}
+
+bool PDB::IsUdt(const Symbol* symbol)
+{
+    return symbol && std::holds_alternative<SymbolUdt>(symbol->variant);
+}
+
+bool PDB::IsVirtualBaseClass(const SymbolUdt& udt, const SymbolUdtField& udtField)
+{
+    for (const auto& baseClass : udt.baseClassFields)
+    {
+        if (baseClass.type == udtField.type && baseClass.isVirtual)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string PDB::GetSignatureString(const GUID& guid, DWORD age)
+{
+    char text[48];
+
+    snprintf(text, sizeof(text), "%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%X",
+        guid.Data1, guid.Data2, guid.Data3,
+        guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3],
+        guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7],
+        age);
+
+    return text;
+}
+
+bool PDB::ParseSignatureString(const std::string& text, GUID& guid, DWORD& age)
+{
+    // 32 digits of GUID, then 1 to 8 of age.
+    if (text.size() < 33 || text.size() > 40 ||
+        text.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+    {
+        return false;
+    }
+
+    auto parse = [&text](size_t offset, size_t length)
+    {
+        return static_cast<DWORD>(strtoul(text.substr(offset, length).c_str(), nullptr, 16));
+    };
+
+    guid.Data1 = parse(0, 8);
+    guid.Data2 = static_cast<unsigned short>(parse(8, 4));
+    guid.Data3 = static_cast<unsigned short>(parse(12, 4));
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        guid.Data4[i] = static_cast<unsigned char>(parse(16 + i * 2, 2));
+    }
+
+    age = parse(32, text.size() - 32);
+    return true;
+}
+
 const SymbolUdtField* SymbolUdt::FieldFirst() const
 {
     return &fields.at(0);
@@ -4,11 +4,13 @@
 #include <atlbase.h>
 #include <dia2.h>
 #include <string>
+#include <string_view>
 #include <set>
 #include <unordered_set>
 #include <unordered_map>
 #include <variant>
 #include <filesystem>
+#include <functional>
 
 struct Symbol;
 using SymbolPtr = std::shared_ptr<Symbol>;
@@ -17,7 +19,9 @@ struct SymbolEnumField
 {
     std::string name;
     VARIANT value;
-    SymbolPtr parent;
+
+    // Not owning: the enum owns its fields.
+    const Symbol* parent = nullptr;
 };
 
 struct SymbolUdtField
@@ -29,7 +33,9 @@ struct SymbolUdtField
     DWORD offset = 0;
     DWORD bits = 0;
     DWORD bitPosition = 0;
-    SymbolPtr parent;
+
+    // Not owning: the UDT owns its fields.
+    const Symbol* parent = nullptr;
     DWORD access = 0;
     bool isBaseClass = false;
 };
@@ -125,6 +131,134 @@ struct Symbol
     SymbolVariant variant;
 };
 
+// A member located inside a UDT, possibly nested or inherited.
+struct SymbolFieldLocation
+{
+    std::string path;
+    DWORD offset = 0;
+    DWORD size = 0;
+    DWORD bitPosition = 0;
+    DWORD bits = 0;
+    const Symbol* type = nullptr;
+};
+
+// How a type refers to another one.
+enum class SymbolReferenceKind : uint8_t
+{
+    ByValue,
+    Pointer,
+    Array,
+    BaseClass,
+    FunctionArgument,
+};
+
+constexpr unsigned SymbolReferenceKindAll = (1u << 5) - 1;
+
+constexpr unsigned SymbolReferenceKindBit(SymbolReferenceKind kind)
+{
+    return 1u << static_cast<unsigned>(kind);
+}
+
+// A member of a UDT that refers to some other type. For references through
+// function arguments, field is the member function or function pointer.
+struct SymbolReference
+{
+    const Symbol* type = nullptr;
+    const SymbolUdtField* field = nullptr;
+    SymbolReferenceKind kind = SymbolReferenceKind::ByValue;
+};
+
+enum class SymbolNameSearch
+{
+    Prefix,
+    Substring,
+
+    // '*' and '?' wildcards.
+    Glob,
+
+    // Within a maximum edit distance.
+    Fuzzy,
+};
+
+struct SymbolNameMatch
+{
+    std::string name;
+    bool isFunction = false;
+    unsigned distance = 0;
+};
+
+// A public symbol and where it lives in the image.
+struct SymbolPublic
+{
+    std::string name;
+    DWORD rva = 0;
+    DWORD section = 0;
+    DWORD offset = 0;
+    DWORD length = 0;
+};
+
+// The public symbol an RVA belongs to. name is empty when the RVA is not
+// covered by any public symbol.
+struct SymbolAddress
+{
+    std::string_view name;
+    DWORD section = 0;
+    DWORD offset = 0;
+    DWORD displacement = 0;
+};
+
+// A function and its code.
+struct SymbolProcedure
+{
+    std::string name;
+    DWORD rva = 0;
+    DWORD length = 0;
+    DWORD symIndexId = 0;
+};
+
+// Code of an inlined function, with the source line of each range.
+struct SymbolInlineRange
+{
+    DWORD rva = 0;
+    DWORD length = 0;
+    DWORD line = 0;
+    std::string file;
+};
+
+// A function inlined into a procedure or into another inline site.
+struct SymbolInlineSite
+{
+    std::string name;
+
+    // 0 when inlined into the procedure itself, otherwise 1 + the index of
+    // the enclosing site in enumeration order.
+    uint32_t parent = 0;
+
+    std::vector<SymbolInlineRange> ranges;
+};
+
+// One frame of an inline stack.
+struct SymbolFrame
+{
+    std::string_view name;
+    std::string_view file;
+    DWORD line = 0;
+};
+
+// Source location of an RVA. file is empty when no line covers the RVA.
+struct SymbolLine
+{
+    std::string_view file;
+    DWORD line = 0;
+};
+
+class SymbolAddressIndex;
+class SymbolFieldIndex;
+class SymbolInlineIndex;
+class SymbolLineTable;
+class SymbolNameIndex;
+class SymbolReferenceIndex;
+
 using SymbolMap = std::unordered_map<DWORD, SymbolPtr>;
 using SymbolNameMap = std::unordered_map<std::string, SymbolPtr>;
 using SymbolSet = std::unordered_set<SymbolPtr>;
@@ -136,13 +270,20 @@ using DiaEnumSymbolsPtr = ATL::CComPtr<IDiaEnumSymbols>;
 class SymbolModuleBase
 {
 public:
+    // COM is initialized on the constructing thread for the lifetime of
+    // the module, so it has to be destroyed on that thread too.
     SymbolModuleBase();
-    virtual ~SymbolModuleBase() = default;
+    virtual ~SymbolModuleBase();
 
     virtual bool Open(const std::filesystem::path& path);
     virtual void Close();
     virtual bool IsOpen() const;
 
+    // Identifies the PDB, e.g. for validating cached data derived from it.
+    bool GetSignature(GUID& guid, DWORD& age) const;
+
+    static std::string GetSourceFileName(IDiaSourceFile* sourceFile);
+
 private:
     HRESULT LoadDiaViaCoCreateInstance();
     HRESULT LoadDiaViaLoadLibrary();
@@ -151,6 +292,11 @@ protected:
     ATL::CComPtr<IDiaDataSource> m_dataSource;
     ATL::CComPtr<IDiaSession> m_session;
     ATL::CComPtr<IDiaSymbol> m_globalSymbol;
+
+private:
+    // False when the thread already had COM in another apartment; it is
+    // then used as it is and left alone.
+    bool m_comInitialized = false;
 };
 
 class SymbolModule : public SymbolModuleBase
@@ -159,6 +305,7 @@ public:
     ~SymbolModule();
 
     bool Open(const std::filesystem::path& path) override;
+    bool OpenLazy(const std::filesystem::path& path);
     void Close() override;
 
     const std::filesystem::path& GetPath() const;
@@ -179,6 +326,17 @@ public:
     const SymbolNameMap& GetSymbolNameMap() const;
     const FunctionSet& GetFunctionSet() const;
 
+    void ForEachTopLevelSymbol(const std::function<void(const SymbolPtr&)>& func);
+    void ForEachTopLevelSymbol(const std::function<bool(const std::string&)>& namePredicate, const std::function<void(const SymbolPtr&)>& func);
+    void ForEachFunctionName(const std::function<void(const std::string&)>& func);
+    void ForEachPublicSymbol(const std::function<void(const SymbolPublic&)>& func);
+    void ForEachProcedure(const std::function<void(const SymbolProcedure&)>& func);
+
+    // Enclosing sites come before the sites inlined into them.
+    void ForEachInlineSite(DWORD procedureSymIndexId, const std::function<void(const SymbolInlineSite&)>& func);
+    void ReleaseDecodedSymbols();
+    size_t GetApproximateMemoryUsage() const;
+
 private:
     void InitSymbol(const DiaSymbolPtr& DiaSymbol, const SymbolPtr& Symbol);
     void ProcessSymbolBase(const DiaSymbolPtr& DiaSymbol, const SymbolPtr& Symbol);
@@ -191,6 +349,8 @@ private:
     void ProcessSymbolUdt(const DiaSymbolPtr& DiaSymbol, const SymbolPtr& Symbol);
     void ProcessSymbolFunctionEx(const DiaSymbolPtr& DiaSymbol, const SymbolPtr& Symbol);
 
+    void ForEachFunctionNameFromEnumerator(const DiaEnumSymbolsPtr& DiaSymbolEnumerator, const std::function<void(const std::string&)>& func);
+
 private:
     std::filesystem::path m_path;
     SymbolMap m_symbolMap;
@@ -200,15 +360,27 @@ private:
 
     DWORD m_machineType = 0;
     CV_CFL_LANG m_language = CV_CFL_C;
+
+    size_t m_approximateMemoryUsage = 0;
 };
 
 class PDB
 {
 public:
+    enum class LoadMode
+    {
+        // Decodes the whole type graph on open.
+        Full,
+
+        // Decodes symbols on demand; decoded symbols can be released again.
+        Lazy,
+    };
+
     PDB();
     PDB(const std::filesystem::path& path);
+    ~PDB();
 
-    bool Open(const std::filesystem::path& path);
+    bool Open(const std::filesystem::path& path, LoadMode loadMode = LoadMode::Full);
     bool IsOpened() const;
     void Close();
 
@@ -216,6 +388,7 @@ public:
 
     DWORD GetMachineType() const;
     CV_CFL_LANG GetLanguage() const;
+    bool GetSignature(GUID& guid, DWORD& age) const;
 
     const SymbolPtr GetSymbolByName(const std::string& symbolName);
     const SymbolPtr GetSymbolBySymbolIndex(DWORD typeId);
@@ -223,11 +396,83 @@ public:
     const SymbolNameMap& GetSymbolNameMap() const;
     const FunctionSet& GetFunctionSet() const;
 
+    void ForEachTopLevelSymbol(const std::function<void(const SymbolPtr&)>& func);
+    void ForEachTopLevelSymbol(const std::function<bool(const std::string&)>& namePredicate, const std::function<void(const SymbolPtr&)>& func);
+    void ForEachFunctionName(const std::function<void(const std::string&)>& func);
+
+    // Frees every decoded symbol. Symbols still held by the caller keep
+    // their name and size but lose their members and targets.
+    void ReleaseDecodedSymbols();
+    size_t GetApproximateMemoryUsage() const;
+
+    // Offset <-> member path lookups through a flattened layout of the UDT,
+    // built on first use and cached until the symbols are released.
+    void GetFieldsAtOffset(const Symbol& udt, DWORD offset, std::vector<SymbolFieldLocation>& fields);
+    bool GetFieldAtPath(const Symbol& udt, const std::string& path, SymbolFieldLocation& field);
+
+    // Reverse references between UDTs and enums, built over the decoded
+    // symbols on first use. Types are matched by name, so references to a
+    // forward declaration count as references to its definition.
+    void GetReferences(const Symbol& type, std::vector<SymbolReference>& references);
+
+    // Every type that reaches type through references of the given kinds,
+    // directly or transitively, in breadth-first order.
+    void GetDependents(const Symbol& type, unsigned kinds, std::vector<const Symbol*>& dependents);
+
+    // Case-insensitive search over decoded type names and public symbol
+    // names, built on first use. Fuzzy matches come by ascending distance.
+    void SearchNames(const std::string& pattern, SymbolNameSearch search, std::vector<SymbolNameMatch>& matches, unsigned maxDistance = 2);
+
+    // Resolves RVAs to public symbols, one result per RVA. The table is
+    // read on first use and kept until the PDB is closed; the names in the
+    // results stay valid until then.
+    void SymbolizeAddresses(const std::vector<DWORD>& rvas, std::vector<SymbolAddress>& addresses);
+
+    // Reads the table for SymbolizeAddresses now. DIA is only used on the
+    // thread that opened the PDB, so this has to come first wherever
+    // other threads symbolize.
+    void LoadAddressIndex();
+
+    // Reads the source lines of all modules, with one DIA session per
+    // thread, unless cachePath holds a snapshot of this PDB; a fresh read is
+    // saved there. Returns false when the PDB has no line information.
+    bool LoadLineTable(const std::filesystem::path& cachePath = {}, size_t threadCount = 0);
+
+    // One result per RVA; needs LoadLineTable. The file names in the
+    // results stay valid until the PDB is closed.
+    void ResolveLines(const std::vector<DWORD>& rvas, std::vector<SymbolLine>& lines);
+
+    // Inline stacks, innermost frame first and the containing procedure
+    // last; the frames of rvas[i] are frames[frameOffsets[i] ..
+    // frameOffsets[i + 1]). Inline sites are decoded per procedure on first
+    // use and kept until the PDB is closed, like the returned names.
+    void GetInlineFrames(const std::vector<DWORD>& rvas, std::vector<SymbolFrame>& frames, std::vector<uint32_t>& frameOffsets);
+
     static const std::string GetBasicTypeString(BasicType baseType, DWORD size);
     static const std::string GetBasicTypeString(const Symbol& symbol);
     static const std::string GetUdtKindString(UdtKind kind);
+    static void AppendTypeName(std::string& buffer, const Symbol* symbol);
     static bool IsUnnamedSymbol(const Symbol& symbol);
 
+    // Integer constants, as enumerator values are stored; false otherwise.
+    static bool GetVariantInteger(const VARIANT& v, int64_t& value);
+
+    static const Symbol* StripTypedefs(const Symbol* symbol);
+    static bool IsUdt(const Symbol* symbol);
+
+    // Whether a base class field of udt names one of its virtual bases.
+    static bool IsVirtualBaseClass(const SymbolUdt& udt, const SymbolUdtField& udtField);
+
+    // "<GUID><age>" in hex, as symbol stores name their directories.
+    static std::string GetSignatureString(const GUID& guid, DWORD age);
+    static bool ParseSignatureString(const std::string& text, GUID& guid, DWORD& age);
+
 private:
     std::unique_ptr<SymbolModule> m_impl;
+    std::unique_ptr<SymbolAddressIndex> m_addressIndex;
+    std::unique_ptr<SymbolFieldIndex> m_fieldIndex;
+    std::unique_ptr<SymbolInlineIndex> m_inlineIndex;
+    std::unique_ptr<SymbolLineTable> m_lineTable;
+    std::unique_ptr<SymbolReferenceIndex> m_referenceIndex;
+    std::unique_ptr<SymbolNameIndex> m_nameIndex;
 };
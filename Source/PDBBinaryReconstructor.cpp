@@ -0,0 +1,267 @@
+#include "PDBBinaryReconstructor.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    const size_t TableAlignment = 8;
+    const uint32_t MinimumHashBucketCount = 16;
+
+    bool IsExpandedUnnamedUdt(const Symbol& symbol)
+    {
+        return symbol.tag == SymTagUDT && symbol.size > 0 && PDB::IsUnnamedSymbol(symbol);
+    }
+
+    void WritePadding(std::ostream& output, uint64_t& position)
+    {
+        static const char Zeros[TableAlignment] = {};
+
+        const size_t padding = (TableAlignment - position % TableAlignment) % TableAlignment;
+        output.write(Zeros, padding);
+        position += padding;
+    }
+
+    template <typename T>
+    void WriteTable(std::ostream& output, uint64_t& position, const T* data, size_t count)
+    {
+        output.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        position += count * sizeof(T);
+    }
+
+    uint64_t AlignUp(uint64_t position)
+    {
+        return (position + TableAlignment - 1) & ~uint64_t(TableAlignment - 1);
+    }
+}
+
+PDBBinaryReconstructor::PDBBinaryReconstructor(std::ostream& output)
+    : m_output(output)
+{
+    // Offset 0 is the empty string.
+    AddString(std::string());
+}
+
+bool PDBBinaryReconstructor::OnUdt(const Symbol& symbol)
+{
+    return symbol.size > 0;
+}
+
+void PDBBinaryReconstructor::OnUdtBegin(const Symbol& symbol)
+{
+    if (m_depth++ != 0)
+    {
+        return;
+    }
+
+    PDBLayoutTypeRecord type = {};
+    type.nameOffset = AddString(symbol.name);
+    type.nameHash = PDBLayoutHashName(symbol.name.c_str(), symbol.name.size());
+    type.size = symbol.size;
+    type.kind = std::get<SymbolUdt>(symbol.variant).kind;
+    type.firstField = static_cast<uint32_t>(m_fields.size());
+
+    m_types.push_back(type);
+}
+
+void PDBBinaryReconstructor::OnUdtEnd(const Symbol& symbol)
+{
+    if (--m_depth != 0)
+    {
+        return;
+    }
+
+    auto& type = m_types.back();
+    type.fieldCount = static_cast<uint32_t>(m_fields.size()) - type.firstField;
+}
+
+void PDBBinaryReconstructor::OnUdtFieldBegin(const SymbolUdtField& udtField)
+{
+    FieldContext context;
+    context.offset = GetParentOffset() + udtField.offset;
+    context.path = m_fieldStack.empty() ? udtField.name : m_fieldStack.back().path + '.' + udtField.name;
+
+    m_fieldStack.push_back(std::move(context));
+}
+
+void PDBBinaryReconstructor::OnUdtFieldEnd(const SymbolUdtField& udtField)
+{
+    m_fieldStack.pop_back();
+}
+
+void PDBBinaryReconstructor::OnUdtField(const SymbolUdtField& udtField, UdtFieldDefinitionBase& memberDefinition)
+{
+    assert(udtField.type);
+    assert(!m_fieldStack.empty());
+
+    // Only data members are stored. Base classes are kept as members named
+    // after the base type, so "Derived.Base.member" paths resolve.
+    if (udtField.tag != SymTagData && !udtField.isBaseClass)
+    {
+        return;
+    }
+
+    if (!udtField.isBaseClass && udtField.dataKind != DataIsStaticMember && IsExpandedUnnamedUdt(*udtField.type))
+    {
+        return;
+    }
+
+    const auto& context = m_fieldStack.back();
+    const std::string& name = udtField.isBaseClass ? udtField.type->name : context.path;
+
+    PDBLayoutFieldRecord field = {};
+    field.nameOffset = AddString(name);
+    field.nameHash = PDBLayoutHashName(name.c_str(), name.size());
+    field.size = udtField.type->size;
+    field.typeRef = PDBLayoutInvalidIndex;
+
+    std::string typeName;
+    PDB::AppendTypeName(typeName, udtField.type.get());
+    field.typeNameOffset = AddString(typeName);
+
+    if (udtField.dataKind == DataIsStaticMember)
+    {
+        field.flags |= PDBLayoutFieldStatic;
+    }
+    else
+    {
+        field.offset = context.offset;
+    }
+
+    if (udtField.bits != 0)
+    {
+        field.flags |= PDBLayoutFieldBitField;
+        field.bits = static_cast<uint8_t>(udtField.bits);
+        field.bitPosition = static_cast<uint8_t>(udtField.bitPosition);
+    }
+
+    const Symbol* referencedType = PDB::StripTypedefs(udtField.type.get());
+
+    if (referencedType && referencedType->tag == SymTagPointerType)
+    {
+        field.flags |= PDBLayoutFieldPointer;
+        referencedType = nullptr;
+    }
+
+    while (referencedType && referencedType->tag == SymTagArrayType)
+    {
+        field.flags |= PDBLayoutFieldArray;
+        referencedType = PDB::StripTypedefs(std::get<SymbolArray>(referencedType->variant).elementType.get());
+    }
+
+    const bool refersToUdt =
+        referencedType &&
+        referencedType->tag == SymTagUDT &&
+        !PDB::IsUnnamedSymbol(*referencedType);
+
+    m_fields.push_back(field);
+    m_fieldTypeRefNames.push_back(refersToUdt ? referencedType->name : std::string());
+}
+
+void PDBBinaryReconstructor::OnFinish()
+{
+    //
+    // Resolve by-value type references. The first definition of a name
+    // wins, which matches what the hash table below returns.
+    //
+
+    std::unordered_map<std::string, uint32_t> typeIndexes;
+    typeIndexes.reserve(m_types.size());
+
+    for (uint32_t i = 0; i < m_types.size(); ++i)
+    {
+        typeIndexes.emplace(&m_stringTable[m_types[i].nameOffset], i);
+    }
+
+    for (size_t i = 0; i < m_fields.size(); ++i)
+    {
+        if (m_fieldTypeRefNames[i].empty())
+        {
+            continue;
+        }
+
+        auto it = typeIndexes.find(m_fieldTypeRefNames[i]);
+        if (it != typeIndexes.end())
+        {
+            m_fields[i].typeRef = it->second;
+        }
+    }
+
+    //
+    // Open addressing with linear probing, at most half full.
+    //
+
+    uint32_t bucketCount = MinimumHashBucketCount;
+    while (bucketCount < m_types.size() * 2)
+    {
+        bucketCount *= 2;
+    }
+
+    std::vector<uint32_t> hashTable(bucketCount, PDBLayoutInvalidIndex);
+
+    for (uint32_t i = 0; i < m_types.size(); ++i)
+    {
+        uint32_t bucket = m_types[i].nameHash & (bucketCount - 1);
+        while (hashTable[bucket] != PDBLayoutInvalidIndex)
+        {
+            bucket = (bucket + 1) & (bucketCount - 1);
+        }
+        hashTable[bucket] = i;
+    }
+
+    //
+    // Header followed by the tables, each aligned to 8 bytes.
+    //
+
+    PDBLayoutHeader header = {};
+    memcpy(header.magic, PDBLayoutMagic, sizeof(header.magic));
+    header.version = PDBLayoutVersion;
+    header.headerSize = sizeof(PDBLayoutHeader);
+    header.typeCount = static_cast<uint32_t>(m_types.size());
+    header.fieldCount = static_cast<uint32_t>(m_fields.size());
+    header.hashBucketCount = bucketCount;
+    header.stringTableSize = static_cast<uint32_t>(m_stringTable.size());
+
+    header.typeTableOffset = AlignUp(sizeof(PDBLayoutHeader));
+    header.fieldTableOffset = AlignUp(header.typeTableOffset + m_types.size() * sizeof(PDBLayoutTypeRecord));
+    header.hashTableOffset = AlignUp(header.fieldTableOffset + m_fields.size() * sizeof(PDBLayoutFieldRecord));
+    header.stringTableOffset = AlignUp(header.hashTableOffset + hashTable.size() * sizeof(uint32_t));
+
+    uint64_t position = 0;
+
+    WriteTable(m_output, position, &header, 1);
+    WritePadding(m_output, position);
+    WriteTable(m_output, position, m_types.data(), m_types.size());
+    WritePadding(m_output, position);
+    WriteTable(m_output, position, m_fields.data(), m_fields.size());
+    WritePadding(m_output, position);
+    WriteTable(m_output, position, hashTable.data(), hashTable.size());
+    WritePadding(m_output, position);
+    WriteTable(m_output, position, m_stringTable.data(), m_stringTable.size());
+
+    assert(position == header.stringTableOffset + m_stringTable.size());
+
+    m_output.flush();
+}
+
+uint32_t PDBBinaryReconstructor::AddString(const std::string& text)
+{
+    auto it = m_stringOffsets.find(text);
+    if (it != m_stringOffsets.end())
+    {
+        return it->second;
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(m_stringTable.size());
+
+    m_stringTable.append(text);
+    m_stringTable.push_back('\0');
+    m_stringOffsets.emplace(text, offset);
+
+    return offset;
+}
+
+DWORD PDBBinaryReconstructor::GetParentOffset() const
+{
+    return m_fieldStack.empty() ? 0 : m_fieldStack.back().offset;
+}
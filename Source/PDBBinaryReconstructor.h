@@ -0,0 +1,59 @@
+#pragma once
+#include "PDBReconstructorBase.h"
+#include "PDBLayoutFormat.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Collects the layout of every top-level UDT and writes it in the
+// PDBLayoutFormat.h format once the run finishes. Fields of unnamed nested
+// types are flattened into their parent, the same way the JSON export does.
+//
+class PDBBinaryReconstructor final : public PDBReconstructorBase
+{
+public:
+    explicit PDBBinaryReconstructor(std::ostream& output);
+
+protected:
+    template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+    friend class PDBSymbolVisitor;
+
+    bool OnUdt(const Symbol& symbol) override;
+    void OnUdtBegin(const Symbol& symbol) override;
+    void OnUdtEnd(const Symbol& symbol) override;
+
+    void OnUdtFieldBegin(const SymbolUdtField& udtField) override;
+    void OnUdtFieldEnd(const SymbolUdtField& udtField) override;
+    void OnUdtField(const SymbolUdtField& udtField, UdtFieldDefinitionBase& memberDefinition) override;
+
+    void OnFinish() override;
+
+private:
+    struct FieldContext
+    {
+        DWORD offset;
+        std::string path;
+    };
+
+    uint32_t AddString(const std::string& text);
+    DWORD GetParentOffset() const;
+
+private:
+    std::ostream& m_output;
+
+    std::vector<PDBLayoutTypeRecord> m_types;
+    std::vector<PDBLayoutFieldRecord> m_fields;
+
+    // Name of the UDT each field refers to by value, resolved to a type
+    // index once every type is known.
+    std::vector<std::string> m_fieldTypeRefNames;
+
+    std::string m_stringTable;
+    std::unordered_map<std::string, uint32_t> m_stringOffsets;
+
+    std::vector<FieldContext> m_fieldStack;
+    DWORD m_depth = 0;
+};
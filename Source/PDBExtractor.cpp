@@ -1,39 +1,93 @@
 #include "PDBExtractor.h"
+#include "PDBExtractorCommon.h"
 #include "PDBHeaderReconstructor.h"
 #include "PDBSymbolVisitor.h"
 #include "PDBSymbolSorter.h"
 #include "UdtFieldDefinition.h"
+#include "PDBJsonReconstructor.h"
+#include "PDBBinaryReconstructor.h"
+#include "SymbolStoreFetcher.h"
 
 #include <iostream>
 #include <fstream>
-#include <stdexcept>
+#include <thread>
 
-namespace
+int PDBExtractor::Run(int argc, char** argv)
 {
-	static const char* MESSAGE_INVALID_PARAMETERS = "Invalid parameters";
-	static const char* MESSAGE_FILE_NOT_FOUND = "File not found";
-	static const char* MESSAGE_SYMBOL_NOT_FOUND = "Symbol not found";
+	int result = 0;
 
-	class PDBDumperException : public std::runtime_error
+	try
 	{
-	public:
-		PDBDumperException(const char* Message)
-			: std::runtime_error(Message)
+		ParseParameters(argc, argv);
+
+		if (m_settings.batch)
 		{
+			RunBatch();
+			return result;
+		}
 
+		if (!m_settings.offsetHistoryBuild.empty())
+		{
+			LookupOffsetHistory();
+			return result;
 		}
-	};
-}
 
-int PDBExtractor::Run(int argc, char** argv)
-{
-	int result = 0;
+		if (m_settings.merge)
+		{
+			MergePDBs();
+			return result;
+		}
 
-	try
-	{
-		ParseParameters(argc, argv);
 		OpenPDBFile();
-		DumpAllSymbols();
+
+		if (!m_settings.serverSocketPath.empty())
+		{
+			RunQueryServer();
+		}
+		else if (!m_settings.queryFilename.empty())
+		{
+			RunQueryBatch();
+		}
+		else if (!m_settings.query.empty())
+		{
+			RunQuery();
+		}
+		else if (m_settings.interactive)
+		{
+			RunInteractive();
+		}
+		else if (m_settings.analyzeLayouts)
+		{
+			AnalyzeLayouts();
+		}
+		else if (!m_settings.diffPdbPath.empty())
+		{
+			DiffPDBs();
+		}
+		else if (!m_settings.typeStoreDirectory.empty())
+		{
+			IngestIntoTypeStore();
+		}
+		else if (!m_settings.addressFilename.empty())
+		{
+			SymbolizeAddresses();
+		}
+		else if (!m_settings.dumpFilename.empty())
+		{
+			DecodeDump();
+		}
+		else if (!m_settings.typeSelection.empty())
+		{
+			DumpSelectedSymbols();
+		}
+		else if (m_settings.memoryBudget != 0)
+		{
+			DumpAllSymbolsStreaming();
+		}
+		else
+		{
+			DumpAllSymbols();
+		}
 	}
 	catch (const PDBDumperException& e)
 	{
@@ -48,12 +102,33 @@ void PDBExtractor::PrintUsage()
 {
 	std::cout << ("Extracts types and structures from PDB (Program database).\n");
 	std::cout << ("\n");
-	std::cout << ("pdbex <path> [-o <filename>] [-e <type>]\n");
-	std::cout << ("                     [-u <prefix>] [-s prefix] [-r prefix] [-g suffix]\n");
-	std::cout << ("                     [-p] [-x] [-b] [-d]\n");
+	std::cout << ("pdbex <path> [-o <filename> | -O <directory> [-N]] [-f <format>] [-t <type>]...\n");
+	std::cout << ("                     [-e <expansion>] [-u <prefix>] [-s prefix] [-r prefix] [-g suffix]\n");
+	std::cout << ("                     [-m megabytes] [-p] [-x] [-b] [-d]\n");
+	std::cout << ("pdbex <path> -S <socket> [-a <path>]... [-j threads]\n");
+	std::cout << ("pdbex <path> -q <filename> [-j threads]\n");
+	std::cout << ("pdbex <path> -c <query>\n");
+	std::cout << ("pdbex <path> -i\n");
+	std::cout << ("pdbex <path> -H [-o <filename>] [-j threads]\n");
+	std::cout << ("pdbex <path> -D <path> [-f <format>] [-o <filename>] [-j threads]\n");
+	std::cout << ("pdbex <path> -U <directory> [-o <filename>]\n");
+	std::cout << ("pdbex <directory|listfile> -B [-O <directory>] [-X <filename>] [-f <format>] [-o <filename>]\n");
+	std::cout << ("                     [-F <directory> [-W <url>]] [-j threads]\n");
+	std::cout << ("pdbex <history> -Y <GUID><age> [-o <filename>]\n");
+	std::cout << ("pdbex <path> -M -a <path>... [-f <format>] [-o <filename>] [-e <expansion>]\n");
+	std::cout << ("pdbex <path> -A <filename> [-o <filename>] [-l] [-L <filename>] [-I]\n");
+	std::cout << ("pdbex <path> -Z <dump> -T <type> -V <filename> [-K <address>] [-f <format>] [-o <filename>]\n");
+	std::cout << ("                     [-R <field> [-C <field>]] [-E <field>] [-j threads]\n");
 	std::cout << ("\n");
-	std::cout << ("<path>               Path to the PDB file.\n");
+	std::cout << ("<path>               Path to the PDB file, or to a PE image with -F.\n");
 	std::cout << (" -o filename         Specifies the output file.                       (stdout)\n");
+	std::cout << (" -O directory        Writes one header per type into a directory tree.\n");
+	std::cout << (" -f [h,j,b]          Specifies the output format.                     (h)\n");
+	std::cout << ("                       h = header          C/C++ declarations.\n");
+	std::cout << ("                       j = json            One JSON layout record per line.\n");
+	std::cout << ("                       b = binary          Mappable layout file (needs -o).\n");
+	std::cout << (" -t type             Extracts only this type and its dependencies.    (all)\n");
+	std::cout << ("                       Repeatable; accepts globs (*, ?) and /regex/.\n");
 	std::cout << (" -e [n,i,a]          Specifies expansion of nested structures/unions. (i)\n");
 	std::cout << ("                       n = none            Only top-most type is printed.\n");
 	std::cout << ("                       i = inline unnamed  Unnamed types are nested.\n");
@@ -62,6 +137,31 @@ void PDBExtractor::PrintUsage()
 	std::cout << (" -s prefix           Unnamed struct prefix (in combination with -d).\n");
 	std::cout << (" -r prefix           Prefix for all symbols.\n");
 	std::cout << (" -g suffix           Suffix for all symbols.\n");
+	std::cout << (" -m megabytes        Streams types out, keeping decoded symbols under the budget.\n");
+	std::cout << (" -S socket           Serves queries on a Unix domain socket.\n");
+	std::cout << (" -a path             Additional PDB to serve (with -S) or merge (with -M).\n");
+	std::cout << (" -q filename         Answers one query per line ('-' = stdin), in order.\n");
+	std::cout << (" -c query            Answers one query, e.g. \"at _KTHREAD+0x2c8\".\n");
+	std::cout << (" -D path             Reports layout changes of types from <path> to this PDB.\n");
+	std::cout << (" -U directory        Adds the types not yet in this type store, and a manifest.\n");
+	std::cout << (" -B                  Extracts every PDB under <path>, or listed in it, into -O.\n");
+	std::cout << (" -X filename         Writes the field offset history of the PDBs (with -B).\n");
+	std::cout << (" -Y signature        Lists the field offsets of one build in a history.\n");
+	std::cout << (" -F directory        Fetches the PDBs of PE images given instead into this cache.\n");
+	std::cout << (" -W url              Symbol server for -F.                            (msdl)\n");
+	std::cout << (" -M                  Dumps the types of <path> and every -a PDB as one set.\n");
+	std::cout << (" -H                  Reports layout holes, padding and cache line straddles.\n");
+	std::cout << (" -i                  Interactive shell over the loaded PDB; \"help\" lists commands.\n");
+	std::cout << (" -j threads          Number of worker threads.                        (cores)\n");
+	std::cout << (" -A filename         Symbolizes one hex RVA per line ('-' = stdin).\n");
+	std::cout << (" -L filename         Line table snapshot to reuse or create (implies -l).\n");
+	std::cout << (" -Z dump             Decodes instances of a type out of a minidump or raw memory image.\n");
+	std::cout << (" -T type             Type to decode (with -Z).\n");
+	std::cout << (" -V filename         One hex address per line, with an optional count ('-' = stdin).\n");
+	std::cout << (" -K address          Raw memory image start address (with -Z).        (0)\n");
+	std::cout << (" -R field            Walks the lists at the -V addresses by this next pointer.\n");
+	std::cout << (" -C field            Member the -R pointer points to.                 (its parent)\n");
+	std::cout << (" -E field            Decodes only this member (with -Z); repeatable.\n");
 	std::cout << ("\n");
 	std::cout << ("Following options can be explicitly turned off by adding trailing '-'.\n");
 	std::cout << ("Example: -p-\n");
@@ -69,6 +169,9 @@ void PDBExtractor::PrintUsage()
 	std::cout << (" -x                  Show offsets.                                    (T)\n");
 	std::cout << (" -b                  Allow bitfields in union.                        (F)\n");
 	std::cout << (" -d                  Allow unnamed data types.                        (T)\n");
+	std::cout << (" -N                  One header per namespace (with -O).              (F)\n");
+	std::cout << (" -l                  Adds file:line to addresses (with -A).           (F)\n");
+	std::cout << (" -I                  Adds inline frames to addresses (with -A).       (F)\n");
 	std::cout << ("\n");
 }
 
@@ -110,8 +213,276 @@ void PDBExtractor::ParseParameters(int argc, char** argv)
 
 			++argumentPointer;
 			m_settings.outputFilename = nextArgument;
-			m_settings.pdbHeaderReconstructorSettings.outputFile = std::make_unique<std::ofstream>(nextArgument, std::ios::out);
-			m_settings.pdbHeaderReconstructorSettings.output = *m_settings.pdbHeaderReconstructorSettings.outputFile;
+			break;
+
+		case 'O':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.outputDirectory = nextArgument;
+			break;
+
+		case 't':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.typeSelection.push_back(nextArgument);
+			break;
+
+		case 'S':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.serverSocketPath = nextArgument;
+			break;
+
+		case 'q':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.queryFilename = nextArgument;
+			break;
+
+		case 'A':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.addressFilename = nextArgument;
+			break;
+
+		case 'Z':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpFilename = nextArgument;
+			break;
+
+		case 'T':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpTypeName = nextArgument;
+			break;
+
+		case 'V':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpAddressFilename = nextArgument;
+			break;
+
+		case 'K':
+		{
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			char* end = nullptr;
+			m_settings.dumpBaseAddress = strtoull(nextArgument.c_str(), &end, 16);
+
+			if (*end != '\0')
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			break;
+		}
+
+		case 'R':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpNextFieldPath = nextArgument;
+			break;
+
+		case 'C':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpLinkFieldPath = nextArgument;
+			break;
+
+		case 'E':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.dumpFieldPaths.push_back(nextArgument);
+			break;
+
+		case 'l':
+			m_settings.resolveLines = !offSwitch;
+			break;
+
+		case 'I':
+			m_settings.inlineFrames = !offSwitch;
+			break;
+
+		case 'L':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.lineCacheFilename = nextArgument;
+			m_settings.resolveLines = true;
+			break;
+
+		case 'i':
+			m_settings.interactive = !offSwitch;
+			break;
+
+		case 'H':
+			m_settings.analyzeLayouts = !offSwitch;
+			break;
+
+		case 'B':
+			m_settings.batch = !offSwitch;
+			break;
+
+		case 'M':
+			m_settings.merge = !offSwitch;
+			break;
+
+		case 'F':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.symbolCacheDirectory = nextArgument;
+			break;
+
+		case 'W':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.symbolServerUrl = nextArgument;
+			break;
+
+		case 'D':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.diffPdbPath = nextArgument;
+			break;
+
+		case 'X':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.offsetHistoryFilename = nextArgument;
+			break;
+
+		case 'Y':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.offsetHistoryBuild = nextArgument;
+			break;
+
+		case 'U':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.typeStoreDirectory = nextArgument;
+			break;
+
+		case 'c':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.query = nextArgument;
+			break;
+
+		case 'a':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			m_settings.additionalPdbPaths.push_back(nextArgument);
+			break;
+
+		case 'j':
+		{
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+
+			char* end = nullptr;
+			const auto threadCount = strtoull(nextArgument.c_str(), &end, 10);
+			if (*end != '\0' || threadCount == 0)
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			m_settings.threadCount = static_cast<size_t>(threadCount);
+			break;
+		}
+
+		case 'N':
+			m_settings.splitType = offSwitch
+				? PDBSplitOutputWriter::SplitType::PerType
+				: PDBSplitOutputWriter::SplitType::PerNamespace;
 			break;
 
 		case 'e':
@@ -185,6 +556,52 @@ void PDBExtractor::ParseParameters(int argc, char** argv)
 			m_settings.pdbHeaderReconstructorSettings.symbolSuffix = nextArgument;
 			break;
 
+		case 'f':
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+			switch (nextArgument[0])
+			{
+			case 'h':
+				m_settings.outputFormat = OutputFormat::Header;
+				break;
+
+			case 'j':
+				m_settings.outputFormat = OutputFormat::Json;
+				break;
+
+			case 'b':
+				m_settings.outputFormat = OutputFormat::Binary;
+				break;
+
+			default:
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+			break;
+
+		case 'm':
+		{
+			if (nextArgument.empty())
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++argumentPointer;
+
+			char* end = nullptr;
+			const auto megabytes = strtoull(nextArgument.c_str(), &end, 10);
+			if (*end != '\0' || megabytes == 0)
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			m_settings.memoryBudget = static_cast<size_t>(megabytes) * 1024 * 1024;
+			break;
+		}
+
 		case 'p':
 			m_settings.pdbHeaderReconstructorSettings.createPaddingMembers = !offSwitch;
 			break;
@@ -206,63 +623,224 @@ void PDBExtractor::ParseParameters(int argc, char** argv)
 		}
 	}
 
-	m_headerReconstructor = std::make_unique<PDBHeaderReconstructor>(m_settings.pdbHeaderReconstructorSettings);
-	m_symbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition>>(m_headerReconstructor.get());
+	if (!m_settings.outputDirectory.empty() &&
+	    (m_settings.memoryBudget != 0 || m_settings.outputFormat != OutputFormat::Header))
+	{
+		// Split output needs the dependency edges of the whole graph and
+		// only makes sense for headers.
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.outputFormat == OutputFormat::Binary && m_settings.outputFilename.empty())
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.serverSocketPath.empty() && !m_settings.merge && !m_settings.additionalPdbPaths.empty())
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.merge && m_settings.additionalPdbPaths.empty())
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if ((m_settings.resolveLines || m_settings.inlineFrames) && m_settings.addressFilename.empty())
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (!m_settings.addressFilename.empty() &&
+	    (m_settings.memoryBudget != 0 || !m_settings.typeSelection.empty() || !m_settings.outputDirectory.empty()))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.dumpFilename.empty() &&
+	    (!m_settings.dumpTypeName.empty() || !m_settings.dumpAddressFilename.empty() || m_settings.dumpBaseAddress != 0 ||
+	     !m_settings.dumpNextFieldPath.empty() || !m_settings.dumpLinkFieldPath.empty() || !m_settings.dumpFieldPaths.empty()))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.dumpNextFieldPath.empty() && !m_settings.dumpLinkFieldPath.empty())
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (!m_settings.dumpFilename.empty() &&
+	    (m_settings.dumpTypeName.empty() || m_settings.dumpAddressFilename.empty() ||
+	     m_settings.memoryBudget != 0 || !m_settings.typeSelection.empty() || !m_settings.addressFilename.empty() ||
+	     !m_settings.outputDirectory.empty() || m_settings.outputFormat == OutputFormat::Binary))
+	{
+		// Decoding reads one type, lazily, and writes records of its own.
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	const int queryModeCount =
+		!m_settings.serverSocketPath.empty() +
+		!m_settings.queryFilename.empty() +
+		!m_settings.query.empty() +
+		m_settings.interactive +
+		m_settings.analyzeLayouts +
+		!m_settings.diffPdbPath.empty() +
+		!m_settings.typeStoreDirectory.empty() +
+		!m_settings.offsetHistoryBuild.empty() +
+		m_settings.merge;
+
+	if (queryModeCount > 1 ||
+	    (queryModeCount == 1 && (IsLoadedLazily() || !m_settings.outputDirectory.empty())))
+	{
+		// Queries need fully loaded PDBs and render into responses.
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if ((!m_settings.diffPdbPath.empty() || m_settings.merge) && m_settings.outputFormat == OutputFormat::Binary)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (m_settings.batch &&
+	    ((m_settings.outputDirectory.empty() && m_settings.offsetHistoryFilename.empty() && m_settings.symbolCacheDirectory.empty()) ||
+	     m_settings.outputFormat == OutputFormat::Binary || IsLoadedLazily() || queryModeCount != 0))
+	{
+		// Batches write one whole header (or JSON file) per PDB, or the
+		// offset history of all of them, or only fetch the PDBs.
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (!m_settings.offsetHistoryFilename.empty() && !m_settings.batch)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	if (!m_settings.outputFilename.empty())
+	{
+		// Opened after parsing, when the output format is known.
+		const auto mode = m_settings.outputFormat == OutputFormat::Binary
+			? std::ios::out | std::ios::binary
+			: std::ios::out;
+
+		m_settings.pdbHeaderReconstructorSettings.outputFile = std::make_unique<std::ofstream>(m_settings.outputFilename, mode);
+		m_settings.pdbHeaderReconstructorSettings.output = *m_settings.pdbHeaderReconstructorSettings.outputFile;
+	}
+
+	CreateSymbolVisitor();
 	m_symbolSorter = std::make_unique<PDBSymbolSorter>();
 }
 
+void PDBExtractor::CreateSymbolVisitor()
+{
+	auto& reconstructorSettings = m_settings.pdbHeaderReconstructorSettings;
+
+	if (m_settings.outputFormat == OutputFormat::Json)
+	{
+		auto jsonReconstructor = std::make_unique<PDBJsonReconstructor>(reconstructorSettings.output.get());
+		m_symbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinitionBase, PDBJsonReconstructor>>(jsonReconstructor.get());
+		m_headerReconstructor = std::move(jsonReconstructor);
+		return;
+	}
+
+	if (m_settings.outputFormat == OutputFormat::Binary)
+	{
+		auto binaryReconstructor = std::make_unique<PDBBinaryReconstructor>(reconstructorSettings.output.get());
+		m_symbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinitionBase, PDBBinaryReconstructor>>(binaryReconstructor.get());
+		m_headerReconstructor = std::move(binaryReconstructor);
+		return;
+	}
+
+	StaticPipelineFactory<>::Create(
+		reconstructorSettings,
+		m_headerReconstructor,
+		m_symbolVisitor,
+		reconstructorSettings.showOffsets,
+		reconstructorSettings.createPaddingMembers,
+		reconstructorSettings.allowBitFieldsInUnion,
+		reconstructorSettings.allowAnonymousDataTypes);
+}
+
 void PDBExtractor::OpenPDBFile()
 {
-	if (!m_pdb.Open(m_settings.pdbPath))
+	const auto loadMode = IsLoadedLazily() ? PDB::LoadMode::Lazy : PDB::LoadMode::Full;
+	auto pdbPath = m_settings.pdbPath;
+
+	if (!m_settings.symbolCacheDirectory.empty() && GetLowercaseExtension(pdbPath) != ".pdb")
+	{
+		std::vector<SymbolStoreFetchResult> results;
+		FetchImagePDBs({ pdbPath }, results);
+
+		if (results[0].pdbPath.empty())
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+
+		pdbPath = results[0].pdbPath;
+	}
+
+	if (!m_pdb.Open(pdbPath, loadMode))
 	{
 		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
 	}
 }
 
-void PDBExtractor::PrintPDBDefinitions()
+void PDBExtractor::FetchImagePDBs(const std::vector<std::filesystem::path>& imagePaths, std::vector<SymbolStoreFetchResult>& results) const
 {
-	for (const auto& symIndex : m_symbolSorter->GetSortedSymbolIndexes())
+	SymbolStoreFetcher fetcher(m_settings.symbolCacheDirectory, m_settings.symbolServerUrl, GetThreadCount());
+	if (!fetcher.IsOpen())
 	{
-		bool expand = true;
+		throw PDBDumperException(MESSAGE_INVALID_SYMBOL_SERVER);
+	}
 
-		auto symbol = m_pdb.GetSymbolBySymbolIndex(symIndex);
-		assert(symbol);
+	//
+	// Every fetch is started before any is waited for; images of the same
+	// build share one download.
+	//
+	std::vector<std::shared_future<SymbolStoreFetchResult>> fetches(imagePaths.size());
 
-		if (m_settings.pdbHeaderReconstructorSettings.memberStructExpansion ==
-		    PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
-		    symbol->tag == SymTagUDT &&
-		    PDB::IsUnnamedSymbol(*symbol))
+	for (size_t i = 0; i < imagePaths.size(); ++i)
+	{
+		SymbolStoreKey key;
+		if (SymbolStoreFetcher::GetKey(imagePaths[i], key))
 		{
-			expand = false;
+			fetches[i] = fetcher.Fetch(key);
 		}
+	}
 
-		if (expand)
+	results.assign(imagePaths.size(), SymbolStoreFetchResult{});
+
+	for (size_t i = 0; i < imagePaths.size(); ++i)
+	{
+		if (fetches[i].valid())
 		{
-			m_symbolVisitor->Run(*symbol);
+			results[i] = fetches[i].get();
 		}
 	}
 }
 
-void PDBExtractor::PrintPDBFunctions()
+bool PDBExtractor::IsLoadedLazily() const
 {
-	m_settings.pdbHeaderReconstructorSettings.output.get() << "/*" << std::endl;
-
-	for (const auto& func : m_pdb.GetFunctionSet())
-	{
-		m_settings.pdbHeaderReconstructorSettings.output.get() << func << std::endl;
-	}
+	// Symbolizing only reads the public symbols, decoding a dump one type.
+	return m_settings.memoryBudget != 0 || !m_settings.typeSelection.empty() || !m_settings.addressFilename.empty() ||
+	       !m_settings.dumpFilename.empty();
+}
 
-	m_settings.pdbHeaderReconstructorSettings.output.get() << "*/" << std::endl;
+bool PDBExtractor::ShouldPrintSymbol(const Symbol& symbol) const
+{
+	return !(m_settings.pdbHeaderReconstructorSettings.memberStructExpansion ==
+	         PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
+	         symbol.tag == SymTagUDT &&
+	         PDB::IsUnnamedSymbol(symbol));
 }
 
-void PDBExtractor::DumpAllSymbols()
+bool PDBExtractor::ShouldPrintFunctions() const
 {
-	for (const auto&[_, symbol] : m_pdb.GetSymbolMap())
-	{
-		assert(symbol);
-		m_symbolSorter->Visit(*symbol);
-	}
+	// The binary layout only describes types, and a type selection only
+	// the selected ones.
+	return m_settings.outputFormat != OutputFormat::Binary && m_settings.typeSelection.empty();
+}
 
-	PrintPDBDefinitions();
-	PrintPDBFunctions();
+size_t PDBExtractor::GetThreadCount() const
+{
+	return m_settings.threadCount != 0 ? m_settings.threadCount : std::thread::hardware_concurrency();
 }
@@ -3,33 +3,180 @@
 #include "PDBHeaderReconstructor.h"
 #include "PDBSymbolVisitor.h"
 #include "UdtFieldDefinition.h"
+#include "PDBSplitOutputWriter.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+
+class SymbolDumpImage;
+class SymbolDumpWalker;
+class SymbolOffsetHistoryWriter;
+struct SymbolStoreFetchResult;
 
 class PDBExtractor
 {
 public:
+    enum class OutputFormat
+    {
+        Header,
+        Json,
+        Binary,
+    };
+
     struct Settings
     {
         PDBHeaderReconstructor::Settings pdbHeaderReconstructorSettings;
 
         std::filesystem::path pdbPath;
         std::filesystem::path outputFilename;
+        OutputFormat outputFormat = OutputFormat::Header;
+        std::filesystem::path outputDirectory;
+        PDBSplitOutputWriter::SplitType splitType = PDBSplitOutputWriter::SplitType::PerType;
+
+        // Non-zero selects streaming extraction with this decoded-symbol budget.
+        size_t memoryBudget = 0;
+
+        // Type names, globs ("_KPROCESS*") or regexes ("/^_MM.*/"). When set,
+        // only these types and what they depend on by value are extracted.
+        std::vector<std::string> typeSelection;
+
+        // Non-empty runs the query server on this socket instead of dumping.
+        std::filesystem::path serverSocketPath;
+
+        // Served next to pdbPath, or merged into its types.
+        std::vector<std::filesystem::path> additionalPdbPaths;
+
+        // Non-empty answers the queries in this file ("-" for stdin) instead
+        // of dumping.
+        std::string queryFilename;
+
+        // Non-empty answers this single query instead of dumping.
+        std::string query;
+
+        // Answers queries typed at a prompt instead of dumping.
+        bool interactive = false;
+
+        // Reports layout holes and cache line straddles instead of dumping.
+        bool analyzeLayouts = false;
+
+        // Non-empty reports how the types of pdbPath changed in this PDB
+        // instead of dumping.
+        std::filesystem::path diffPdbPath;
+
+        // Non-empty adds the types of the PDB to the type store in this
+        // directory instead of dumping.
+        std::filesystem::path typeStoreDirectory;
+
+        // Non-empty writes the field offset history of a batch here.
+        std::filesystem::path offsetHistoryFilename;
+
+        // Non-empty lists the offsets of this build ("<GUID><age>") in the
+        // history at pdbPath instead of dumping.
+        std::string offsetHistoryBuild;
+
+        // pdbPath is a directory or list of PDBs, each extracted into its
+        // own file in outputDirectory.
+        bool batch = false;
+
+        // Dumps the types of pdbPath and additionalPdbPaths as one
+        // deduplicated set.
+        bool merge = false;
+
+        // Non-empty fetches the PDBs of PE images given in place of PDBs
+        // from symbolServerUrl into this cache, laid out like a symbol store.
+        std::filesystem::path symbolCacheDirectory;
+        std::string symbolServerUrl = "https://msdl.microsoft.com/download/symbols";
+
+        // Non-empty symbolizes the RVAs in this file ("-" for stdin)
+        // instead of dumping.
+        std::string addressFilename;
+
+        // Adds file:line to symbolized addresses; the line table is cached in
+        // lineCacheFilename when it is set.
+        bool resolveLines = false;
+        std::filesystem::path lineCacheFilename;
+
+        // Adds the functions inlined at each symbolized address.
+        bool inlineFrames = false;
+
+        // Non-empty decodes instances of dumpTypeName out of this dump, at
+        // the addresses listed in dumpAddressFilename ("-" for stdin),
+        // instead of dumping. dumpBaseAddress is where a raw memory image
+        // starts.
+        std::filesystem::path dumpFilename;
+        std::string dumpTypeName;
+        std::string dumpAddressFilename;
+        uint64_t dumpBaseAddress = 0;
+
+        // Non-empty walks the lists starting at the listed addresses instead,
+        // following the pointer at this member path of each node and
+        // decoding every node reached. dumpLinkFieldPath is the member that
+        // pointer points to; it defaults to the member holding the pointer
+        // (the LIST_ENTRY of a Flink).
+        std::string dumpNextFieldPath;
+        std::string dumpLinkFieldPath;
+
+        // Non-empty decodes only the leaves at or below these member paths.
+        std::vector<std::string> dumpFieldPaths;
+
+        // Zero uses one thread per core.
+        size_t threadCount = 0;
     };
 
     int Run(int argc, char** argv);
 
 private:
+    struct BatchResult
+    {
+        std::filesystem::path outputPath;
+        bool succeeded = false;
+        size_t typeCount = 0;
+        std::chrono::steady_clock::duration loadDuration{};
+        std::chrono::steady_clock::duration renderDuration{};
+    };
+
     void PrintUsage();
     void ParseParameters(int argc, char** argv);
     void OpenPDBFile();
+    void FetchImagePDBs(const std::vector<std::filesystem::path>& imagePaths, std::vector<SymbolStoreFetchResult>& results) const;
+    bool ShouldPrintSymbol(const Symbol& symbol) const;
+    bool ShouldPrintFunctions() const;
+    bool IsLoadedLazily() const;
     void PrintPDBDefinitions();
-    void PrintPDBFunctions();
+    void PrintPDBDefinitionsSplit();
+    void PrintPDBFunctions(PDB& pdb, std::ostream& output) const;
     void DumpAllSymbols();
+    void DumpAllSymbolsStreaming();
+    void DumpSelectedSymbols();
+    void RunQueryServer();
+    void RunQueryBatch();
+    void RunQuery();
+    void RunInteractive();
+    void AnalyzeLayouts();
+    void DiffPDBs();
+    void IngestIntoTypeStore();
+    void LookupOffsetHistory();
+    void MergePDBs();
+    void RunBatch();
+    bool FetchBatchPDBs(std::vector<std::filesystem::path>& pdbPaths, bool reportAll) const;
+    void ExtractBatchPDB(
+        ThreadPool& pool,
+        size_t pdbIndex,
+        const std::filesystem::path& pdbPath,
+        SymbolOffsetHistoryWriter* offsetHistory,
+        BatchResult& result) const;
+    void RenderSymbols(const Symbol* const* begin, const Symbol* const* end, std::string& output) const;
+    void SymbolizeAddresses();
+    void DecodeDump();
+    std::unique_ptr<SymbolDumpWalker> CreateDumpWalker(const SymbolDumpImage& image, const Symbol& udt, DWORD& headSize);
+    size_t GetThreadCount() const;
+    void CreateSymbolVisitor();
 
 private:
     PDB m_pdb;
     Settings m_settings;
 
     std::unique_ptr<PDBSymbolSorterBase> m_symbolSorter;
-    std::unique_ptr<PDBHeaderReconstructor> m_headerReconstructor;
-    std::unique_ptr<PDBSymbolVisitor<UdtFieldDefinition>> m_symbolVisitor;
+    std::unique_ptr<PDBReconstructorBase> m_headerReconstructor;
+    std::unique_ptr<PDBSymbolVisitorBase> m_symbolVisitor;
 };
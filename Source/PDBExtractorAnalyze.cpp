@@ -0,0 +1,135 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolLayoutAnalyzer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+
+void PDBExtractor::AnalyzeLayouts()
+{
+	//
+	// One report per named UDT; definitions win over forward declarations
+	// of the same name.
+	//
+	std::unordered_map<std::string, const Symbol*> udts;
+
+	for (const auto&[_, symbol] : m_pdb.GetSymbolMap())
+	{
+		if (symbol->tag != SymTagUDT || symbol->size == 0 || PDB::IsUnnamedSymbol(*symbol))
+		{
+			continue;
+		}
+
+		udts.emplace(symbol->name, symbol.get());
+	}
+
+	std::vector<SymbolLayoutReport> reports(udts.size());
+
+	{
+		ThreadPool pool(GetThreadCount());
+
+		const size_t chunkSize = (reports.size() + pool.GetThreadCount() * 4 - 1) / (pool.GetThreadCount() * 4);
+		auto udtIt = udts.begin();
+
+		for (size_t begin = 0; begin < reports.size(); begin += chunkSize)
+		{
+			const size_t end = (std::min)(begin + chunkSize, reports.size());
+
+			std::vector<const Symbol*> chunk;
+			for (size_t i = begin; i < end; ++i, ++udtIt)
+			{
+				chunk.push_back(udtIt->second);
+			}
+
+			pool.Submit([&reports, begin, chunk = std::move(chunk)]()
+			{
+				for (size_t i = 0; i < chunk.size(); ++i)
+				{
+					SymbolLayoutAnalyzer::Analyze(*chunk[i], reports[begin + i]);
+				}
+			});
+		}
+
+		pool.Wait();
+	}
+
+	//
+	// Most wasted bytes first; among equals, the larger type first, as
+	// each instance of it costs more cache.
+	//
+	std::sort(reports.begin(), reports.end(), [](const SymbolLayoutReport& lhs, const SymbolLayoutReport& rhs)
+	{
+		const DWORD lhsWaste = lhs.GetWastedBytes();
+		const DWORD rhsWaste = rhs.GetWastedBytes();
+
+		if (lhsWaste != rhsWaste)
+		{
+			return lhsWaste > rhsWaste;
+		}
+
+		return lhs.udt->size != rhs.udt->size ? lhs.udt->size > rhs.udt->size : lhs.udt->name < rhs.udt->name;
+	});
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+	auto hex = [](DWORD value)
+	{
+		char text[16];
+		const auto result = std::to_chars(text, text + sizeof(text), value, 16);
+		return "0x" + std::string(text, result.ptr);
+	};
+
+	std::string buffer;
+	uint64_t totalWastedBytes = 0;
+	size_t reportedTypeCount = 0;
+
+	for (const auto& report : reports)
+	{
+		const DWORD wastedBytes = report.GetWastedBytes();
+		if (wastedBytes == 0 && report.bitFieldWasteBits == 0 && report.straddles.empty())
+		{
+			continue;
+		}
+
+		totalWastedBytes += wastedBytes;
+		++reportedTypeCount;
+
+		buffer.clear();
+		buffer += report.udt->name;
+		buffer += " size " + std::to_string(report.udt->size);
+		buffer += " wasted " + std::to_string(wastedBytes);
+		buffer += " cachelines " + std::to_string(report.cacheLineCount);
+		buffer += '\n';
+
+		for (const auto& hole : report.holes)
+		{
+			buffer += "    hole " + hex(hole.offset) + ' ' + std::to_string(hole.size);
+			buffer += hole.after.empty() ? std::string() : " after " + hole.after;
+			buffer += '\n';
+		}
+
+		if (report.trailingPadding != 0)
+		{
+			buffer += "    padding " + hex(report.udt->size - report.trailingPadding) + ' ' + std::to_string(report.trailingPadding) + '\n';
+		}
+
+		if (report.hasVirtualBases)
+		{
+			buffer += "    holes not reported: virtual bases\n";
+		}
+
+		if (report.bitFieldWasteBits != 0)
+		{
+			buffer += "    bitfield " + std::to_string(report.bitFieldWasteBits) + " bits unused\n";
+		}
+
+		for (const auto& straddle : report.straddles)
+		{
+			buffer += "    straddle " + hex(straddle.offset) + ' ' + std::to_string(straddle.size) + ' ' + straddle.path + '\n';
+		}
+
+		output << buffer;
+	}
+
+	output << "total wasted " << totalWastedBytes << " bytes in " << reportedTypeCount << " of " << reports.size() << " types\n";
+	output.flush();
+}
@@ -0,0 +1,432 @@
+#include "PDBExtractorCommon.h"
+#include "PDBSymbolSorter.h"
+#include "PDBJsonReconstructor.h"
+#include "SymbolOffsetHistory.h"
+#include "SymbolStoreFetcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+	// Types rendered per subtask in batch mode. Fixed rather than derived
+	// from the thread count, so the output does not depend on -j.
+	static const size_t BatchRenderChunkSize = 256;
+
+	bool IsImagePath(const std::filesystem::path& path)
+	{
+		const auto extension = GetLowercaseExtension(path);
+		return extension == ".exe" || extension == ".dll" || extension == ".sys";
+	}
+}
+
+void PDBExtractor::RunBatch()
+{
+	//
+	// <path> is a directory searched for PDBs, or a file listing one PDB
+	// per line. With a symbol cache, PE images may stand in for their PDBs.
+	//
+	std::vector<std::filesystem::path> pdbPaths;
+	std::error_code error;
+
+	const bool fetchesImages = !m_settings.symbolCacheDirectory.empty();
+
+	if (std::filesystem::is_directory(m_settings.pdbPath, error))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(m_settings.pdbPath, error))
+		{
+			if (entry.is_regular_file(error) &&
+			    (GetLowercaseExtension(entry.path()) == ".pdb" || (fetchesImages && IsImagePath(entry.path()))))
+			{
+				pdbPaths.push_back(entry.path());
+			}
+		}
+
+		std::sort(pdbPaths.begin(), pdbPaths.end());
+	}
+	else
+	{
+		std::ifstream listFile(m_settings.pdbPath);
+		if (!listFile)
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+
+		std::string line;
+		while (std::getline(listFile, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (!line.empty())
+			{
+				pdbPaths.emplace_back(line);
+			}
+		}
+	}
+
+	// The PDBs that were fetched are extracted even when some were not.
+	bool fetchedAll = true;
+
+	if (fetchesImages)
+	{
+		const bool fetchesOnly = m_settings.outputDirectory.empty() && m_settings.offsetHistoryFilename.empty();
+
+		fetchedAll = FetchBatchPDBs(pdbPaths, fetchesOnly);
+
+		if (fetchesOnly)
+		{
+			if (!fetchedAll)
+			{
+				throw PDBDumperException(MESSAGE_FETCH_FAILED);
+			}
+
+			return;
+		}
+	}
+
+	//
+	// Outputs are named after the PDBs; PDBs sharing a name, like the
+	// builds of one binary in a symbol store, get numbered.
+	//
+	if (!m_settings.outputDirectory.empty())
+	{
+		std::filesystem::create_directories(m_settings.outputDirectory, error);
+	}
+
+	const auto extension = m_settings.outputFormat == OutputFormat::Json ? ".json" : ".h";
+	std::unordered_map<std::string, size_t> nameCounts;
+	std::vector<BatchResult> results(pdbPaths.size());
+
+	for (size_t i = 0; i < pdbPaths.size() && !m_settings.outputDirectory.empty(); ++i)
+	{
+		const auto stem = pdbPaths[i].stem().string();
+		const size_t count = ++nameCounts[stem];
+
+		results[i].outputPath = m_settings.outputDirectory / (count == 1 ? stem + extension : stem + '_' + std::to_string(count) + extension);
+	}
+
+	const auto batchStart = std::chrono::steady_clock::now();
+
+	std::unique_ptr<SymbolOffsetHistoryWriter> offsetHistory;
+	if (!m_settings.offsetHistoryFilename.empty())
+	{
+		offsetHistory = std::make_unique<SymbolOffsetHistoryWriter>();
+	}
+
+	{
+		ThreadPool pool(GetThreadCount());
+
+		for (size_t i = 0; i < pdbPaths.size(); ++i)
+		{
+			pool.Submit([this, &pool, &pdbPaths, &results, &offsetHistory, i]()
+			{
+				// One PDB failing leaves the rest of the batch running.
+				try
+				{
+					ExtractBatchPDB(pool, i, pdbPaths[i], offsetHistory.get(), results[i]);
+				}
+				catch (...)
+				{
+					results[i].succeeded = false;
+				}
+			});
+		}
+
+		pool.Wait();
+	}
+
+	if (offsetHistory && !offsetHistory->Write(m_settings.offsetHistoryFilename))
+	{
+		throw PDBDumperException(MESSAGE_OFFSET_HISTORY_FAILED);
+	}
+
+	const auto batchDuration = std::chrono::steady_clock::now() - batchStart;
+
+	//
+	// Summary, in input order.
+	//
+	auto milliseconds = [](std::chrono::steady_clock::duration duration)
+	{
+		return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+	};
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+	size_t succeededCount = 0;
+
+	for (size_t i = 0; i < pdbPaths.size(); ++i)
+	{
+		const auto& result = results[i];
+		succeededCount += result.succeeded;
+
+		output << pdbPaths[i].string()
+		       << (result.succeeded ? " ok" : " failed")
+		       << " types " << result.typeCount
+		       << " load " << milliseconds(result.loadDuration) << " ms"
+		       << " render " << milliseconds(result.renderDuration) << " ms\n";
+	}
+
+	output << succeededCount << " of " << pdbPaths.size() << " PDBs extracted in " << milliseconds(batchDuration) << " ms" << std::endl;
+
+	if (succeededCount != pdbPaths.size())
+	{
+		throw PDBDumperException(MESSAGE_BATCH_FAILED);
+	}
+
+	if (!fetchedAll)
+	{
+		throw PDBDumperException(MESSAGE_FETCH_FAILED);
+	}
+}
+
+bool PDBExtractor::FetchBatchPDBs(std::vector<std::filesystem::path>& pdbPaths, bool reportAll) const
+{
+	std::vector<std::filesystem::path> imagePaths;
+	std::vector<size_t> imageIndexes;
+
+	for (size_t i = 0; i < pdbPaths.size(); ++i)
+	{
+		if (GetLowercaseExtension(pdbPaths[i]) != ".pdb")
+		{
+			imagePaths.push_back(pdbPaths[i]);
+			imageIndexes.push_back(i);
+		}
+	}
+
+	const auto fetchStart = std::chrono::steady_clock::now();
+
+	std::vector<SymbolStoreFetchResult> results;
+	FetchImagePDBs(imagePaths, results);
+
+	const auto fetchDuration = std::chrono::steady_clock::now() - fetchStart;
+
+	//
+	// Images are replaced by their PDBs in the cache. Images whose PDB is
+	// missing are dropped from the batch; they are always reported, the
+	// others only when fetching is all the batch does.
+	//
+	static const char* const StatusNames[] = { "cached", "downloaded", "not found", "failed" };
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+	size_t fetchedCount = 0;
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const auto& result = results[i];
+		const bool fetched = !result.pdbPath.empty();
+
+		fetchedCount += fetched;
+
+		if (reportAll || !fetched)
+		{
+			output << imagePaths[i].string() << ' ' << StatusNames[static_cast<size_t>(result.status)];
+
+			if (fetched)
+			{
+				output << ' ' << result.pdbPath.string();
+			}
+
+			if (result.bytesDownloaded != 0)
+			{
+				output << " bytes " << result.bytesDownloaded << (result.resumed ? " resumed" : "");
+			}
+
+			output << '\n';
+		}
+
+		pdbPaths[imageIndexes[i]] = result.pdbPath;
+	}
+
+	pdbPaths.erase(std::remove(pdbPaths.begin(), pdbPaths.end(), std::filesystem::path()), pdbPaths.end());
+
+	output << fetchedCount << " of " << results.size() << " PDBs fetched in "
+	       << std::chrono::duration_cast<std::chrono::milliseconds>(fetchDuration).count() << " ms" << std::endl;
+
+	return fetchedCount == results.size();
+}
+
+void PDBExtractor::ExtractBatchPDB(
+	ThreadPool& pool,
+	size_t pdbIndex,
+	const std::filesystem::path& pdbPath,
+	SymbolOffsetHistoryWriter* offsetHistory,
+	BatchResult& result) const
+{
+	//
+	// The PDB is opened and closed by this task, on one thread, because
+	// DIA sessions are bound to the thread's COM initialization. Only the
+	// rendering is shared with other workers.
+	//
+	const auto loadStart = std::chrono::steady_clock::now();
+
+	PDB pdb;
+	if (!pdb.Open(pdbPath, PDB::LoadMode::Full))
+	{
+		return;
+	}
+
+	if (offsetHistory && !offsetHistory->AddBuild(pdbIndex, pdb))
+	{
+		return;
+	}
+
+	PDBSymbolSorter sorter;
+	for (const auto&[_, symbol] : pdb.GetSymbolMap())
+	{
+		assert(symbol);
+		sorter.Visit(*symbol);
+	}
+
+	//
+	// Chunks of sorted types are claimed through a shared counter, by this
+	// task and by helper tasks idle workers steal from its queue. Reconstructors
+	// keep state across types, so every chunk gets its own; with every type
+	// inlined (-e a) each type is expanded once per file, so the whole PDB
+	// is one chunk.
+	//
+	struct RenderJob
+	{
+		std::vector<const Symbol*> symbols;
+		std::vector<std::string> chunks;
+		size_t chunkSize = 0;
+		std::atomic<size_t> nextChunk = 0;
+		std::atomic<bool> failed = false;
+
+		std::mutex mutex;
+		std::condition_variable chunksDone;
+		size_t finishedChunkCount = 0;
+	};
+
+	auto job = std::make_shared<RenderJob>();
+
+	for (const auto symIndex : sorter.GetSortedSymbolIndexes())
+	{
+		auto symbol = pdb.GetSymbolBySymbolIndex(symIndex);
+		assert(symbol);
+
+		if (ShouldPrintSymbol(*symbol))
+		{
+			job->symbols.push_back(symbol.get());
+		}
+	}
+
+	const bool isSingleChunk = m_settings.pdbHeaderReconstructorSettings.memberStructExpansion == PDBMemberStructExpansionType::InlineAll;
+
+	job->chunkSize = isSingleChunk ? (std::max)(job->symbols.size(), size_t{ 1 }) : BatchRenderChunkSize;
+	job->chunks.resize((job->symbols.size() + job->chunkSize - 1) / job->chunkSize);
+
+	const auto renderStart = std::chrono::steady_clock::now();
+	result.loadDuration = renderStart - loadStart;
+	result.typeCount = job->symbols.size();
+
+	if (m_settings.outputDirectory.empty())
+	{
+		result.succeeded = true;
+		return;
+	}
+
+	auto renderChunks = [this, job]()
+	{
+		for (size_t chunk; (chunk = job->nextChunk++) < job->chunks.size();)
+		{
+			try
+			{
+				const size_t begin = chunk * job->chunkSize;
+				const size_t end = (std::min)(begin + job->chunkSize, job->symbols.size());
+
+				RenderSymbols(job->symbols.data() + begin, job->symbols.data() + end, job->chunks[chunk]);
+			}
+			catch (...)
+			{
+				job->failed = true;
+			}
+
+			std::lock_guard<std::mutex> lock(job->mutex);
+			if (++job->finishedChunkCount == job->chunks.size())
+			{
+				job->chunksDone.notify_all();
+			}
+		}
+	};
+
+	const size_t helperCount = (std::min)(job->chunks.size(), pool.GetThreadCount()) - (job->chunks.empty() ? 0 : 1);
+	for (size_t i = 0; i < helperCount; ++i)
+	{
+		pool.Submit(renderChunks);
+	}
+
+	renderChunks();
+
+	//
+	// Every chunk is claimed by now; only those other workers are still
+	// rendering remain, and they finish without this worker's help.
+	//
+	{
+		std::unique_lock<std::mutex> lock(job->mutex);
+		job->chunksDone.wait(lock, [&job] { return job->finishedChunkCount == job->chunks.size(); });
+	}
+
+	if (job->failed)
+	{
+		return;
+	}
+
+	std::ofstream outputFile(result.outputPath, std::ios::out | std::ios::trunc);
+
+	for (const auto& chunk : job->chunks)
+	{
+		outputFile << chunk;
+	}
+
+	PrintPDBFunctions(pdb, outputFile);
+
+	outputFile.close();
+
+	result.renderDuration = std::chrono::steady_clock::now() - renderStart;
+	result.succeeded = static_cast<bool>(outputFile);
+}
+
+void PDBExtractor::RenderSymbols(const Symbol* const* begin, const Symbol* const* end, std::string& output) const
+{
+	std::ostringstream stream;
+
+	PDBHeaderReconstructorSettings settings;
+	CopyRenderSettings(m_settings.pdbHeaderReconstructorSettings, settings);
+	settings.output = stream;
+
+	std::unique_ptr<PDBReconstructorBase> reconstructor;
+	std::unique_ptr<PDBSymbolVisitorBase> visitor;
+
+	if (m_settings.outputFormat == OutputFormat::Json)
+	{
+		auto jsonReconstructor = std::make_unique<PDBJsonReconstructor>(stream);
+		visitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinitionBase, PDBJsonReconstructor>>(jsonReconstructor.get());
+		reconstructor = std::move(jsonReconstructor);
+	}
+	else
+	{
+		StaticPipelineFactory<>::Create(
+			settings,
+			reconstructor,
+			visitor,
+			settings.showOffsets,
+			settings.createPaddingMembers,
+			settings.allowBitFieldsInUnion,
+			settings.allowAnonymousDataTypes);
+	}
+
+	for (auto symbol = begin; symbol != end; ++symbol)
+	{
+		visitor->Visit(**symbol);
+	}
+
+	output = stream.str();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "PDBExtractor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+//
+// Shared by the source files of PDBExtractor. PDBExtractor.cpp parses the
+// arguments and dispatches; every mode lives in a PDBExtractor<Mode>.cpp.
+//
+
+static const char* MESSAGE_INVALID_PARAMETERS = "Invalid parameters";
+static const char* MESSAGE_FILE_NOT_FOUND = "File not found";
+static const char* MESSAGE_SYMBOL_NOT_FOUND = "Symbol not found";
+static const char* MESSAGE_CANNOT_LISTEN = "Cannot listen on socket";
+static const char* MESSAGE_NO_LINE_INFORMATION = "No line information";
+static const char* MESSAGE_BATCH_FAILED = "Some PDBs could not be extracted";
+static const char* MESSAGE_TYPE_STORE_FAILED = "Type store could not be updated";
+static const char* MESSAGE_OFFSET_HISTORY_FAILED = "Offset history could not be written";
+static const char* MESSAGE_BUILD_NOT_FOUND = "Build not found";
+static const char* MESSAGE_INVALID_SYMBOL_SERVER = "Invalid symbol server URL";
+static const char* MESSAGE_FETCH_FAILED = "Some PDBs could not be fetched";
+static const char* MESSAGE_INVALID_DUMP = "Dump could not be read";
+
+class PDBDumperException : public std::runtime_error
+{
+public:
+    PDBDumperException(const char* Message)
+        : std::runtime_error(Message)
+    {
+
+    }
+};
+
+inline std::string GetLowercaseExtension(const std::filesystem::path& path)
+{
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    return extension;
+}
+
+//
+// Turns the runtime values of the hot header settings into template
+// arguments one flag at a time, so the chosen visitor/reconstructor
+// pair is fully resolved at compile time.
+//
+template <bool... HOT_SETTINGS>
+struct StaticPipelineFactory
+{
+    template <typename... FLAGS>
+    static void Create(
+        PDBHeaderReconstructor::Settings& settings,
+        std::unique_ptr<PDBReconstructorBase>& reconstructor,
+        std::unique_ptr<PDBSymbolVisitorBase>& visitor,
+        bool flag,
+        FLAGS... flags)
+    {
+        if (flag)
+        {
+            StaticPipelineFactory<HOT_SETTINGS..., true>::Create(settings, reconstructor, visitor, flags...);
+        }
+        else
+        {
+            StaticPipelineFactory<HOT_SETTINGS..., false>::Create(settings, reconstructor, visitor, flags...);
+        }
+    }
+
+    static void Create(
+        PDBHeaderReconstructor::Settings& settings,
+        std::unique_ptr<PDBReconstructorBase>& reconstructor,
+        std::unique_ptr<PDBSymbolVisitorBase>& visitor)
+    {
+        using Reconstructor = PDBStaticHeaderReconstructor<HOT_SETTINGS...>;
+
+        auto staticReconstructor = std::make_unique<Reconstructor>(settings);
+        visitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition, Reconstructor>>(staticReconstructor.get());
+        reconstructor = std::move(staticReconstructor);
+    }
+};
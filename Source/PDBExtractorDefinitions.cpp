@@ -0,0 +1,369 @@
+#include "PDBExtractorCommon.h"
+#include "PDBJsonReconstructor.h"
+#include "SymbolNameIndex.h"
+
+#include <algorithm>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+	bool IsGlobPattern(const std::string& pattern)
+	{
+		return pattern.find_first_of("*?") != std::string::npos;
+	}
+
+	bool IsRegexPattern(const std::string& pattern)
+	{
+		return pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/';
+	}
+}
+
+void PDBExtractor::PrintPDBDefinitions()
+{
+	for (const auto& symIndex : m_symbolSorter->GetSortedSymbolIndexes())
+	{
+		auto symbol = m_pdb.GetSymbolBySymbolIndex(symIndex);
+		assert(symbol);
+
+		if (ShouldPrintSymbol(*symbol))
+		{
+			m_symbolVisitor->Visit(*symbol);
+		}
+	}
+
+	if (ShouldPrintFunctions())
+	{
+		PrintPDBFunctions(m_pdb, m_settings.pdbHeaderReconstructorSettings.output.get());
+	}
+}
+
+void PDBExtractor::PrintPDBDefinitionsSplit()
+{
+	struct OutputUnit
+	{
+		std::string path;
+		std::ostringstream content;
+		std::vector<DWORD> symIndexes;
+	};
+
+	PDBSplitOutputWriter writer(m_settings.outputDirectory);
+
+	std::vector<std::unique_ptr<OutputUnit>> units;
+	std::unordered_map<std::string, OutputUnit*> unitsByPath;
+	std::unordered_map<DWORD, OutputUnit*> unitsBySymIndex;
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output;
+	const auto previousOutput = output;
+
+	//
+	// Rendering stays sequential because the reconstructor keeps state
+	// across types; only the file writes go to the writer pool.
+	//
+	for (const auto& symIndex : m_symbolSorter->GetSortedSymbolIndexes())
+	{
+		auto symbol = m_pdb.GetSymbolBySymbolIndex(symIndex);
+		assert(symbol);
+
+		if (!ShouldPrintSymbol(*symbol))
+		{
+			continue;
+		}
+
+		std::string unitKey;
+		if (m_settings.splitType == PDBSplitOutputWriter::SplitType::PerNamespace)
+		{
+			unitKey = PDBSplitOutputWriter::GetNamespace(symbol->name);
+		}
+		else
+		{
+			unitKey = PDB::IsUnnamedSymbol(*symbol) ? "__unnamed_" + std::to_string(symIndex) : symbol->name;
+		}
+
+		const auto& path = writer.GetUnitPath(unitKey);
+
+		auto& unit = unitsByPath[path];
+		if (!unit)
+		{
+			units.push_back(std::make_unique<OutputUnit>());
+			unit = units.back().get();
+			unit->path = path;
+		}
+
+		unit->symIndexes.push_back(symIndex);
+		unitsBySymIndex[symIndex] = unit;
+
+		output = unit->content;
+		m_symbolVisitor->Visit(*symbol);
+	}
+
+	output = previousOutput;
+
+	std::string umbrellaHeader = "#pragma once\n\n";
+
+	for (const auto& unit : units)
+	{
+		//
+		// Dependencies of types that are not written on their own (unnamed
+		// types inlined into their parent) are inherited by the parent.
+		//
+		std::vector<DWORD> pending(unit->symIndexes.begin(), unit->symIndexes.end());
+		std::unordered_set<DWORD> visited(pending.begin(), pending.end());
+		std::vector<const OutputUnit*> includes;
+
+		while (!pending.empty())
+		{
+			const DWORD symIndex = pending.back();
+			pending.pop_back();
+
+			for (const auto dependency : m_symbolSorter->GetSymbolDependencies(symIndex))
+			{
+				if (!visited.insert(dependency).second)
+				{
+					continue;
+				}
+
+				auto it = unitsBySymIndex.find(dependency);
+				if (it == unitsBySymIndex.end())
+				{
+					pending.push_back(dependency);
+				}
+				else if (it->second != unit.get() &&
+				         std::find(includes.begin(), includes.end(), it->second) == includes.end())
+				{
+					includes.push_back(it->second);
+				}
+			}
+		}
+
+		std::string header = "#pragma once\n\n";
+		for (const auto* include : includes)
+		{
+			header += "#include \"" + include->path + "\"\n";
+		}
+
+		if (!includes.empty())
+		{
+			header += "\n";
+		}
+
+		header += unit->content.str();
+		writer.Write(unit->path, std::move(header));
+
+		umbrellaHeader += "#include \"" + unit->path + "\"\n";
+	}
+
+	writer.Write("__all__.h", std::move(umbrellaHeader));
+
+	if (ShouldPrintFunctions())
+	{
+		std::ostringstream functions;
+		PrintPDBFunctions(m_pdb, functions);
+
+		writer.Write("__functions__.h", functions.str());
+	}
+
+	writer.Finish();
+
+	std::cout << units.size() << " headers: "
+	          << writer.GetWrittenFileCount() << " written, "
+	          << writer.GetUnchangedFileCount() << " unchanged" << std::endl;
+}
+
+void PDBExtractor::PrintPDBFunctions(PDB& pdb, std::ostream& output) const
+{
+	const bool json = m_settings.outputFormat == OutputFormat::Json;
+
+	std::string record;
+	auto printFunction = [&output, &record, json](const std::string& functionName)
+	{
+		if (json)
+		{
+			record = "{\"kind\":\"function\",\"name\":";
+			PDBJsonReconstructor::AppendString(record, functionName);
+			record += "}\n";
+			output << record;
+		}
+		else
+		{
+			output << functionName << '\n';
+		}
+	};
+
+	if (!json)
+	{
+		output << "/*" << std::endl;
+	}
+
+	if (IsLoadedLazily())
+	{
+		// Public symbols are streamed in PDB order instead of being
+		// collected into the sorted FunctionSet.
+		pdb.ForEachFunctionName(printFunction);
+	}
+	else
+	{
+		for (const auto& functionName : pdb.GetFunctionSet())
+		{
+			printFunction(functionName);
+		}
+	}
+
+	if (!json)
+	{
+		output << "*/" << std::endl;
+	}
+}
+
+void PDBExtractor::DumpAllSymbols()
+{
+	for (const auto&[_, symbol] : m_pdb.GetSymbolMap())
+	{
+		assert(symbol);
+		m_symbolSorter->Visit(*symbol);
+	}
+
+	if (!m_settings.outputDirectory.empty())
+	{
+		PrintPDBDefinitionsSplit();
+		return;
+	}
+
+	PrintPDBDefinitions();
+	m_headerReconstructor->OnFinish();
+}
+
+void PDBExtractor::DumpAllSymbolsStreaming()
+{
+	//
+	// Top-level types are decoded one at a time. Sorting a type emits it
+	// together with every dependency not emitted yet, so once it has been
+	// printed all decoded symbols are either emitted or only referenced
+	// through pointers, and the decoded graph can be dropped whenever it
+	// outgrows the budget. Already emitted names stay in the sorter, so
+	// types decoded again later are not printed twice.
+	//
+	const auto& sortedSymbolIndexes = m_symbolSorter->GetSortedSymbolIndexes();
+	size_t printedSymbolCount = 0;
+
+	m_pdb.ForEachTopLevelSymbol([&](const SymbolPtr& topLevelSymbol)
+	{
+		assert(topLevelSymbol);
+		m_symbolSorter->Visit(*topLevelSymbol);
+
+		for (; printedSymbolCount < sortedSymbolIndexes.size(); ++printedSymbolCount)
+		{
+			auto symbol = m_pdb.GetSymbolBySymbolIndex(sortedSymbolIndexes[printedSymbolCount]);
+			assert(symbol);
+
+			if (ShouldPrintSymbol(*symbol))
+			{
+				m_symbolVisitor->Visit(*symbol);
+			}
+		}
+
+		if (m_pdb.GetApproximateMemoryUsage() > m_settings.memoryBudget)
+		{
+			m_settings.pdbHeaderReconstructorSettings.output.get().flush();
+			m_pdb.ReleaseDecodedSymbols();
+		}
+	});
+
+	if (ShouldPrintFunctions())
+	{
+		PrintPDBFunctions(m_pdb, m_settings.pdbHeaderReconstructorSettings.output.get());
+	}
+
+	m_headerReconstructor->OnFinish();
+}
+
+void PDBExtractor::DumpSelectedSymbols()
+{
+	//
+	// Only the selected types are decoded; sorting them pulls in the
+	// closure of types they contain by value, which is all that has to be
+	// printed for the selection to compile. Types only referenced through
+	// pointers are left out.
+	//
+	std::vector<std::string> globs;
+	std::vector<std::regex> regexes;
+
+	for (const auto& selection : m_settings.typeSelection)
+	{
+		if (IsRegexPattern(selection))
+		{
+			try
+			{
+				regexes.emplace_back(selection.substr(1, selection.size() - 2), std::regex::optimize);
+			}
+			catch (const std::regex_error&)
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+		}
+		else if (IsGlobPattern(selection))
+		{
+			globs.push_back(selection);
+		}
+		else
+		{
+			auto symbol = m_pdb.GetSymbolByName(selection);
+			if (!symbol)
+			{
+				throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+			}
+
+			m_symbolSorter->Visit(*symbol);
+		}
+	}
+
+	if (!globs.empty() || !regexes.empty())
+	{
+		size_t matchedSymbolCount = 0;
+
+		auto matchesSelection = [&globs, &regexes](const std::string& symbolName)
+		{
+			for (const auto& glob : globs)
+			{
+				if (SymbolNameIndex::MatchGlob(glob.c_str(), symbolName.c_str()))
+				{
+					return true;
+				}
+			}
+
+			for (const auto& regex : regexes)
+			{
+				if (std::regex_search(symbolName, regex))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		};
+
+		m_pdb.ForEachTopLevelSymbol(matchesSelection, [&](const SymbolPtr& symbol)
+		{
+			assert(symbol);
+			m_symbolSorter->Visit(*symbol);
+			++matchedSymbolCount;
+		});
+
+		if (matchedSymbolCount == 0)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+	}
+
+	if (!m_settings.outputDirectory.empty())
+	{
+		PrintPDBDefinitionsSplit();
+		return;
+	}
+
+	PrintPDBDefinitions();
+	m_headerReconstructor->OnFinish();
+}
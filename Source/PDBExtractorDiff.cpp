@@ -0,0 +1,304 @@
+#include "PDBExtractorCommon.h"
+#include "PDBJsonReconstructor.h"
+#include "SymbolTypeDiff.h"
+
+#include <algorithm>
+#include <charconv>
+
+void PDBExtractor::DiffPDBs()
+{
+	PDB newPdb;
+	if (!newPdb.Open(m_settings.diffPdbPath, PDB::LoadMode::Full))
+	{
+		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+	}
+
+	SymbolTypeMap oldTypes;
+	SymbolTypeMap newTypes;
+
+	SymbolTypeDiff::CollectTypes(m_pdb.GetSymbolMap(), oldTypes);
+	SymbolTypeDiff::CollectTypes(newPdb.GetSymbolMap(), newTypes);
+
+	std::vector<const Symbol*> addedTypes;
+	std::vector<const Symbol*> removedTypes;
+	std::vector<std::pair<const Symbol*, const Symbol*>> commonTypes;
+
+	for (const auto&[name, oldUdt] : oldTypes)
+	{
+		auto it = newTypes.find(name);
+		if (it == newTypes.end())
+		{
+			removedTypes.push_back(oldUdt);
+		}
+		else
+		{
+			commonTypes.emplace_back(oldUdt, it->second);
+		}
+	}
+
+	for (const auto&[name, newUdt] : newTypes)
+	{
+		if (oldTypes.find(name) == oldTypes.end())
+		{
+			addedTypes.push_back(newUdt);
+		}
+	}
+
+	//
+	// Most types of two builds are unchanged and are dismissed by their
+	// structural hashes; only the rest are compared member by member.
+	//
+	std::vector<SymbolTypeChange> changes(commonTypes.size());
+	std::vector<char> isChanged(commonTypes.size());
+
+	{
+		ThreadPool pool(GetThreadCount());
+
+		const size_t chunkSize = (commonTypes.size() + pool.GetThreadCount() * 4 - 1) / (pool.GetThreadCount() * 4);
+
+		for (size_t begin = 0; begin < commonTypes.size(); begin += chunkSize)
+		{
+			const size_t end = (std::min)(begin + chunkSize, commonTypes.size());
+
+			pool.Submit([&commonTypes, &changes, &isChanged, begin, end]()
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					const auto&[oldUdt, newUdt] = commonTypes[i];
+
+					if (SymbolTypeDiff::GetStructuralHash(*oldUdt) != SymbolTypeDiff::GetStructuralHash(*newUdt))
+					{
+						isChanged[i] = SymbolTypeDiff::Compare(*oldUdt, *newUdt, changes[i]);
+					}
+				}
+			});
+		}
+
+		pool.Wait();
+	}
+
+	std::vector<const SymbolTypeChange*> changedTypes;
+	for (size_t i = 0; i < changes.size(); ++i)
+	{
+		if (isChanged[i])
+		{
+			changedTypes.push_back(&changes[i]);
+		}
+	}
+
+	auto byName = [](const Symbol* lhs, const Symbol* rhs)
+	{
+		return lhs->name < rhs->name;
+	};
+
+	std::sort(addedTypes.begin(), addedTypes.end(), byName);
+	std::sort(removedTypes.begin(), removedTypes.end(), byName);
+	std::sort(changedTypes.begin(), changedTypes.end(), [](const SymbolTypeChange* lhs, const SymbolTypeChange* rhs)
+	{
+		return lhs->newUdt->name < rhs->newUdt->name;
+	});
+
+	const size_t unchangedTypeCount = commonTypes.size() - changedTypes.size();
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+	std::string buffer;
+
+	if (m_settings.outputFormat == OutputFormat::Json)
+	{
+		auto appendField = [&buffer](const char* key, const SymbolTypeDiffField& field)
+		{
+			buffer += ",\"";
+			buffer += key;
+			buffer += "\":{\"offset\":";
+			PDBJsonReconstructor::AppendUnsignedNumber(buffer, field.offset);
+			buffer += ",\"size\":";
+			PDBJsonReconstructor::AppendUnsignedNumber(buffer, field.size);
+			buffer += ",\"type\":";
+			PDBJsonReconstructor::AppendString(buffer, field.typeName);
+
+			if (field.bits != 0)
+			{
+				buffer += ",\"bits\":";
+				PDBJsonReconstructor::AppendUnsignedNumber(buffer, field.bits);
+				buffer += ",\"bitPosition\":";
+				PDBJsonReconstructor::AppendUnsignedNumber(buffer, field.bitPosition);
+			}
+
+			buffer += '}';
+		};
+
+		auto appendType = [&buffer](const char* change, const Symbol& udt)
+		{
+			buffer += "{\"change\":\"";
+			buffer += change;
+			buffer += "\",\"name\":";
+			PDBJsonReconstructor::AppendString(buffer, udt.name);
+			buffer += ",\"size\":";
+			PDBJsonReconstructor::AppendUnsignedNumber(buffer, udt.size);
+			buffer += "}\n";
+		};
+
+		for (const auto* udt : removedTypes)
+		{
+			appendType("removed", *udt);
+		}
+
+		for (const auto* udt : addedTypes)
+		{
+			appendType("added", *udt);
+		}
+
+		for (const auto* change : changedTypes)
+		{
+			buffer += "{\"change\":\"changed\",\"name\":";
+			PDBJsonReconstructor::AppendString(buffer, change->newUdt->name);
+			buffer += ",\"oldKind\":";
+			PDBJsonReconstructor::AppendString(buffer, PDB::GetUdtKindString(std::get<SymbolUdt>(change->oldUdt->variant).kind));
+			buffer += ",\"newKind\":";
+			PDBJsonReconstructor::AppendString(buffer, PDB::GetUdtKindString(std::get<SymbolUdt>(change->newUdt->variant).kind));
+			buffer += ",\"oldSize\":";
+			PDBJsonReconstructor::AppendUnsignedNumber(buffer, change->oldUdt->size);
+			buffer += ",\"newSize\":";
+			PDBJsonReconstructor::AppendUnsignedNumber(buffer, change->newUdt->size);
+			buffer += ",\"fields\":[";
+
+			for (size_t i = 0; i < change->fields.size(); ++i)
+			{
+				const auto& fieldChange = change->fields[i];
+				const bool isAdded = fieldChange.kind == SymbolFieldChangeKind::Added;
+				const bool isRemoved = fieldChange.kind == SymbolFieldChangeKind::Removed;
+
+				buffer += i != 0 ? ",{\"change\":\"" : "{\"change\":\"";
+				buffer += isAdded ? "added" : isRemoved ? "removed" : "changed";
+				buffer += "\",\"path\":";
+				PDBJsonReconstructor::AppendString(buffer, isAdded ? fieldChange.newField.path : fieldChange.oldField.path);
+
+				if (!isAdded)
+				{
+					appendField("old", fieldChange.oldField);
+				}
+
+				if (!isRemoved)
+				{
+					appendField("new", fieldChange.newField);
+				}
+
+				buffer += '}';
+			}
+
+			buffer += "]}\n";
+
+			output << buffer;
+			buffer.clear();
+		}
+
+		buffer += "{\"summary\":{\"changed\":";
+		PDBJsonReconstructor::AppendUnsignedNumber(buffer, changedTypes.size());
+		buffer += ",\"added\":";
+		PDBJsonReconstructor::AppendUnsignedNumber(buffer, addedTypes.size());
+		buffer += ",\"removed\":";
+		PDBJsonReconstructor::AppendUnsignedNumber(buffer, removedTypes.size());
+		buffer += ",\"unchanged\":";
+		PDBJsonReconstructor::AppendUnsignedNumber(buffer, unchangedTypeCount);
+		buffer += "}}\n";
+
+		output << buffer;
+		output.flush();
+		return;
+	}
+
+	auto hex = [](DWORD value)
+	{
+		char text[16];
+		const auto result = std::to_chars(text, text + sizeof(text), value, 16);
+		return "0x" + std::string(text, result.ptr);
+	};
+
+	auto bitField = [](const SymbolTypeDiffField& field)
+	{
+		return std::to_string(field.bits) + '@' + std::to_string(field.bitPosition);
+	};
+
+	for (const auto* udt : removedTypes)
+	{
+		output << "removed " << udt->name << " size " << hex(udt->size) << '\n';
+	}
+
+	for (const auto* udt : addedTypes)
+	{
+		output << "added " << udt->name << " size " << hex(udt->size) << '\n';
+	}
+
+	for (const auto* change : changedTypes)
+	{
+		const auto oldKind = std::get<SymbolUdt>(change->oldUdt->variant).kind;
+		const auto newKind = std::get<SymbolUdt>(change->newUdt->variant).kind;
+
+		buffer.clear();
+		buffer += "changed " + change->newUdt->name;
+
+		if (change->oldUdt->size != change->newUdt->size)
+		{
+			buffer += " size " + hex(change->oldUdt->size) + " -> " + hex(change->newUdt->size);
+		}
+
+		if (oldKind != newKind)
+		{
+			buffer += " kind " + PDB::GetUdtKindString(oldKind) + " -> " + PDB::GetUdtKindString(newKind);
+		}
+
+		buffer += '\n';
+
+		for (const auto& fieldChange : change->fields)
+		{
+			const auto& oldField = fieldChange.oldField;
+			const auto& newField = fieldChange.newField;
+
+			switch (fieldChange.kind)
+			{
+			case SymbolFieldChangeKind::Added:
+				buffer += "    added " + newField.path + ' ' + hex(newField.offset) + " size " + std::to_string(newField.size);
+				buffer += newField.bits != 0 ? " bits " + bitField(newField) : std::string();
+				buffer += ' ' + newField.typeName + '\n';
+				break;
+
+			case SymbolFieldChangeKind::Removed:
+				buffer += "    removed " + oldField.path + ' ' + hex(oldField.offset) + " size " + std::to_string(oldField.size);
+				buffer += oldField.bits != 0 ? " bits " + bitField(oldField) : std::string();
+				buffer += ' ' + oldField.typeName + '\n';
+				break;
+
+			case SymbolFieldChangeKind::Changed:
+				buffer += "    changed " + newField.path;
+
+				if (fieldChange.flags & SymbolFieldChangeOffset)
+				{
+					buffer += " offset " + hex(oldField.offset) + " -> " + hex(newField.offset);
+				}
+
+				if (fieldChange.flags & SymbolFieldChangeSize)
+				{
+					buffer += " size " + std::to_string(oldField.size) + " -> " + std::to_string(newField.size);
+				}
+
+				if (fieldChange.flags & SymbolFieldChangeBitField)
+				{
+					buffer += " bits " + bitField(oldField) + " -> " + bitField(newField);
+				}
+
+				if (fieldChange.flags & SymbolFieldChangeType)
+				{
+					buffer += " type " + oldField.typeName + " -> " + newField.typeName;
+				}
+
+				buffer += '\n';
+				break;
+			}
+		}
+
+		output << buffer;
+	}
+
+	output << changedTypes.size() << " types changed, " << addedTypes.size() << " added, " << removedTypes.size() << " removed, " << unchangedTypeCount << " unchanged\n";
+	output.flush();
+}
@@ -0,0 +1,257 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolDumpDecoder.h"
+#include "SymbolDumpWalker.h"
+
+#include <chrono>
+#include <iostream>
+#include <fstream>
+
+namespace
+{
+	// Instances decoded per round out of a dump, and per subtask within a
+	// round.
+	static const size_t DumpDecodeWindow = 1 << 20;
+	static const size_t DumpDecodeChunkSize = 4096;
+
+	// Lists walked per round out of a dump, and walked in lockstep per
+	// subtask within a round.
+	static const size_t DumpWalkWindow = 1 << 14;
+	static const size_t DumpWalkGroupSize = 64;
+}
+
+void PDBExtractor::DecodeDump()
+{
+	SymbolDumpImage image;
+	if (!image.Open(m_settings.dumpFilename, m_settings.dumpBaseAddress))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_DUMP);
+	}
+
+	const auto udt = m_pdb.GetSymbolByName(m_settings.dumpTypeName);
+	if (!udt || udt->tag != SymTagUDT || udt->size == 0)
+	{
+		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+	}
+
+	const bool isJson = m_settings.outputFormat == OutputFormat::Json;
+	const SymbolDumpDecoder decoder(*udt, isJson ? SymbolDumpFormat::Json : SymbolDumpFormat::Text, m_settings.dumpFieldPaths);
+
+	//
+	// Walking lists, the listed addresses are list heads, and a count
+	// stands for consecutive heads (a table of buckets).
+	//
+	const bool isWalk = !m_settings.dumpNextFieldPath.empty();
+	std::unique_ptr<SymbolDumpWalker> walker;
+	uint64_t stride = decoder.GetSize();
+
+	if (isWalk)
+	{
+		DWORD headSize;
+		walker = CreateDumpWalker(image, *udt, headSize);
+		stride = headSize;
+	}
+
+	const size_t window = isWalk ? DumpWalkWindow : DumpDecodeWindow;
+	const size_t chunkSize = isWalk ? DumpWalkGroupSize : DumpDecodeChunkSize;
+
+	std::ifstream addressFile;
+	if (m_settings.dumpAddressFilename != "-")
+	{
+		addressFile.open(m_settings.dumpAddressFilename);
+		if (!addressFile)
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+	}
+
+	std::istream& input = m_settings.dumpAddressFilename == "-" ? std::cin : addressFile;
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+
+	//
+	// Lines are "<hex address>[ <count>]"; a count decodes that many
+	// instances back to back, like the elements of an array. Instances are
+	// decoded a window at a time, the window split into chunks over the
+	// pool, and the chunks written in order.
+	//
+	ThreadPool pool(GetThreadCount());
+
+	std::vector<uint64_t> addresses;
+	std::vector<std::string> chunkOutputs;
+	std::vector<size_t> chunkNodeCounts;
+	uint64_t pendingAddress = 0;
+	uint64_t pendingCount = 0;
+	std::string line;
+
+	size_t listCount = 0;
+	size_t nodeCount = 0;
+	const auto walkStart = std::chrono::steady_clock::now();
+
+	for (;;)
+	{
+		addresses.clear();
+
+		while (addresses.size() < window)
+		{
+			if (pendingCount != 0)
+			{
+				addresses.push_back(pendingAddress);
+				pendingAddress += stride;
+				--pendingCount;
+				continue;
+			}
+
+			if (!std::getline(input, line))
+			{
+				break;
+			}
+
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty())
+			{
+				continue;
+			}
+
+			char* end = nullptr;
+			pendingAddress = strtoull(line.c_str(), &end, 16);
+			pendingCount = 1;
+
+			if (*end == ' ')
+			{
+				pendingCount = strtoull(end + 1, &end, 10);
+			}
+
+			if (*end != '\0')
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+		}
+
+		if (addresses.empty())
+		{
+			break;
+		}
+
+		const size_t chunkCount = (addresses.size() + chunkSize - 1) / chunkSize;
+		chunkOutputs.resize((std::max)(chunkOutputs.size(), chunkCount));
+		chunkNodeCounts.assign(chunkCount, 0);
+
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			pool.Submit([&image, &decoder, &walker, &addresses, &chunkOutputs, &chunkNodeCounts, chunkSize, isJson, chunk]()
+			{
+				const size_t begin = chunk * chunkSize;
+				const size_t count = (std::min)(chunkSize, addresses.size() - begin);
+
+				// Cleared rather than replaced, keeping the capacity of
+				// earlier windows.
+				auto& chunkOutput = chunkOutputs[chunk];
+				chunkOutput.clear();
+
+				if (!walker)
+				{
+					decoder.Decode(image, addresses.data() + begin, count, chunkOutput);
+					return;
+				}
+
+				// Each list is written as its nodes followed by how it ended.
+				std::vector<SymbolDumpWalkResult> results;
+				walker->Walk(addresses.data() + begin, count, results);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					const auto& nodes = results[i].nodes;
+
+					decoder.Decode(image, nodes.data(), nodes.size(), chunkOutput);
+					SymbolDumpWalker::AppendResult(addresses[begin + i], results[i], isJson, chunkOutput);
+
+					chunkNodeCounts[chunk] += nodes.size();
+				}
+			});
+		}
+
+		pool.Wait();
+
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			output << chunkOutputs[chunk];
+			nodeCount += chunkNodeCounts[chunk];
+		}
+
+		listCount += addresses.size();
+	}
+
+	output.flush();
+
+	if (isWalk)
+	{
+		const auto walkDuration = std::chrono::steady_clock::now() - walkStart;
+		const double seconds = std::chrono::duration<double>(walkDuration).count();
+
+		std::cerr << nodeCount << " nodes in " << listCount << " lists in "
+		          << std::chrono::duration_cast<std::chrono::milliseconds>(walkDuration).count() << " ms, "
+		          << static_cast<uint64_t>(seconds > 0 ? nodeCount / seconds : 0) << " nodes/s" << std::endl;
+	}
+}
+
+std::unique_ptr<SymbolDumpWalker> PDBExtractor::CreateDumpWalker(const SymbolDumpImage& image, const Symbol& udt, DWORD& headSize)
+{
+	SymbolFieldLocation nextField;
+	if (!m_pdb.GetFieldAtPath(udt, m_settings.dumpNextFieldPath, nextField))
+	{
+		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+	}
+
+	if ((nextField.size != 4 && nextField.size != 8) || nextField.bits != 0)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	//
+	// Without a link member the pointer points at the member holding it
+	// ("Links.Flink" points at "Links"); a pointer that is a member of the
+	// node itself points at the start of the next node.
+	//
+	std::string linkPath = m_settings.dumpLinkFieldPath;
+	if (linkPath.empty())
+	{
+		const size_t separator = m_settings.dumpNextFieldPath.rfind('.');
+		if (separator != std::string::npos)
+		{
+			linkPath = m_settings.dumpNextFieldPath.substr(0, separator);
+		}
+	}
+
+	if (linkPath.empty())
+	{
+		// Heads are then bare pointers to the first node.
+		headSize = nextField.size;
+		return std::make_unique<SymbolDumpWalker>(image, nextField.offset, 0, 0, udt.size, nextField.size);
+	}
+
+	SymbolFieldLocation linkField;
+	if (!m_pdb.GetFieldAtPath(udt, linkPath, linkField))
+	{
+		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+	}
+
+	// The pointer is followed from the heads as from the nodes, so it has
+	// to be part of the link.
+	if (nextField.offset < linkField.offset || nextField.offset + nextField.size > linkField.offset + linkField.size)
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	// Heads are links like those of the nodes.
+	headSize = linkField.size;
+	return std::make_unique<SymbolDumpWalker>(
+		image,
+		nextField.offset,
+		linkField.offset,
+		nextField.offset - linkField.offset,
+		udt.size,
+		nextField.size);
+}
@@ -0,0 +1,105 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolTypeMerger.h"
+
+#include <iostream>
+#include <future>
+#include <thread>
+
+void PDBExtractor::MergePDBs()
+{
+	//
+	// A DIA session belongs to the thread that opened it, so every
+	// additional PDB is opened, and later closed, on a thread of its own
+	// while this one opens pdbPath. The PDBs stay open until the merged
+	// types are written.
+	//
+	struct MergeSource
+	{
+		PDB* pdb = nullptr;
+		std::promise<bool> opened;
+	};
+
+	const auto& pdbPaths = m_settings.additionalPdbPaths;
+
+	std::vector<MergeSource> sources(pdbPaths.size());
+	std::vector<std::thread> loaders;
+	std::promise<void> merged;
+	const auto mergedFuture = merged.get_future().share();
+
+	auto releaseSources = [&]()
+	{
+		merged.set_value();
+
+		for (auto& loader : loaders)
+		{
+			loader.join();
+		}
+	};
+
+	try
+	{
+		for (size_t i = 0; i < pdbPaths.size(); ++i)
+		{
+			loaders.emplace_back([&source = sources[i], &pdbPath = pdbPaths[i], mergedFuture]()
+			{
+				PDB pdb;
+				source.pdb = &pdb;
+				source.opened.set_value(pdb.Open(pdbPath));
+
+				mergedFuture.wait();
+			});
+		}
+
+		OpenPDBFile();
+
+		SymbolTypeMerger merger;
+		merger.Add(m_pdb, m_settings.pdbPath.stem().string());
+
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			if (!sources[i].opened.get_future().get())
+			{
+				throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+			}
+
+			merger.Add(*sources[i].pdb, pdbPaths[i].stem().string());
+		}
+
+		merger.ForEachSymbol([this](const Symbol& symbol)
+		{
+			m_symbolSorter->Visit(symbol);
+		});
+
+		for (const auto& symIndex : m_symbolSorter->GetSortedSymbolIndexes())
+		{
+			auto symbol = merger.GetSymbolBySymbolIndex(symIndex);
+			assert(symbol);
+
+			if (ShouldPrintSymbol(*symbol))
+			{
+				m_symbolVisitor->Visit(*symbol);
+			}
+		}
+
+		m_headerReconstructor->OnFinish();
+
+		// The output is the merged header; the report goes next to it.
+		for (const auto& conflict : merger.GetConflicts())
+		{
+			std::cerr << "conflict " << conflict.name
+			          << " in " << conflict.sourceName
+			          << " emitted as " << conflict.mergedName << std::endl;
+		}
+
+		std::cerr << merger.GetTypeCount() << " types from " << sources.size() + 1 << " PDBs, "
+		          << merger.GetDuplicateCount() << " duplicates merged, "
+		          << merger.GetConflicts().size() << " conflicts renamed" << std::endl;
+	}
+	catch (...)
+	{
+		releaseSources();
+		throw;
+	}
+
+	releaseSources();
+}
@@ -0,0 +1,52 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolOffsetHistory.h"
+
+#include <charconv>
+
+void PDBExtractor::LookupOffsetHistory()
+{
+	SymbolOffsetHistoryReader history;
+	if (!history.Open(m_settings.pdbPath))
+	{
+		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+	}
+
+	GUID guid;
+	DWORD age;
+	if (!PDB::ParseSignatureString(m_settings.offsetHistoryBuild, guid, age))
+	{
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	const uint32_t buildIndex = history.FindBuild(guid, age);
+	if (buildIndex == SymbolOffsetHistoryInvalidIndex)
+	{
+		throw PDBDumperException(MESSAGE_BUILD_NOT_FOUND);
+	}
+
+	uint32_t entryCount;
+	const auto* entries = history.GetEntries(buildIndex, entryCount);
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+	std::string buffer;
+	char text[16];
+
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		const auto* path = history.GetPath(entries[i].path);
+		if (!path)
+		{
+			continue;
+		}
+
+		buffer += history.GetString(path->nameOffset);
+		buffer += " 0x";
+		buffer.append(text, std::to_chars(text, text + sizeof(text), entries[i].offset, 16).ptr);
+		buffer += ' ';
+		buffer.append(text, std::to_chars(text, text + sizeof(text), entries[i].size).ptr);
+		buffer += '\n';
+	}
+
+	output << buffer;
+	output.flush();
+}
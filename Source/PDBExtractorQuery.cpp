@@ -0,0 +1,212 @@
+#include "PDBExtractorCommon.h"
+#include "PDBQueryServer.h"
+
+#include <iostream>
+#include <fstream>
+#include <future>
+
+namespace
+{
+	// Queries read and answered per round in batch mode; bounds memory
+	// while keeping the pool busy.
+	static const size_t QueryBatchWindow = 4096;
+
+	static const char* InteractivePrompt = "pdbex> ";
+	static const char* InteractiveHelp =
+		"show <type>               declaration of the type and what it contains\n"
+		"sizeof <type>             size in bytes\n"
+		"offsetof <Type.a.b[2]>    offset and size of a member\n"
+		"at <Type>+<offset>        members covering an offset\n"
+		"find <text>|<glob>        type and function names, case-insensitively\n"
+		"fuzzy <name> [distance]   names within an edit distance\n"
+		"xrefs <type> [kinds]      members referring to the type\n"
+		"dependents <type> [kinds] types reaching the type\n"
+		"enum <type> [<value>]     enumerators, or those matching a value\n"
+		"sym <rva>                 public symbol covering a hex RVA\n"
+		"quit                      leaves the shell\n";
+}
+
+void PDBExtractor::RunQueryServer()
+{
+	std::vector<std::unique_ptr<PDB>> additionalPdbs;
+	std::vector<std::unique_ptr<PDBQueryEngine>> engines;
+
+	PDBQueryServer server(GetThreadCount());
+
+	engines.push_back(std::make_unique<PDBQueryEngine>(m_pdb, m_settings.pdbHeaderReconstructorSettings));
+	server.AddEngine(m_settings.pdbPath.stem().string(), *engines.back());
+
+	for (const auto& pdbPath : m_settings.additionalPdbPaths)
+	{
+		auto pdb = std::make_unique<PDB>();
+		if (!pdb->Open(pdbPath))
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+
+		engines.push_back(std::make_unique<PDBQueryEngine>(*pdb, m_settings.pdbHeaderReconstructorSettings));
+		server.AddEngine(pdbPath.stem().string(), *engines.back());
+
+		additionalPdbs.push_back(std::move(pdb));
+	}
+
+	std::cout << "Serving " << engines.size() << " PDB(s) on " << m_settings.serverSocketPath.string() << std::endl;
+
+	if (!server.Run(m_settings.serverSocketPath))
+	{
+		throw PDBDumperException(MESSAGE_CANNOT_LISTEN);
+	}
+}
+
+void PDBExtractor::RunQueryBatch()
+{
+	std::ifstream queryFile;
+	if (m_settings.queryFilename != "-")
+	{
+		queryFile.open(m_settings.queryFilename);
+		if (!queryFile)
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+	}
+
+	std::istream& input = m_settings.queryFilename == "-" ? std::cin : queryFile;
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+
+	//
+	// Queries of a window run in parallel; responses are written in input
+	// order as soon as the query at the head of the window has finished.
+	// Responses use the same framing as the query server.
+	//
+	const PDBQueryEngine engine(m_pdb, m_settings.pdbHeaderReconstructorSettings);
+	std::vector<std::string> queries;
+	std::vector<std::promise<std::string>> responses;
+
+	// Declared last so pending tasks finish before what they point to goes away.
+	ThreadPool pool(GetThreadCount());
+
+	for (;;)
+	{
+		queries.clear();
+
+		std::string query;
+		while (queries.size() < QueryBatchWindow && std::getline(input, query))
+		{
+			if (!query.empty() && query.back() == '\r')
+			{
+				query.pop_back();
+			}
+
+			if (!query.empty())
+			{
+				queries.push_back(std::move(query));
+			}
+		}
+
+		if (queries.empty())
+		{
+			break;
+		}
+
+		responses = std::vector<std::promise<std::string>>(queries.size());
+
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			pool.Submit([&engine, query = &queries[i], response = &responses[i]]()
+			{
+				try
+				{
+					std::string result;
+					std::string framedResult;
+
+					PDBQueryEngine::FormatResponse(engine.Execute(*query, result), result, framedResult);
+					response->set_value(std::move(framedResult));
+				}
+				catch (...)
+				{
+					response->set_exception(std::current_exception());
+				}
+			});
+		}
+
+		for (auto& response : responses)
+		{
+			output << response.get_future().get();
+		}
+
+		pool.Wait();
+	}
+
+	output.flush();
+}
+
+void PDBExtractor::RunQuery()
+{
+	const PDBQueryEngine engine(m_pdb, m_settings.pdbHeaderReconstructorSettings);
+
+	std::string output;
+	if (!engine.Execute(m_settings.query, output))
+	{
+		throw PDBDumperException(output.c_str());
+	}
+
+	m_settings.pdbHeaderReconstructorSettings.output.get() << output;
+}
+
+void PDBExtractor::RunInteractive()
+{
+	//
+	// The PDB is loaded once for the whole session. Indexes behind the
+	// commands are built on first use, so only the first command of each
+	// kind waits for one.
+	//
+	const PDBQueryEngine engine(m_pdb, m_settings.pdbHeaderReconstructorSettings);
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+
+	std::string command;
+	std::string result;
+
+	for (;;)
+	{
+		std::cout << InteractivePrompt << std::flush;
+
+		if (!std::getline(std::cin, command))
+		{
+			std::cout << std::endl;
+			break;
+		}
+
+		if (!command.empty() && command.back() == '\r')
+		{
+			command.pop_back();
+		}
+
+		const auto commandBegin = command.find_first_not_of(" \t");
+		if (commandBegin == std::string::npos)
+		{
+			continue;
+		}
+
+		command.erase(0, commandBegin);
+
+		if (command == "quit" || command == "exit")
+		{
+			break;
+		}
+
+		if (command == "help")
+		{
+			std::cout << InteractiveHelp;
+			continue;
+		}
+
+		if (engine.Execute(command, result))
+		{
+			output << result << std::flush;
+		}
+		else
+		{
+			std::cerr << result << std::endl;
+		}
+	}
+}
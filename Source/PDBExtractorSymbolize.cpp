@@ -0,0 +1,151 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolAddressIndex.h"
+
+#include <charconv>
+#include <iostream>
+#include <fstream>
+
+namespace
+{
+	// Addresses symbolized per batch lookup.
+	static const size_t AddressBatchWindow = 1 << 20;
+}
+
+void PDBExtractor::SymbolizeAddresses()
+{
+	std::ifstream addressFile;
+	if (m_settings.addressFilename != "-")
+	{
+		addressFile.open(m_settings.addressFilename);
+		if (!addressFile)
+		{
+			throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
+		}
+	}
+
+	std::istream& input = m_settings.addressFilename == "-" ? std::cin : addressFile;
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+
+	if (m_settings.resolveLines && !m_pdb.LoadLineTable(m_settings.lineCacheFilename, GetThreadCount()))
+	{
+		throw PDBDumperException(MESSAGE_NO_LINE_INFORMATION);
+	}
+
+	//
+	// Addresses are symbolized a window at a time, each window in one
+	// batch lookup and one write. Lines that are not RVAs are echoed with
+	// "?" like addresses no symbol covers.
+	//
+	std::vector<std::string> inputLines;
+	std::vector<DWORD> rvas;
+	std::vector<SymbolAddress> addresses;
+	std::vector<SymbolLine> lines;
+	std::vector<SymbolFrame> frames;
+	std::vector<uint32_t> frameOffsets;
+	std::string buffer;
+
+	for (;;)
+	{
+		inputLines.clear();
+		rvas.clear();
+
+		std::string line;
+		while (inputLines.size() < AddressBatchWindow && std::getline(input, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty())
+			{
+				continue;
+			}
+
+			char* end = nullptr;
+			const auto rva = strtoull(line.c_str(), &end, 16);
+
+			rvas.push_back(*end == '\0' && rva <= MAXDWORD ? static_cast<DWORD>(rva) : 0);
+			inputLines.push_back(std::move(line));
+		}
+
+		if (inputLines.empty())
+		{
+			break;
+		}
+
+		m_pdb.SymbolizeAddresses(rvas, addresses);
+
+		if (m_settings.resolveLines)
+		{
+			m_pdb.ResolveLines(rvas, lines);
+		}
+
+		if (m_settings.inlineFrames)
+		{
+			m_pdb.GetInlineFrames(rvas, frames, frameOffsets);
+		}
+
+		buffer.clear();
+
+		for (size_t i = 0; i < inputLines.size(); ++i)
+		{
+			buffer += inputLines[i];
+			buffer += ' ';
+
+			if (addresses[i].name.empty())
+			{
+				buffer += '?';
+			}
+			else
+			{
+				buffer += addresses[i].name;
+
+				if (addresses[i].displacement != 0)
+				{
+					char displacement[16];
+					const auto result = std::to_chars(displacement, displacement + sizeof(displacement), addresses[i].displacement, 16);
+
+					buffer += "+0x";
+					buffer.append(displacement, result.ptr);
+				}
+			}
+
+			if (m_settings.resolveLines && !lines[i].file.empty())
+			{
+				buffer += ' ';
+				buffer += lines[i].file;
+				buffer += ':';
+				buffer += std::to_string(lines[i].line);
+			}
+
+			//
+			// Inline frames go outermost first; the last frame is the
+			// procedure itself, already printed above.
+			//
+			if (m_settings.inlineFrames && frameOffsets[i + 1] - frameOffsets[i] > 1)
+			{
+				for (uint32_t frame = frameOffsets[i + 1] - 1; frame-- > frameOffsets[i];)
+				{
+					buffer += " @ ";
+					buffer += frames[frame].name;
+				}
+
+				const auto& innermost = frames[frameOffsets[i]];
+				if (!innermost.file.empty())
+				{
+					buffer += ' ';
+					buffer += innermost.file;
+					buffer += ':';
+					buffer += std::to_string(innermost.line);
+				}
+			}
+
+			buffer += '\n';
+		}
+
+		output << buffer;
+	}
+
+	output.flush();
+}
@@ -0,0 +1,26 @@
+#include "PDBExtractorCommon.h"
+#include "SymbolTypeStore.h"
+
+void PDBExtractor::IngestIntoTypeStore()
+{
+	SymbolTypeStore store;
+	SymbolTypeStoreIngestResult result;
+
+	if (!store.Open(m_settings.typeStoreDirectory) || !store.Ingest(m_pdb, result))
+	{
+		throw PDBDumperException(MESSAGE_TYPE_STORE_FAILED);
+	}
+
+	auto& output = m_settings.pdbHeaderReconstructorSettings.output.get();
+
+	if (result.isKnownPdb)
+	{
+		output << m_settings.pdbPath.string() << " already in store" << std::endl;
+		return;
+	}
+
+	output << m_settings.pdbPath.string()
+	       << " types " << result.typeCount
+	       << " new " << result.newTypeCount
+	       << " bytes " << result.bytesWritten << std::endl;
+}
@@ -6,39 +6,86 @@
 #include <set>
 #include <stack>
 
-class PDBHeaderReconstructor : public PDBReconstructorBase
+enum class PDBMemberStructExpansionType
+{
+    None,
+    InlineUnnamed,
+    InlineAll,
+};
+
+struct PDBHeaderReconstructorSettings
+{
+    PDBMemberStructExpansionType memberStructExpansion = PDBMemberStructExpansionType::InlineUnnamed;
+    std::unique_ptr<std::ostream> outputFile;
+    std::reference_wrapper<std::ostream> output = std::cout;
+    std::string paddingMemberPrefix = "Padding_";
+    std::string bitFieldPaddingMemberPrefix;
+    std::string unnamedTypePrefix;
+    std::string symbolPrefix;
+    std::string symbolSuffix;
+    std::string anonymousStructPrefix = "s";
+    std::string anonymousUnionPrefix = "u";
+    bool createPaddingMembers = true;
+    bool showOffsets = true;
+    bool allowBitFieldsInUnion = false;
+    bool allowAnonymousDataTypes = true;
+};
+
+// Copies everything but the output, which cannot be shared.
+inline void CopyRenderSettings(const PDBHeaderReconstructorSettings& from, PDBHeaderReconstructorSettings& to)
+{
+    to.memberStructExpansion = from.memberStructExpansion;
+    to.paddingMemberPrefix = from.paddingMemberPrefix;
+    to.bitFieldPaddingMemberPrefix = from.bitFieldPaddingMemberPrefix;
+    to.unnamedTypePrefix = from.unnamedTypePrefix;
+    to.symbolPrefix = from.symbolPrefix;
+    to.symbolSuffix = from.symbolSuffix;
+    to.anonymousStructPrefix = from.anonymousStructPrefix;
+    to.anonymousUnionPrefix = from.anonymousUnionPrefix;
+    to.createPaddingMembers = from.createPaddingMembers;
+    to.showOffsets = from.showOffsets;
+    to.allowBitFieldsInUnion = from.allowBitFieldsInUnion;
+    to.allowAnonymousDataTypes = from.allowAnonymousDataTypes;
+}
+
+//
+// Settings policies tell the reconstructor where the flags checked for
+// every field come from: the runtime policy reads them from the settings,
+// the static one bakes them in so the checks fold away at compile time.
+//
+struct PDBRuntimeSettingsPolicy
+{
+    static bool ShowOffsets(const PDBHeaderReconstructorSettings& settings) { return settings.showOffsets; }
+    static bool CreatePaddingMembers(const PDBHeaderReconstructorSettings& settings) { return settings.createPaddingMembers; }
+    static bool AllowBitFieldsInUnion(const PDBHeaderReconstructorSettings& settings) { return settings.allowBitFieldsInUnion; }
+    static bool AllowAnonymousDataTypes(const PDBHeaderReconstructorSettings& settings) { return settings.allowAnonymousDataTypes; }
+};
+
+template <bool SHOW_OFFSETS, bool CREATE_PADDING_MEMBERS, bool ALLOW_BITFIELDS_IN_UNION, bool ALLOW_ANONYMOUS_DATA_TYPES>
+struct PDBStaticSettingsPolicy
+{
+    static constexpr bool ShowOffsets(const PDBHeaderReconstructorSettings&) { return SHOW_OFFSETS; }
+    static constexpr bool CreatePaddingMembers(const PDBHeaderReconstructorSettings&) { return CREATE_PADDING_MEMBERS; }
+    static constexpr bool AllowBitFieldsInUnion(const PDBHeaderReconstructorSettings&) { return ALLOW_BITFIELDS_IN_UNION; }
+    static constexpr bool AllowAnonymousDataTypes(const PDBHeaderReconstructorSettings&) { return ALLOW_ANONYMOUS_DATA_TYPES; }
+};
+
+template <typename SETTINGS_POLICY>
+class PDBHeaderReconstructorT : public PDBReconstructorBase
 {
 public:
-    enum class MemberStructExpansionType
-    {
-        None,
-        InlineUnnamed,
-        InlineAll,
-    };
-
-    struct Settings
-    {
-        MemberStructExpansionType memberStructExpansion = MemberStructExpansionType::InlineUnnamed;
-        std::unique_ptr<std::ostream> outputFile;
-        std::reference_wrapper<std::ostream> output = std::cout;
-        std::string paddingMemberPrefix = "Padding_";
-        std::string bitFieldPaddingMemberPrefix;
-        std::string unnamedTypePrefix;
-        std::string symbolPrefix;
-        std::string symbolSuffix;
-        std::string anonymousStructPrefix = "s";
-        std::string anonymousUnionPrefix = "u";
-        bool createPaddingMembers = true;
-        bool showOffsets = true;
-        bool allowBitFieldsInUnion = false;
-        bool allowAnonymousDataTypes = true;
-    };
-
-    PDBHeaderReconstructor(Settings& visitorSettings);
+    using MemberStructExpansionType = PDBMemberStructExpansionType;
+    using Settings = PDBHeaderReconstructorSettings;
+
+    PDBHeaderReconstructorT(Settings& visitorSettings);
     void Clear();
     const std::string& GetCorrectedSymbolName(const Symbol& symbol) const;
 
 protected:
+    // The visitor calls the hooks directly when it knows the concrete reconstructor type.
+    template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+    friend class PDBSymbolVisitor;
+
     bool OnEnumType(const Symbol& symbol) override;
     void OnEnumTypeBegin(const Symbol& symbol) override;
     void OnEnumTypeEnd(const Symbol& symbol) override;
@@ -86,3 +133,17 @@ private:
 
     std::set<std::string> m_visitedSymbols;
 };
+
+using PDBHeaderReconstructor = PDBHeaderReconstructorT<PDBRuntimeSettingsPolicy>;
+
+template <bool SHOW_OFFSETS, bool CREATE_PADDING_MEMBERS, bool ALLOW_BITFIELDS_IN_UNION, bool ALLOW_ANONYMOUS_DATA_TYPES>
+class PDBStaticHeaderReconstructor final
+    : public PDBHeaderReconstructorT<PDBStaticSettingsPolicy<SHOW_OFFSETS, CREATE_PADDING_MEMBERS, ALLOW_BITFIELDS_IN_UNION, ALLOW_ANONYMOUS_DATA_TYPES>>
+{
+public:
+    using PDBHeaderReconstructorT<PDBStaticSettingsPolicy<SHOW_OFFSETS, CREATE_PADDING_MEMBERS, ALLOW_BITFIELDS_IN_UNION, ALLOW_ANONYMOUS_DATA_TYPES>>::PDBHeaderReconstructorT;
+};
+
+#include "PDBHeaderReconstructor.inl"
+
+extern template class PDBHeaderReconstructorT<PDBRuntimeSettingsPolicy>;
@@ -0,0 +1,356 @@
+#include "PDBJsonReconstructor.h"
+
+#include <cassert>
+#include <charconv>
+
+namespace
+{
+    const size_t InitialBufferSize = 64 * 1024;
+
+    bool IsExpandedUnnamedUdt(const Symbol& symbol)
+    {
+        return symbol.tag == SymTagUDT && symbol.size > 0 && PDB::IsUnnamedSymbol(symbol);
+    }
+}
+
+PDBJsonReconstructor::PDBJsonReconstructor(std::ostream& output)
+    : m_output(output)
+{
+    m_buffer.reserve(InitialBufferSize);
+}
+
+void PDBJsonReconstructor::AppendString(std::string& buffer, const std::string& text)
+{
+    static const char HexDigits[] = "0123456789abcdef";
+
+    buffer += '"';
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+        case '"':  buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+            if (c < 0x20)
+            {
+                buffer += "\\u00";
+                buffer += HexDigits[c >> 4];
+                buffer += HexDigits[c & 0xf];
+            }
+            else
+            {
+                buffer += static_cast<char>(c);
+            }
+            break;
+        }
+    }
+    buffer += '"';
+}
+
+void PDBJsonReconstructor::AppendNumber(std::string& buffer, int64_t value)
+{
+    char digits[24];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+void PDBJsonReconstructor::AppendUnsignedNumber(std::string& buffer, uint64_t value)
+{
+    char digits[24];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+const char* PDBJsonReconstructor::GetAccessString(DWORD access)
+{
+    switch (access)
+    {
+    case 1: return "private";
+    case 2: return "protected";
+    case 3: return "public";
+    default: return "";
+    }
+}
+
+bool PDBJsonReconstructor::OnEnumType(const Symbol& symbol)
+{
+    return true;
+}
+
+void PDBJsonReconstructor::OnEnumTypeBegin(const Symbol& symbol)
+{
+    m_buffer += "{\"kind\":\"enum\",\"name\":";
+    AppendString(m_buffer, symbol.name);
+    m_buffer += ",\"size\":";
+    AppendUnsignedNumber(m_buffer, symbol.size);
+    m_buffer += ",\"typeIndex\":";
+    AppendUnsignedNumber(m_buffer, symbol.symIndexId);
+    m_buffer += ",\"values\":[";
+
+    m_firstEntry = true;
+}
+
+void PDBJsonReconstructor::OnEnumTypeEnd(const Symbol& symbol)
+{
+    m_buffer += "]}\n";
+    FlushRecord();
+}
+
+void PDBJsonReconstructor::OnEnumField(const SymbolEnumField& enumField)
+{
+    BeginRecordEntry();
+
+    m_buffer += "{\"name\":";
+    AppendString(m_buffer, enumField.name);
+    m_buffer += ",\"value\":";
+    AppendVariant(enumField.value);
+    m_buffer += '}';
+}
+
+bool PDBJsonReconstructor::OnUdt(const Symbol& symbol)
+{
+    // Called for top-level types and for unnamed types nested in them;
+    // both are expanded.
+    return symbol.size > 0;
+}
+
+void PDBJsonReconstructor::OnUdtBegin(const Symbol& symbol)
+{
+    if (m_depth++ != 0)
+    {
+        return;
+    }
+
+    m_buffer += "{\"kind\":";
+    AppendString(m_buffer, PDB::GetUdtKindString(std::get<SymbolUdt>(symbol.variant).kind));
+    m_buffer += ",\"name\":";
+    AppendString(m_buffer, symbol.name);
+    m_buffer += ",\"size\":";
+    AppendUnsignedNumber(m_buffer, symbol.size);
+    m_buffer += ",\"typeIndex\":";
+    AppendUnsignedNumber(m_buffer, symbol.symIndexId);
+
+    AppendBaseClasses(symbol);
+
+    m_buffer += ",\"fields\":[";
+
+    m_firstEntry = true;
+    m_paddingMemberCounter = 0;
+}
+
+void PDBJsonReconstructor::OnUdtEnd(const Symbol& symbol)
+{
+    if (--m_depth != 0)
+    {
+        return;
+    }
+
+    m_buffer += "]}\n";
+    FlushRecord();
+}
+
+void PDBJsonReconstructor::OnUdtFieldBegin(const SymbolUdtField& udtField)
+{
+    FieldContext context;
+    context.offset = GetParentOffset() + udtField.offset;
+    context.path = m_fieldStack.empty() ? udtField.name : m_fieldStack.back().path + '.' + udtField.name;
+
+    m_fieldStack.push_back(std::move(context));
+}
+
+void PDBJsonReconstructor::OnUdtFieldEnd(const SymbolUdtField& udtField)
+{
+    m_fieldStack.pop_back();
+}
+
+void PDBJsonReconstructor::OnUdtField(const SymbolUdtField& udtField, UdtFieldDefinitionBase& memberDefinition)
+{
+    assert(udtField.type);
+    assert(!m_fieldStack.empty());
+
+    // Base classes are listed in "bases", nested type declarations are
+    // not members, and expanded unnamed types were flattened already.
+    if (udtField.isBaseClass ||
+        (udtField.tag != SymTagData && udtField.tag != SymTagFunction) ||
+        (udtField.dataKind != DataIsStaticMember && IsExpandedUnnamedUdt(*udtField.type)))
+    {
+        return;
+    }
+
+    const auto& context = m_fieldStack.back();
+
+    BeginRecordEntry();
+
+    m_buffer += "{\"name\":";
+    AppendString(m_buffer, context.path);
+    m_buffer += ",\"type\":";
+
+    std::string typeName;
+    PDB::AppendTypeName(typeName, udtField.type.get());
+    AppendString(m_buffer, typeName);
+
+    m_buffer += ",\"typeIndex\":";
+    AppendUnsignedNumber(m_buffer, udtField.type->symIndexId);
+
+    if (udtField.access != 0)
+    {
+        m_buffer += ",\"access\":\"";
+        m_buffer += GetAccessString(udtField.access);
+        m_buffer += '"';
+    }
+
+    if (udtField.tag == SymTagFunction)
+    {
+        const auto& symbolFunction = std::get<SymbolFunction>(udtField.type->variant);
+
+        m_buffer += ",\"method\":true";
+
+        if (symbolFunction.isStatic)
+        {
+            m_buffer += ",\"static\":true";
+        }
+
+        if (symbolFunction.isVirtual)
+        {
+            m_buffer += ",\"virtual\":true,\"vtableOffset\":";
+            AppendUnsignedNumber(m_buffer, symbolFunction.virtualOffset);
+        }
+
+        if (symbolFunction.isPure)
+        {
+            m_buffer += ",\"pure\":true";
+        }
+    }
+    else if (udtField.dataKind == DataIsStaticMember)
+    {
+        m_buffer += ",\"static\":true";
+    }
+    else
+    {
+        m_buffer += ",\"offset\":";
+        AppendUnsignedNumber(m_buffer, context.offset);
+        m_buffer += ",\"size\":";
+        AppendUnsignedNumber(m_buffer, udtField.type->size);
+
+        if (udtField.bits != 0)
+        {
+            m_buffer += ",\"bits\":";
+            AppendUnsignedNumber(m_buffer, udtField.bits);
+            m_buffer += ",\"bitPosition\":";
+            AppendUnsignedNumber(m_buffer, udtField.bitPosition);
+        }
+    }
+
+    m_buffer += '}';
+}
+
+void PDBJsonReconstructor::OnPaddingMember(
+    const SymbolUdtField& udtField,
+    BasicType paddingBasicType,
+    DWORD paddingBasicTypeSize,
+    DWORD paddingSize)
+{
+    const DWORD size = paddingSize * paddingBasicTypeSize;
+
+    BeginRecordEntry();
+
+    m_buffer += "{\"name\":\"Padding_";
+    AppendUnsignedNumber(m_buffer, m_paddingMemberCounter++);
+    m_buffer += "\",\"padding\":true,\"offset\":";
+    AppendUnsignedNumber(m_buffer, GetParentOffset() + udtField.offset - size);
+    m_buffer += ",\"size\":";
+    AppendUnsignedNumber(m_buffer, size);
+    m_buffer += '}';
+}
+
+void PDBJsonReconstructor::BeginRecordEntry()
+{
+    if (!m_firstEntry)
+    {
+        m_buffer += ',';
+    }
+    m_firstEntry = false;
+}
+
+void PDBJsonReconstructor::AppendBaseClasses(const Symbol& symbol)
+{
+    const auto& udt = std::get<SymbolUdt>(symbol.variant);
+
+    m_buffer += ",\"bases\":[";
+
+    bool first = true;
+    for (const auto& field : udt.fields)
+    {
+        if (!field.isBaseClass || !field.type)
+        {
+            continue;
+        }
+
+        bool isVirtual = false;
+        for (const auto& baseClass : udt.baseClassFields)
+        {
+            if (baseClass.type == field.type)
+            {
+                isVirtual = baseClass.isVirtual;
+                break;
+            }
+        }
+
+        if (!first)
+        {
+            m_buffer += ',';
+        }
+        first = false;
+
+        m_buffer += "{\"name\":";
+        AppendString(m_buffer, field.type->name);
+        m_buffer += ",\"offset\":";
+        AppendUnsignedNumber(m_buffer, field.offset);
+        m_buffer += ",\"size\":";
+        AppendUnsignedNumber(m_buffer, field.type->size);
+        m_buffer += ",\"access\":\"";
+        m_buffer += GetAccessString(field.access);
+        m_buffer += '"';
+
+        if (isVirtual)
+        {
+            m_buffer += ",\"virtual\":true";
+        }
+
+        m_buffer += '}';
+    }
+
+    m_buffer += ']';
+}
+
+void PDBJsonReconstructor::AppendVariant(const VARIANT& v)
+{
+    switch (v.vt)
+    {
+    case VT_I1:   AppendNumber(m_buffer, v.cVal); break;
+    case VT_UI1:  AppendUnsignedNumber(m_buffer, v.bVal); break;
+    case VT_I2:   AppendNumber(m_buffer, v.iVal); break;
+    case VT_UI2:  AppendUnsignedNumber(m_buffer, v.uiVal); break;
+    case VT_INT:
+    case VT_I4:   AppendNumber(m_buffer, v.lVal); break;
+    case VT_UINT:
+    case VT_UI4:  AppendUnsignedNumber(m_buffer, v.ulVal); break;
+    case VT_I8:   AppendNumber(m_buffer, v.llVal); break;
+    case VT_UI8:  AppendUnsignedNumber(m_buffer, v.ullVal); break;
+    default:      m_buffer += "null"; break;
+    }
+}
+
+void PDBJsonReconstructor::FlushRecord()
+{
+    m_output.write(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+}
+
+DWORD PDBJsonReconstructor::GetParentOffset() const
+{
+    return m_fieldStack.empty() ? 0 : m_fieldStack.back().offset;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "PDBReconstructorBase.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Emits one JSON object per line for every top-level enum and UDT. Fields
+// of unnamed nested types are flattened into their parent with absolute
+// offsets and dotted paths. Records are assembled in a reused buffer and
+// handed to the stream whole; no document tree is built.
+//
+class PDBJsonReconstructor final : public PDBReconstructorBase
+{
+public:
+    explicit PDBJsonReconstructor(std::ostream& output);
+
+    static void AppendString(std::string& buffer, const std::string& text);
+    static void AppendNumber(std::string& buffer, int64_t value);
+    static void AppendUnsignedNumber(std::string& buffer, uint64_t value);
+    static const char* GetAccessString(DWORD access);
+
+protected:
+    template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+    friend class PDBSymbolVisitor;
+
+    bool OnEnumType(const Symbol& symbol) override;
+    void OnEnumTypeBegin(const Symbol& symbol) override;
+    void OnEnumTypeEnd(const Symbol& symbol) override;
+    void OnEnumField(const SymbolEnumField& enumField) override;
+
+    bool OnUdt(const Symbol& symbol) override;
+    void OnUdtBegin(const Symbol& symbol) override;
+    void OnUdtEnd(const Symbol& symbol) override;
+
+    void OnUdtFieldBegin(const SymbolUdtField& udtField) override;
+    void OnUdtFieldEnd(const SymbolUdtField& udtField) override;
+    void OnUdtField(const SymbolUdtField& udtField, UdtFieldDefinitionBase& memberDefinition) override;
+
+    void OnPaddingMember(const SymbolUdtField& udtField, BasicType paddingBasicType, DWORD paddingBasicTypeSize, DWORD paddingSize) override;
+
+private:
+    struct FieldContext
+    {
+        DWORD offset;
+        std::string path;
+    };
+
+    void BeginRecordEntry();
+    void AppendBaseClasses(const Symbol& symbol);
+    void AppendVariant(const VARIANT& v);
+    void FlushRecord();
+    DWORD GetParentOffset() const;
+
+private:
+    std::ostream& m_output;
+    std::string m_buffer;
+    std::vector<FieldContext> m_fieldStack;
+    DWORD m_depth = 0;
+    DWORD m_paddingMemberCounter = 0;
+    bool m_firstEntry = true;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//
+// On-disk layout of the binary export (-f b). All integers are little
+// endian and all table offsets are relative to the start of the file, so
+// the file can be mapped and used in place. Strings are NUL-terminated and
+// addressed by their offset inside the string table.
+//
+
+static const char PDBLayoutMagic[8] = { 'P', 'D', 'B', 'X', 'L', 'Y', 'T', '1' };
+static const uint32_t PDBLayoutVersion = 1;
+static const uint32_t PDBLayoutInvalidIndex = 0xffffffff;
+
+enum PDBLayoutFieldFlags : uint16_t
+{
+    PDBLayoutFieldStatic   = 0x0001,
+    PDBLayoutFieldBitField = 0x0002,
+    PDBLayoutFieldPointer  = 0x0004,
+    PDBLayoutFieldArray    = 0x0008,
+};
+
+#pragma pack(push, 4)
+
+struct PDBLayoutHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t typeCount;
+    uint32_t fieldCount;
+    uint32_t hashBucketCount;           // power of two
+    uint32_t stringTableSize;
+    uint64_t typeTableOffset;           // PDBLayoutTypeRecord[typeCount]
+    uint64_t fieldTableOffset;          // PDBLayoutFieldRecord[fieldCount]
+    uint64_t hashTableOffset;           // uint32_t[hashBucketCount], type index or PDBLayoutInvalidIndex
+    uint64_t stringTableOffset;
+};
+
+struct PDBLayoutTypeRecord
+{
+    uint32_t nameOffset;
+    uint32_t nameHash;
+    uint32_t size;
+    uint32_t kind;                      // UdtKind
+    uint32_t firstField;
+    uint32_t fieldCount;
+};
+
+struct PDBLayoutFieldRecord
+{
+    uint32_t nameOffset;                // dotted path for members of unnamed nested types
+    uint32_t nameHash;
+    uint32_t offset;                    // absolute from the start of the owning type
+    uint32_t size;
+    uint32_t typeNameOffset;
+    uint32_t typeRef;                   // index of the by-value UDT (or array element UDT), or PDBLayoutInvalidIndex
+    uint16_t flags;                     // PDBLayoutFieldFlags
+    uint8_t bits;
+    uint8_t bitPosition;
+};
+
+#pragma pack(pop)
+
+inline uint32_t PDBLayoutHashName(const char* name, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 0x811c9dc5u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
@@ -0,0 +1,355 @@
+#include "PDBLayoutReader.h"
+
+#include <cstring>
+
+PDBLayoutReader::~PDBLayoutReader()
+{
+    Close();
+}
+
+bool PDBLayoutReader::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    m_file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(PDBLayoutHeader)))
+    {
+        Close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view)
+    {
+        Close();
+        return false;
+    }
+
+    return OpenView();
+}
+
+bool PDBLayoutReader::Open(const void* data, uint64_t size)
+{
+    Close();
+
+    if (!data || size < sizeof(PDBLayoutHeader))
+    {
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(data);
+    m_size = size;
+
+    return OpenView();
+}
+
+bool PDBLayoutReader::OpenView()
+{
+    m_header = reinterpret_cast<const PDBLayoutHeader*>(m_view);
+
+    if (!Validate())
+    {
+        Close();
+        return false;
+    }
+
+    m_types = reinterpret_cast<const PDBLayoutTypeRecord*>(m_view + m_header->typeTableOffset);
+    m_fields = reinterpret_cast<const PDBLayoutFieldRecord*>(m_view + m_header->fieldTableOffset);
+    m_hashTable = reinterpret_cast<const uint32_t*>(m_view + m_header->hashTableOffset);
+    m_strings = reinterpret_cast<const char*>(m_view + m_header->stringTableOffset);
+
+    return true;
+}
+
+void PDBLayoutReader::Close()
+{
+    // Views of memory layouts are not mapped.
+    if (m_view && m_mapping)
+    {
+        UnmapViewOfFile(m_view);
+    }
+
+    m_view = nullptr;
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+    m_size = 0;
+    m_header = nullptr;
+    m_types = nullptr;
+    m_fields = nullptr;
+    m_hashTable = nullptr;
+    m_strings = nullptr;
+}
+
+bool PDBLayoutReader::IsOpen() const
+{
+    return m_header != nullptr;
+}
+
+uint32_t PDBLayoutReader::GetTypeCount() const
+{
+    return m_header ? m_header->typeCount : 0;
+}
+
+const PDBLayoutTypeRecord* PDBLayoutReader::GetType(uint32_t typeIndex) const
+{
+    return typeIndex < GetTypeCount() ? &m_types[typeIndex] : nullptr;
+}
+
+const PDBLayoutFieldRecord* PDBLayoutReader::GetField(uint32_t fieldIndex) const
+{
+    return m_header && fieldIndex < m_header->fieldCount ? &m_fields[fieldIndex] : nullptr;
+}
+
+const char* PDBLayoutReader::GetString(uint32_t stringOffset) const
+{
+    return m_header && stringOffset < m_header->stringTableSize ? m_strings + stringOffset : "";
+}
+
+const PDBLayoutTypeRecord* PDBLayoutReader::FindType(std::string_view typeName) const
+{
+    if (!m_header)
+    {
+        return nullptr;
+    }
+
+    const uint32_t hash = PDBLayoutHashName(typeName.data(), typeName.size());
+    const uint32_t mask = m_header->hashBucketCount - 1;
+
+    for (uint32_t bucket = hash & mask; m_hashTable[bucket] != PDBLayoutInvalidIndex; bucket = (bucket + 1) & mask)
+    {
+        const auto* type = &m_types[m_hashTable[bucket]];
+
+        if (type->nameHash == hash && typeName == GetString(type->nameOffset))
+        {
+            return type;
+        }
+    }
+
+    return nullptr;
+}
+
+const PDBLayoutFieldRecord* PDBLayoutReader::FindField(const PDBLayoutTypeRecord* type, std::string_view fieldName) const
+{
+    if (!type)
+    {
+        return nullptr;
+    }
+
+    const uint32_t hash = PDBLayoutHashName(fieldName.data(), fieldName.size());
+
+    for (uint32_t i = 0; i < type->fieldCount; ++i)
+    {
+        const auto* field = &m_fields[type->firstField + i];
+
+        if (field->nameHash == hash && fieldName == GetString(field->nameOffset))
+        {
+            return field;
+        }
+    }
+
+    return nullptr;
+}
+
+bool PDBLayoutReader::GetFieldOffset(std::string_view path, uint32_t& offset, const PDBLayoutFieldRecord** field) const
+{
+    auto separator = path.find('.');
+    if (separator == std::string_view::npos)
+    {
+        return false;
+    }
+
+    const PDBLayoutTypeRecord* type = FindType(path.substr(0, separator));
+    const PDBLayoutFieldRecord* currentField = nullptr;
+    uint32_t currentOffset = 0;
+
+    path.remove_prefix(separator + 1);
+
+    while (type && !path.empty())
+    {
+        //
+        // Flattened members carry dotted names, so try the longest prefix
+        // first and fall back to shorter ones.
+        //
+
+        currentField = nullptr;
+
+        for (size_t length = path.size(); length != std::string_view::npos; length = path.rfind('.', length - 1))
+        {
+            currentField = FindField(type, path.substr(0, length));
+
+            if (currentField)
+            {
+                path.remove_prefix(length < path.size() ? length + 1 : length);
+                break;
+            }
+
+            if (length == 0)
+            {
+                break;
+            }
+        }
+
+        if (!currentField || (currentField->flags & PDBLayoutFieldStatic))
+        {
+            return false;
+        }
+
+        currentOffset += currentField->offset;
+
+        if (path.empty())
+        {
+            break;
+        }
+
+        // Only by-value members can be descended into.
+        if (currentField->flags & (PDBLayoutFieldPointer | PDBLayoutFieldArray))
+        {
+            return false;
+        }
+
+        type = GetType(currentField->typeRef);
+    }
+
+    if (!currentField || !path.empty())
+    {
+        return false;
+    }
+
+    offset = currentOffset;
+
+    if (field)
+    {
+        *field = currentField;
+    }
+
+    return true;
+}
+
+bool PDBLayoutReader::Validate() const
+{
+    const auto& header = *m_header;
+
+    if (memcmp(header.magic, PDBLayoutMagic, sizeof(header.magic)) != 0 ||
+        header.version != PDBLayoutVersion ||
+        header.headerSize < sizeof(PDBLayoutHeader))
+    {
+        return false;
+    }
+
+    // The hash table must be a non-empty power of two with at least one
+    // free bucket, otherwise a miss would never terminate.
+    if (header.hashBucketCount == 0 ||
+        (header.hashBucketCount & (header.hashBucketCount - 1)) != 0 ||
+        header.hashBucketCount <= header.typeCount)
+    {
+        return false;
+    }
+
+    auto fits = [this](uint64_t offset, uint64_t size)
+    {
+        return offset <= m_size && size <= m_size - offset;
+    };
+
+    if (!fits(header.typeTableOffset, uint64_t(header.typeCount) * sizeof(PDBLayoutTypeRecord)) ||
+        !fits(header.fieldTableOffset, uint64_t(header.fieldCount) * sizeof(PDBLayoutFieldRecord)) ||
+        !fits(header.hashTableOffset, uint64_t(header.hashBucketCount) * sizeof(uint32_t)) ||
+        !fits(header.stringTableOffset, header.stringTableSize))
+    {
+        return false;
+    }
+
+    // Every string must be terminated inside the table.
+    if (header.stringTableSize == 0 || m_view[header.stringTableOffset + header.stringTableSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    //
+    // Lookups index the tables with the values stored in the records
+    // without checking them, so every record is checked once here.
+    //
+
+    const auto* types = reinterpret_cast<const PDBLayoutTypeRecord*>(m_view + header.typeTableOffset);
+    const auto* fields = reinterpret_cast<const PDBLayoutFieldRecord*>(m_view + header.fieldTableOffset);
+    const auto* hashTable = reinterpret_cast<const uint32_t*>(m_view + header.hashTableOffset);
+
+    // A lookup miss probes until it reaches a free bucket, so there must be
+    // one; bucketCount > typeCount alone does not ensure that.
+    uint32_t freeBucketCount = 0;
+
+    for (uint32_t bucket = 0; bucket < header.hashBucketCount; ++bucket)
+    {
+        if (hashTable[bucket] == PDBLayoutInvalidIndex)
+        {
+            ++freeBucketCount;
+        }
+        else if (hashTable[bucket] >= header.typeCount)
+        {
+            return false;
+        }
+    }
+
+    if (freeBucketCount == 0)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.typeCount; ++i)
+    {
+        const auto& type = types[i];
+
+        if (type.nameOffset >= header.stringTableSize ||
+            uint64_t(type.firstField) + type.fieldCount > header.fieldCount)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.fieldCount; ++i)
+    {
+        const auto& field = fields[i];
+
+        if (field.nameOffset >= header.stringTableSize ||
+            field.typeNameOffset >= header.stringTableSize ||
+            (field.typeRef != PDBLayoutInvalidIndex && field.typeRef >= header.typeCount))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
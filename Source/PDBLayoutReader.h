@@ -0,0 +1,64 @@
+#pragma once
+#include "PDBLayoutFormat.h"
+
+#include <windows.h>
+#include <filesystem>
+#include <string_view>
+
+//
+// Read-only view of a layout file produced with -f b. The file is mapped
+// into memory and queried in place; nothing is parsed up front. Opening
+// checks every record once, so that lookups can follow the indexes and
+// string offsets in the file without checking them again.
+//
+// Depends on nothing but the Win32 API, so tools can link pdbex_layout.lib
+// without DIA.
+//
+class PDBLayoutReader
+{
+public:
+    PDBLayoutReader() = default;
+    ~PDBLayoutReader();
+
+    PDBLayoutReader(const PDBLayoutReader&) = delete;
+    PDBLayoutReader& operator=(const PDBLayoutReader&) = delete;
+
+    bool Open(const std::filesystem::path& path);
+
+    // Reads a layout already in memory; data must outlive the reader.
+    bool Open(const void* data, uint64_t size);
+    void Close();
+    bool IsOpen() const;
+
+    uint32_t GetTypeCount() const;
+    const PDBLayoutTypeRecord* GetType(uint32_t typeIndex) const;
+    const PDBLayoutFieldRecord* GetField(uint32_t fieldIndex) const;
+    const char* GetString(uint32_t stringOffset) const;
+
+    const PDBLayoutTypeRecord* FindType(std::string_view typeName) const;
+    const PDBLayoutFieldRecord* FindField(const PDBLayoutTypeRecord* type, std::string_view fieldName) const;
+
+    //
+    // Resolves "Type.member.member" to the absolute offset of the last
+    // member. Members of by-value UDTs (including base classes) are
+    // descended into; dotted paths of flattened unnamed members are
+    // matched as a whole.
+    //
+    bool GetFieldOffset(std::string_view path, uint32_t& offset, const PDBLayoutFieldRecord** field = nullptr) const;
+
+private:
+    bool OpenView();
+    bool Validate() const;
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    uint64_t m_size = 0;
+
+    const PDBLayoutHeader* m_header = nullptr;
+    const PDBLayoutTypeRecord* m_types = nullptr;
+    const PDBLayoutFieldRecord* m_fields = nullptr;
+    const uint32_t* m_hashTable = nullptr;
+    const char* m_strings = nullptr;
+};
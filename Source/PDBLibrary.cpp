@@ -0,0 +1,293 @@
+#define PDBEX_BUILD_LIBRARY
+#include "pdbex.h"
+
+#include "PDB.h"
+#include "PDBBinaryReconstructor.h"
+#include "PDBLayoutReader.h"
+#include "PDBQueryEngine.h"
+#include "PDBSymbolSorter.h"
+#include "PDBSymbolVisitor.h"
+#include "UdtFieldDefinitionBase.h"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//
+// Handles opened on a PDB keep it fully loaded and render its binary
+// layout into memory, so types and fields are read the same way for PDBs
+// and for layout files.
+//
+struct pdbex_handle
+{
+    PDB pdb;
+    std::unique_ptr<PDBQueryEngine> engine;
+
+    std::string layout;
+    PDBLayoutReader layoutReader;
+};
+
+namespace
+{
+    void RenderLayout(PDB& pdb, std::string& layout)
+    {
+        std::ostringstream stream;
+
+        PDBBinaryReconstructor reconstructor(stream);
+        PDBSymbolVisitor<UdtFieldDefinitionBase, PDBBinaryReconstructor> visitor(&reconstructor);
+        PDBSymbolSorter sorter;
+
+        for (const auto&[_, symbol] : pdb.GetSymbolMap())
+        {
+            assert(symbol);
+            sorter.Visit(*symbol);
+        }
+
+        for (const auto symIndex : sorter.GetSortedSymbolIndexes())
+        {
+            auto symbol = pdb.GetSymbolBySymbolIndex(symIndex);
+            assert(symbol);
+
+            // Unnamed nested types are flattened into their parents.
+            if (symbol->tag == SymTagUDT && PDB::IsUnnamedSymbol(*symbol))
+            {
+                continue;
+            }
+
+            visitor.Run(*symbol);
+        }
+
+        static_cast<PDBReconstructorBase&>(reconstructor).OnFinish();
+
+        layout = stream.str();
+    }
+
+    void FillType(const PDBLayoutReader& reader, const PDBLayoutTypeRecord& record, pdbex_type& type)
+    {
+        type.name = reader.GetString(record.nameOffset);
+        type.index = static_cast<uint32_t>(&record - reader.GetType(0));
+        type.size = record.size;
+        type.kind = record.kind;
+        type.field_count = record.fieldCount;
+    }
+
+    //
+    // Keeps exceptions, such as allocation failures, from crossing the C
+    // boundary.
+    //
+    template<typename Func>
+    pdbex_status Guard(const Func& func)
+    {
+        try
+        {
+            return func();
+        }
+        catch (...)
+        {
+            return PDBEX_INTERNAL_ERROR;
+        }
+    }
+}
+
+uint32_t pdbex_get_api_version(void)
+{
+    return PDBEX_API_VERSION;
+}
+
+pdbex_status pdbex_open(const char* path, pdbex_handle** handle)
+{
+    if (!path || !handle)
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    *handle = nullptr;
+
+    return Guard([path, handle]()
+    {
+        const std::filesystem::path filePath(std::u8string_view(reinterpret_cast<const char8_t*>(path)));
+        auto newHandle = std::make_unique<pdbex_handle>();
+
+        // Layout files are recognized by their header; anything else is
+        // taken for a PDB.
+        if (!newHandle->layoutReader.Open(filePath))
+        {
+            if (!newHandle->pdb.Open(filePath, PDB::LoadMode::Full))
+            {
+                return PDBEX_OPEN_FAILED;
+            }
+
+            // DIA stays on this thread; later calls may come from any.
+            newHandle->pdb.LoadAddressIndex();
+
+            RenderLayout(newHandle->pdb, newHandle->layout);
+
+            if (!newHandle->layoutReader.Open(newHandle->layout.data(), newHandle->layout.size()))
+            {
+                return PDBEX_INTERNAL_ERROR;
+            }
+
+            newHandle->engine = std::make_unique<PDBQueryEngine>(newHandle->pdb, PDBHeaderReconstructorSettings());
+        }
+
+        *handle = newHandle.release();
+        return PDBEX_OK;
+    });
+}
+
+void pdbex_close(pdbex_handle* handle)
+{
+    delete handle;
+}
+
+uint32_t pdbex_get_type_count(const pdbex_handle* handle)
+{
+    return handle ? handle->layoutReader.GetTypeCount() : 0;
+}
+
+pdbex_status pdbex_get_type(const pdbex_handle* handle, uint32_t type_index, pdbex_type* type)
+{
+    if (!handle || !type)
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    const auto* record = handle->layoutReader.GetType(type_index);
+    if (!record)
+    {
+        return PDBEX_NOT_FOUND;
+    }
+
+    FillType(handle->layoutReader, *record, *type);
+    return PDBEX_OK;
+}
+
+pdbex_status pdbex_find_type(const pdbex_handle* handle, const char* name, pdbex_type* type)
+{
+    if (!handle || !name || !type)
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    const auto* record = handle->layoutReader.FindType(name);
+    if (!record)
+    {
+        return PDBEX_NOT_FOUND;
+    }
+
+    FillType(handle->layoutReader, *record, *type);
+    return PDBEX_OK;
+}
+
+pdbex_status pdbex_get_field(const pdbex_handle* handle, uint32_t type_index, uint32_t field_index, pdbex_field* field)
+{
+    if (!handle || !field)
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    const auto& reader = handle->layoutReader;
+
+    const auto* type = reader.GetType(type_index);
+    if (!type || field_index >= type->fieldCount)
+    {
+        return PDBEX_NOT_FOUND;
+    }
+
+    const auto* record = reader.GetField(type->firstField + field_index);
+    if (!record)
+    {
+        return PDBEX_NOT_FOUND;
+    }
+
+    field->name = reader.GetString(record->nameOffset);
+    field->type_name = reader.GetString(record->typeNameOffset);
+    field->offset = record->offset;
+    field->size = record->size;
+    field->type_index = record->typeRef;
+    field->flags = record->flags;
+    field->bits = record->bits;
+    field->bit_position = record->bitPosition;
+
+    return PDBEX_OK;
+}
+
+pdbex_status pdbex_get_field_offset(const pdbex_handle* handle, const char* path, uint32_t* offset)
+{
+    if (!handle || !path || !offset)
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    return handle->layoutReader.GetFieldOffset(path, *offset) ? PDBEX_OK : PDBEX_NOT_FOUND;
+}
+
+pdbex_status pdbex_render_type(pdbex_handle* handle, const char* name, char* buffer, size_t buffer_size, size_t* required_size)
+{
+    if (!handle || !name || (!buffer && buffer_size != 0))
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    if (!handle->engine)
+    {
+        return PDBEX_NOT_SUPPORTED;
+    }
+
+    return Guard([handle, name, buffer, buffer_size, required_size]()
+    {
+        std::string output;
+        if (!handle->engine->Execute(std::string("type ") + name, output))
+        {
+            return PDBEX_NOT_FOUND;
+        }
+
+        if (required_size)
+        {
+            *required_size = output.size() + 1;
+        }
+
+        if (buffer_size < output.size() + 1)
+        {
+            return PDBEX_BUFFER_TOO_SMALL;
+        }
+
+        memcpy(buffer, output.c_str(), output.size() + 1);
+        return PDBEX_OK;
+    });
+}
+
+pdbex_status pdbex_symbolize(pdbex_handle* handle, const uint32_t* rvas, size_t count, pdbex_address* addresses)
+{
+    if (!handle || (count != 0 && (!rvas || !addresses)))
+    {
+        return PDBEX_INVALID_ARGUMENT;
+    }
+
+    if (!handle->engine)
+    {
+        return PDBEX_NOT_SUPPORTED;
+    }
+
+    return Guard([handle, rvas, count, addresses]()
+    {
+        const std::vector<DWORD> rvaBatch(rvas, rvas + count);
+        std::vector<SymbolAddress> symbolAddresses;
+
+        handle->pdb.SymbolizeAddresses(rvaBatch, symbolAddresses);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            addresses[i].name = symbolAddresses[i].name.data();
+            addresses[i].name_length = symbolAddresses[i].name.size();
+            addresses[i].section = symbolAddresses[i].section;
+            addresses[i].offset = symbolAddresses[i].offset;
+            addresses[i].displacement = symbolAddresses[i].displacement;
+        }
+
+        return PDBEX_OK;
+    });
+}
@@ -0,0 +1,599 @@
+#include "PDBQueryEngine.h"
+#include "PDBSymbolSorter.h"
+#include "PDBSymbolVisitor.h"
+#include "UdtFieldDefinition.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+    bool GetVariantValue(const VARIANT& v, std::string& value)
+    {
+        switch (v.vt)
+        {
+        case VT_I1:   value = std::to_string(v.cVal); return true;
+        case VT_UI1:  value = std::to_string(v.bVal); return true;
+        case VT_I2:   value = std::to_string(v.iVal); return true;
+        case VT_UI2:  value = std::to_string(v.uiVal); return true;
+        case VT_INT:
+        case VT_I4:   value = std::to_string(v.lVal); return true;
+        case VT_UINT:
+        case VT_UI4:  value = std::to_string(v.ulVal); return true;
+        case VT_I8:   value = std::to_string(v.llVal); return true;
+        case VT_UI8:  value = std::to_string(v.ullVal); return true;
+        default:      return false;
+        }
+    }
+
+    const char* const ReferenceKindNames[] = { "value", "pointer", "array", "base", "arg" };
+
+    bool ParseReferenceKinds(const std::string& text, unsigned& kinds)
+    {
+        kinds = 0;
+
+        for (size_t begin = 0; begin <= text.size();)
+        {
+            const auto end = (std::min)(text.find(',', begin), text.size());
+            const std::string name = text.substr(begin, end - begin);
+
+            const auto it = std::find(std::begin(ReferenceKindNames), std::end(ReferenceKindNames), name);
+            if (it == std::end(ReferenceKindNames))
+            {
+                return false;
+            }
+
+            kinds |= 1u << (it - std::begin(ReferenceKindNames));
+            begin = end + 1;
+        }
+
+        return true;
+    }
+
+    void AppendNameMatches(const std::vector<SymbolNameMatch>& matches, bool withDistance, std::string& output)
+    {
+        for (const auto& match : matches)
+        {
+            output += match.name;
+            output += match.isFunction ? " function" : " type";
+
+            if (withDistance)
+            {
+                output += ' ' + std::to_string(match.distance);
+            }
+
+            output += '\n';
+        }
+    }
+}
+
+PDBQueryEngine::PDBQueryEngine(PDB& pdb, const PDBHeaderReconstructorSettings& settings)
+    : m_pdb(pdb)
+{
+    CopyRenderSettings(settings, m_settings);
+
+    for (const auto&[_, symbol] : m_pdb.GetSymbolMap())
+    {
+        if ((symbol->tag != SymTagUDT && symbol->tag != SymTagEnum) || symbol->name.empty() || PDB::IsUnnamedSymbol(*symbol))
+        {
+            continue;
+        }
+
+        auto& type = m_types[symbol->name];
+        if (!type || (type->size == 0 && symbol->size != 0))
+        {
+            type = symbol.get();
+        }
+    }
+
+    // "sym" is answered from the public symbols, which are read through
+    // DIA; that has to happen here, on the thread that opened the PDB,
+    // rather than on whichever thread asks first.
+    m_pdb.LoadAddressIndex();
+}
+
+bool PDBQueryEngine::Execute(const std::string& query, std::string& output) const
+{
+    using QueryHandler = bool (PDBQueryEngine::*)(const std::string&, std::string&) const;
+
+    static const std::pair<const char*, QueryHandler> Queries[] = {
+        { "type",     &PDBQueryEngine::QueryType },
+        { "show",     &PDBQueryEngine::QueryType },
+        { "sizeof",   &PDBQueryEngine::QuerySizeof },
+        { "offsetof", &PDBQueryEngine::QueryOffsetof },
+        { "at",       &PDBQueryEngine::QueryAt },
+        { "refs",     &PDBQueryEngine::QueryReferences },
+        { "xrefs",    &PDBQueryEngine::QueryReferences },
+        { "dependents", &PDBQueryEngine::QueryDependents },
+        { "find",     &PDBQueryEngine::QueryFind },
+        { "prefix",   &PDBQueryEngine::QueryPrefix },
+        { "fuzzy",    &PDBQueryEngine::QueryFuzzy },
+        { "funcs",    &PDBQueryEngine::QueryFunctions },
+        { "enum",     &PDBQueryEngine::QueryEnum },
+        { "sym",      &PDBQueryEngine::QuerySymbol },
+    };
+
+    const auto commandBegin = query.find_first_not_of(" \t");
+    const auto commandEnd = query.find_first_of(" \t", commandBegin);
+    const auto argumentBegin = query.find_first_not_of(" \t", commandEnd);
+    const auto argumentEnd = query.find_last_not_of(" \t");
+
+    if (commandBegin == std::string::npos)
+    {
+        output = "empty query";
+        return false;
+    }
+
+    const std::string command = query.substr(commandBegin, commandEnd - commandBegin);
+    const std::string argument = argumentBegin == std::string::npos
+        ? std::string()
+        : query.substr(argumentBegin, argumentEnd - argumentBegin + 1);
+
+    output.clear();
+
+    for (const auto&[name, handler] : Queries)
+    {
+        if (command == name)
+        {
+            return (this->*handler)(argument, output);
+        }
+    }
+
+    output = "unknown query: " + command;
+    return false;
+}
+
+void PDBQueryEngine::FormatResponse(bool success, const std::string& output, std::string& response)
+{
+    if (success)
+    {
+        response = "OK " + std::to_string(output.size()) + '\n';
+        response += output;
+    }
+    else
+    {
+        // Error messages are single-line by construction.
+        response = "ERR " + output + '\n';
+    }
+}
+
+const Symbol* PDBQueryEngine::FindType(const std::string& typeName) const
+{
+    auto it = m_types.find(typeName);
+    return it == m_types.end() ? nullptr : it->second;
+}
+
+bool PDBQueryEngine::QueryType(const std::string& argument, std::string& output) const
+{
+    const Symbol* symbol = FindType(argument);
+    if (!symbol)
+    {
+        output = "type not found: " + argument;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_renderCacheMutex);
+
+        auto it = m_renderCache.find(symbol);
+        if (it != m_renderCache.end())
+        {
+            output = it->second;
+            return true;
+        }
+    }
+
+    // Rendered outside the lock; concurrent misses for the same type just
+    // render it twice.
+    RenderType(*symbol, output);
+
+    std::lock_guard<std::mutex> lock(m_renderCacheMutex);
+    m_renderCache.emplace(symbol, output);
+
+    return true;
+}
+
+bool PDBQueryEngine::QuerySizeof(const std::string& argument, std::string& output) const
+{
+    const Symbol* symbol = FindType(argument);
+    if (!symbol)
+    {
+        output = "type not found: " + argument;
+        return false;
+    }
+
+    output = std::to_string(symbol->size) + '\n';
+    return true;
+}
+
+bool PDBQueryEngine::QueryOffsetof(const std::string& argument, std::string& output) const
+{
+    const auto typeEnd = argument.find('.');
+    const Symbol* symbol = typeEnd == std::string::npos ? nullptr : FindType(argument.substr(0, typeEnd));
+
+    SymbolFieldLocation field;
+    if (!symbol || !m_pdb.GetFieldAtPath(*symbol, argument.substr(typeEnd + 1), field))
+    {
+        output = "field not found: " + argument;
+        return false;
+    }
+
+    output = std::to_string(field.offset) + ' ' + std::to_string(field.size);
+
+    if (field.bits != 0)
+    {
+        output += ' ' + std::to_string(field.bitPosition) + ' ' + std::to_string(field.bits);
+    }
+
+    output += '\n';
+    return true;
+}
+
+bool PDBQueryEngine::QueryAt(const std::string& argument, std::string& output) const
+{
+    const auto separator = argument.rfind('+');
+    const Symbol* symbol = separator == std::string::npos ? nullptr : FindType(argument.substr(0, separator));
+
+    if (!symbol)
+    {
+        output = "type not found: " + argument;
+        return false;
+    }
+
+    char* end = nullptr;
+    const auto offset = strtoul(argument.c_str() + separator + 1, &end, 0);
+    if (end == argument.c_str() + separator + 1 || *end != '\0')
+    {
+        output = "invalid offset: " + argument;
+        return false;
+    }
+
+    std::vector<SymbolFieldLocation> fields;
+    m_pdb.GetFieldsAtOffset(*symbol, static_cast<DWORD>(offset), fields);
+
+    for (const auto& field : fields)
+    {
+        output += field.path + ' ' + std::to_string(field.offset) + ' ' + std::to_string(field.size);
+
+        if (field.bits != 0)
+        {
+            output += ' ' + std::to_string(field.bitPosition) + ' ' + std::to_string(field.bits);
+        }
+
+        output += '\n';
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::QueryReferences(const std::string& argument, std::string& output) const
+{
+    const Symbol* symbol = nullptr;
+    unsigned kinds = 0;
+
+    if (!ParseReferenceQuery(argument, symbol, kinds, output))
+    {
+        return false;
+    }
+
+    std::vector<SymbolReference> references;
+    m_pdb.GetReferences(*symbol, references);
+
+    for (const auto& reference : references)
+    {
+        if (!(kinds & SymbolReferenceKindBit(reference.kind)))
+        {
+            continue;
+        }
+
+        output += reference.type->name + ' ';
+        output += reference.field->name.empty() ? "-" : reference.field->name;
+        output += ' ' + std::to_string(reference.field->offset) + ' ';
+        output += ReferenceKindNames[static_cast<size_t>(reference.kind)];
+        output += '\n';
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::QueryDependents(const std::string& argument, std::string& output) const
+{
+    const Symbol* symbol = nullptr;
+    unsigned kinds = 0;
+
+    if (!ParseReferenceQuery(argument, symbol, kinds, output))
+    {
+        return false;
+    }
+
+    std::vector<const Symbol*> dependents;
+    m_pdb.GetDependents(*symbol, kinds, dependents);
+
+    for (const auto dependent : dependents)
+    {
+        // Unnamed types are only walked through.
+        if (!PDB::IsUnnamedSymbol(*dependent))
+        {
+            output += dependent->name + '\n';
+        }
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::ParseReferenceQuery(const std::string& argument, const Symbol*& symbol, unsigned& kinds, std::string& output) const
+{
+    const auto typeEnd = argument.find_first_of(" \t");
+    const auto kindsBegin = argument.find_first_not_of(" \t", typeEnd);
+
+    symbol = FindType(argument.substr(0, typeEnd));
+    if (!symbol)
+    {
+        output = "type not found: " + argument.substr(0, typeEnd);
+        return false;
+    }
+
+    kinds = SymbolReferenceKindAll;
+    if (kindsBegin != std::string::npos && !ParseReferenceKinds(argument.substr(kindsBegin), kinds))
+    {
+        output = "invalid reference kinds: " + argument.substr(kindsBegin);
+        return false;
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::QueryFind(const std::string& argument, std::string& output) const
+{
+    const bool isGlob = argument.find_first_of("*?") != std::string::npos;
+
+    std::vector<SymbolNameMatch> matches;
+    m_pdb.SearchNames(argument, isGlob ? SymbolNameSearch::Glob : SymbolNameSearch::Substring, matches);
+
+    AppendNameMatches(matches, false, output);
+    return true;
+}
+
+bool PDBQueryEngine::QueryPrefix(const std::string& argument, std::string& output) const
+{
+    std::vector<SymbolNameMatch> matches;
+    m_pdb.SearchNames(argument, SymbolNameSearch::Prefix, matches);
+
+    AppendNameMatches(matches, false, output);
+    return true;
+}
+
+bool PDBQueryEngine::QueryFuzzy(const std::string& argument, std::string& output) const
+{
+    const auto nameEnd = argument.find_first_of(" \t");
+    const auto distanceBegin = argument.find_first_not_of(" \t", nameEnd);
+
+    unsigned long maxDistance = 2;
+
+    if (distanceBegin != std::string::npos)
+    {
+        char* end = nullptr;
+        maxDistance = strtoul(argument.c_str() + distanceBegin, &end, 10);
+
+        if (*end != '\0' || end == argument.c_str() + distanceBegin)
+        {
+            output = "invalid distance: " + argument.substr(distanceBegin);
+            return false;
+        }
+    }
+
+    std::vector<SymbolNameMatch> matches;
+    m_pdb.SearchNames(argument.substr(0, nameEnd), SymbolNameSearch::Fuzzy, matches, static_cast<unsigned>(maxDistance));
+
+    AppendNameMatches(matches, true, output);
+    return true;
+}
+
+bool PDBQueryEngine::QueryFunctions(const std::string& argument, std::string& output) const
+{
+    const auto& functionSet = m_pdb.GetFunctionSet();
+
+    for (auto it = functionSet.lower_bound(argument);
+         it != functionSet.end() && it->compare(0, argument.size(), argument) == 0;
+         ++it)
+    {
+        output += *it;
+        output += '\n';
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::QueryEnum(const std::string& argument, std::string& output) const
+{
+    const Symbol* symbol = FindType(argument);
+    std::string enumeratorName;
+
+    if (!symbol)
+    {
+        const auto valueSeparator = argument.rfind(' ');
+        if (valueSeparator != std::string::npos)
+        {
+            symbol = FindType(argument.substr(0, valueSeparator));
+
+            if (symbol && symbol->tag == SymTagEnum)
+            {
+                return QueryEnumValue(*symbol, argument.substr(valueSeparator + 1), output);
+            }
+        }
+
+        const auto separator = argument.rfind('.');
+        if (separator != std::string::npos)
+        {
+            symbol = FindType(argument.substr(0, separator));
+            enumeratorName = argument.substr(separator + 1);
+        }
+    }
+
+    if (!symbol || symbol->tag != SymTagEnum)
+    {
+        output = "enum not found: " + argument;
+        return false;
+    }
+
+    std::string value;
+
+    for (const auto& enumField : std::get<SymbolEnum>(symbol->variant).fields)
+    {
+        if (!enumeratorName.empty() && enumField.name != enumeratorName)
+        {
+            continue;
+        }
+
+        if (!GetVariantValue(enumField.value, value))
+        {
+            value = "?";
+        }
+
+        if (!enumeratorName.empty())
+        {
+            output = value + '\n';
+            return true;
+        }
+
+        output += enumField.name + ' ' + value + '\n';
+    }
+
+    if (!enumeratorName.empty())
+    {
+        output = "enumerator not found: " + argument;
+        return false;
+    }
+
+    return true;
+}
+
+bool PDBQueryEngine::QueryEnumValue(const Symbol& symbol, const std::string& valueText, std::string& output) const
+{
+    char* end = nullptr;
+    const int64_t value = valueText.front() == '-'
+        ? strtoll(valueText.c_str(), &end, 0)
+        : static_cast<int64_t>(strtoull(valueText.c_str(), &end, 0));
+
+    if (*end != '\0')
+    {
+        output = "invalid value: " + valueText;
+        return false;
+    }
+
+    const auto& fields = std::get<SymbolEnum>(symbol.variant).fields;
+    int64_t enumeratorValue;
+
+    for (const auto& enumField : fields)
+    {
+        if (PDB::GetVariantInteger(enumField.value, enumeratorValue) && enumeratorValue == value)
+        {
+            output += enumField.name + '\n';
+        }
+    }
+
+    if (!output.empty())
+    {
+        return true;
+    }
+
+    //
+    // No exact match: decompose the value into single-bit enumerators, as
+    // flags enums are used.
+    //
+    auto remainingBits = static_cast<uint64_t>(value);
+
+    for (const auto& enumField : fields)
+    {
+        if (!PDB::GetVariantInteger(enumField.value, enumeratorValue))
+        {
+            continue;
+        }
+
+        const auto bit = static_cast<uint64_t>(enumeratorValue);
+        if (bit != 0 && (bit & (bit - 1)) == 0 && (remainingBits & bit) != 0)
+        {
+            output += output.empty() ? enumField.name : " | " + enumField.name;
+            remainingBits &= ~bit;
+        }
+    }
+
+    if (value == 0 || remainingBits != 0)
+    {
+        output = "no enumerator with value " + valueText;
+        return false;
+    }
+
+    output += '\n';
+    return true;
+}
+
+bool PDBQueryEngine::QuerySymbol(const std::string& argument, std::string& output) const
+{
+    char* end = nullptr;
+    const auto rva = strtoull(argument.c_str(), &end, 16);
+
+    if (argument.empty() || *end != '\0' || rva > MAXDWORD)
+    {
+        output = "invalid rva: " + argument;
+        return false;
+    }
+
+    std::vector<SymbolAddress> addresses;
+    m_pdb.SymbolizeAddresses({ static_cast<DWORD>(rva) }, addresses);
+
+    const auto& address = addresses.front();
+    if (address.name.empty())
+    {
+        output = "no symbol at " + argument;
+        return false;
+    }
+
+    output = address.name;
+
+    if (address.displacement != 0)
+    {
+        std::ostringstream displacement;
+        displacement << std::hex << address.displacement;
+
+        output += "+0x" + displacement.str();
+    }
+
+    output += '\n';
+    return true;
+}
+
+void PDBQueryEngine::RenderType(const Symbol& symbol, std::string& output) const
+{
+    std::ostringstream stream;
+
+    PDBHeaderReconstructorSettings settings;
+    CopyRenderSettings(m_settings, settings);
+    settings.output = stream;
+
+    // Sorter and reconstructor carry per-run state, so every query gets
+    // its own.
+    PDBHeaderReconstructor reconstructor(settings);
+    PDBSymbolVisitor<UdtFieldDefinition, PDBHeaderReconstructor> visitor(&reconstructor);
+    PDBSymbolSorter sorter;
+
+    sorter.Visit(symbol);
+
+    for (const auto symIndex : sorter.GetSortedSymbolIndexes())
+    {
+        auto sortedSymbol = m_pdb.GetSymbolBySymbolIndex(symIndex);
+        assert(sortedSymbol);
+
+        if (settings.memberStructExpansion == PDBMemberStructExpansionType::InlineUnnamed &&
+            sortedSymbol->tag == SymTagUDT &&
+            PDB::IsUnnamedSymbol(*sortedSymbol))
+        {
+            continue;
+        }
+
+        visitor.Run(*sortedSymbol);
+    }
+
+    output = stream.str();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "PDB.h"
+#include "PDBHeaderReconstructor.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//
+// Answers single-line queries against a fully loaded PDB:
+//
+//   type <name>              header text of the type and its by-value dependencies
+//                            ("show" is an alias)
+//   sizeof <name>            size in bytes
+//   offsetof <Type.a.b[2]>   "<offset> <size>", plus " <bitPosition> <bits>" for bit fields
+//   at <Type>+<offset>       "<path> <offset> <size> [<bitPosition> <bits>]" for every
+//                            member covering offset (several inside unions)
+//   refs <name> [kinds]      "<referrer> <member> <offset> <kind>" for every member
+//                            referring to the type ("xrefs" is an alias)
+//   dependents <name> [kinds]
+//                            named types reaching the type through references,
+//                            directly or transitively
+//   find <text>|<glob>       "<name> type|function" for names containing text or
+//                            matching the glob, case-insensitively
+//   prefix <text>            same, for names starting with text
+//   fuzzy <name> [distance]  "<name> type|function <distance>" for names within
+//                            the edit distance (default 2), closest first
+//   funcs <prefix>           function names starting with prefix, one per line
+//   enum <name>              "<enumerator> <value>" lines
+//   enum <name>.<enumerator> value of one enumerator
+//   enum <name> <value>      enumerators with the value, or "A | B" for a combination
+//                            of single-bit enumerators
+//   sym <rva>                "<public symbol>[+0x<displacement>]" covering the hex RVA
+//
+// Reference kinds are value, pointer, array, base and arg; [kinds] is a
+// comma-separated subset and defaults to all of them.
+//
+// The loaded symbol graph is only read, and the public symbols are read
+// when the engine is created, so one engine can serve queries from
+// several threads at once. Rendered types are cached, so repeated
+// type queries are answered without sorting and rendering again.
+//
+class PDBQueryEngine
+{
+public:
+    PDBQueryEngine(PDB& pdb, const PDBHeaderReconstructorSettings& settings);
+
+    // Returns false and an error message in output when the query fails.
+    bool Execute(const std::string& query, std::string& output) const;
+
+    // Frames a result as "OK <byte count>\n<output>" or "ERR <output>\n".
+    static void FormatResponse(bool success, const std::string& output, std::string& response);
+
+    const Symbol* FindType(const std::string& typeName) const;
+
+private:
+    bool QueryType(const std::string& argument, std::string& output) const;
+    bool QuerySizeof(const std::string& argument, std::string& output) const;
+    bool QueryOffsetof(const std::string& argument, std::string& output) const;
+    bool QueryAt(const std::string& argument, std::string& output) const;
+    bool QueryReferences(const std::string& argument, std::string& output) const;
+    bool QueryDependents(const std::string& argument, std::string& output) const;
+    bool QueryFind(const std::string& argument, std::string& output) const;
+    bool QueryPrefix(const std::string& argument, std::string& output) const;
+    bool QueryFuzzy(const std::string& argument, std::string& output) const;
+    bool QueryFunctions(const std::string& argument, std::string& output) const;
+    bool QueryEnum(const std::string& argument, std::string& output) const;
+    bool QueryEnumValue(const Symbol& symbol, const std::string& valueText, std::string& output) const;
+    bool QuerySymbol(const std::string& argument, std::string& output) const;
+
+    bool ParseReferenceQuery(const std::string& argument, const Symbol*& symbol, unsigned& kinds, std::string& output) const;
+    void RenderType(const Symbol& symbol, std::string& output) const;
+
+private:
+    PDB& m_pdb;
+    PDBHeaderReconstructorSettings m_settings;
+
+    // Named enums and UDTs; definitions win over forward declarations.
+    std::unordered_map<std::string, const Symbol*> m_types;
+
+    mutable std::mutex m_renderCacheMutex;
+    mutable std::unordered_map<const Symbol*, std::string> m_renderCache;
+};
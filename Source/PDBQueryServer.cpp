@@ -0,0 +1,160 @@
+#include "PDBQueryServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace
+{
+    // Accept failures (e.g. running out of handles) are retried with a
+    // growing delay instead of in a busy loop.
+    const std::chrono::milliseconds AcceptRetryDelayMin(10);
+    const std::chrono::milliseconds AcceptRetryDelayMax(1000);
+}
+
+PDBQueryServer::PDBQueryServer(size_t threadCount)
+    : m_workerPool(threadCount)
+{
+
+}
+
+void PDBQueryServer::AddEngine(const std::string& name, const PDBQueryEngine& engine)
+{
+    m_engines.emplace_back(name, &engine);
+}
+
+bool PDBQueryServer::Run(const std::filesystem::path& socketPath)
+{
+    UnixSocket listener;
+    if (!listener.Listen(socketPath))
+    {
+        return false;
+    }
+
+    auto retryDelay = AcceptRetryDelayMin;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_connectionMutex);
+            m_connectionClosed.wait(lock, [this]()
+            {
+                return m_connectionCount < MaxConnectionCount;
+            });
+        }
+
+        auto client = std::make_shared<UnixSocket>();
+        if (!listener.Accept(*client))
+        {
+            std::this_thread::sleep_for(retryDelay);
+            retryDelay = (std::min)(retryDelay * 2, AcceptRetryDelayMax);
+            continue;
+        }
+
+        retryDelay = AcceptRetryDelayMin;
+
+        {
+            std::lock_guard<std::mutex> lock(m_connectionMutex);
+            ++m_connectionCount;
+        }
+
+        std::thread([this, client]()
+        {
+            Serve(*client);
+            client->Close();
+
+            std::lock_guard<std::mutex> lock(m_connectionMutex);
+            --m_connectionCount;
+            m_connectionClosed.notify_one();
+        }).detach();
+    }
+}
+
+void PDBQueryServer::Serve(UnixSocket& client)
+{
+    std::string request;
+    std::string output;
+    std::string response;
+    bool isTooLong = false;
+
+    for (;;)
+    {
+        if (!client.ReadLine(request, MaxRequestSize, &isTooLong))
+        {
+            if (isTooLong)
+            {
+                output = "request too long";
+                PDBQueryEngine::FormatResponse(false, output, response);
+                client.Write(response);
+            }
+
+            break;
+        }
+
+        if (request == "quit")
+        {
+            break;
+        }
+
+        PDBQueryEngine::FormatResponse(ExecuteOnPool(request, output), output, response);
+
+        if (!client.Write(response))
+        {
+            break;
+        }
+    }
+}
+
+bool PDBQueryServer::ExecuteOnPool(const std::string& request, std::string& output)
+{
+    auto task = std::make_shared<std::packaged_task<bool()>>([this, &request, &output]()
+    {
+        return Execute(request, output);
+    });
+
+    auto result = task->get_future();
+
+    m_workerPool.Submit([task]()
+    {
+        (*task)();
+    });
+
+    try
+    {
+        return result.get();
+    }
+    catch (const std::exception& exception)
+    {
+        output = exception.what();
+        return false;
+    }
+}
+
+bool PDBQueryServer::Execute(const std::string& request, std::string& output) const
+{
+    if (m_engines.empty())
+    {
+        output = "no PDB loaded";
+        return false;
+    }
+
+    if (request.empty() || request[0] != '@')
+    {
+        return m_engines.front().second->Execute(request, output);
+    }
+
+    const auto nameEnd = request.find(' ');
+    const std::string name = request.substr(1, nameEnd == std::string::npos ? std::string::npos : nameEnd - 1);
+
+    for (const auto&[engineName, engine] : m_engines)
+    {
+        if (engineName == name)
+        {
+            return engine->Execute(nameEnd == std::string::npos ? std::string() : request.substr(nameEnd + 1), output);
+        }
+    }
+
+    output = "unknown PDB: " + name;
+    return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "PDBQueryEngine.h"
+#include "ThreadPool.h"
+#include "UnixSocket.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Serves PDBQueryEngine queries over a Unix domain socket. Each request is
+// one line, optionally prefixed with "@<pdb name> " to pick a PDB other
+// than the first one. Each response is either
+//
+//   OK <byte count>\n<payload>
+//   ERR <message>\n
+//
+// Connections stay open for any number of requests. Each one is read and
+// written on its own thread, which hands every request to the worker pool
+// and waits for its response, so idle connections do not hold workers.
+// At most MaxConnectionCount connections are served at once; later ones
+// wait in the listen backlog until one closes. A request longer than
+// MaxRequestSize gets an ERR response and its connection is closed.
+//
+class PDBQueryServer
+{
+public:
+    static const size_t MaxConnectionCount = 64;
+    static const size_t MaxRequestSize = 64 * 1024;
+
+    explicit PDBQueryServer(size_t threadCount = std::thread::hardware_concurrency());
+
+    // The first engine added answers requests without an "@" prefix.
+    void AddEngine(const std::string& name, const PDBQueryEngine& engine);
+
+    // Blocks while serving; returns false if the socket cannot be created.
+    bool Run(const std::filesystem::path& socketPath);
+
+private:
+    void Serve(UnixSocket& client);
+    bool ExecuteOnPool(const std::string& request, std::string& output);
+    bool Execute(const std::string& request, std::string& output) const;
+
+private:
+    std::vector<std::pair<std::string, const PDBQueryEngine*>> m_engines;
+    ThreadPool m_workerPool;
+
+    std::mutex m_connectionMutex;
+    std::condition_variable m_connectionClosed;
+    size_t m_connectionCount = 0;
+};
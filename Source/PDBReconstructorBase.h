@@ -28,4 +28,7 @@ public:
     virtual	void OnPaddingMember(const SymbolUdtField& udtField, BasicType PaddingBasicType, DWORD PaddingBasicTypeSize, DWORD PaddingSize) {}
 
     virtual void OnPaddingBitFieldField(const SymbolUdtField& udtField, const SymbolUdtField* previousUdtField) {}
+
+    // Called once after the last symbol has been visited.
+    virtual void OnFinish() {}
 };
@@ -0,0 +1,234 @@
+#include "PDBSplitOutputWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const size_t MaximumComponentLength = 96;
+
+    const char* ReservedFileNames[] = {
+        "con", "prn", "aux", "nul",
+        "com1", "com2", "com3", "com4", "com5", "com6", "com7", "com8", "com9",
+        "lpt1", "lpt2", "lpt3", "lpt4", "lpt5", "lpt6", "lpt7", "lpt8", "lpt9",
+    };
+
+    std::string ToLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    std::string ToHex(uint64_t value, int digits)
+    {
+        char buffer[32] = {};
+        snprintf(buffer, sizeof(buffer), "%0*llx", digits, static_cast<unsigned long long>(value));
+        return buffer;
+    }
+}
+
+PDBSplitOutputWriter::PDBSplitOutputWriter(const std::filesystem::path& outputDirectory)
+    : m_outputDirectory(outputDirectory)
+{
+}
+
+const std::string& PDBSplitOutputWriter::GetUnitPath(const std::string& unitKey)
+{
+    auto it = m_unitPaths.find(unitKey);
+    if (it != m_unitPaths.end())
+    {
+        return it->second;
+    }
+
+    auto components = SplitScope(unitKey);
+    if (components.empty())
+    {
+        components.push_back("__global__");
+    }
+
+    std::string directory;
+    for (size_t i = 0; i + 1 < components.size(); ++i)
+    {
+        directory += SanitizeComponent(components[i]) + '/';
+    }
+
+    const std::string fileName = SanitizeComponent(components.back());
+    std::string path = directory + fileName + ".h";
+
+    // Different names can sanitize to the same path, and the target file
+    // system is usually case-insensitive.
+    if (m_usedPaths.count(ToLower(path)))
+    {
+        const auto digest = GetDigest(unitKey.data(), unitKey.size());
+        path = directory + fileName + '_' + ToHex(digest, 16) + ".h";
+    }
+
+    m_usedPaths.insert(ToLower(path));
+    return m_unitPaths.emplace(unitKey, std::move(path)).first->second;
+}
+
+void PDBSplitOutputWriter::Write(const std::string& relativePath, std::string content)
+{
+    auto path = m_outputDirectory / std::filesystem::path(relativePath);
+
+    m_writerPool.Submit([this, path = std::move(path), content = std::move(content)]
+    {
+        WriteIfChanged(path, content);
+    });
+}
+
+void PDBSplitOutputWriter::Finish()
+{
+    m_writerPool.Wait();
+}
+
+size_t PDBSplitOutputWriter::GetWrittenFileCount() const
+{
+    return m_writtenFileCount;
+}
+
+size_t PDBSplitOutputWriter::GetUnchangedFileCount() const
+{
+    return m_unchangedFileCount;
+}
+
+std::vector<std::string> PDBSplitOutputWriter::SplitScope(const std::string& symbolName)
+{
+    std::vector<std::string> components;
+
+    int templateDepth = 0;
+    size_t componentStart = 0;
+
+    for (size_t i = 0; i < symbolName.size(); ++i)
+    {
+        switch (symbolName[i])
+        {
+        case '<':
+        case '(':
+            ++templateDepth;
+            break;
+
+        case '>':
+        case ')':
+            --templateDepth;
+            break;
+
+        case ':':
+            if (templateDepth == 0 && i + 1 < symbolName.size() && symbolName[i + 1] == ':')
+            {
+                components.push_back(symbolName.substr(componentStart, i - componentStart));
+                componentStart = i + 2;
+                ++i;
+            }
+            break;
+        }
+    }
+
+    if (componentStart < symbolName.size())
+    {
+        components.push_back(symbolName.substr(componentStart));
+    }
+
+    return components;
+}
+
+std::string PDBSplitOutputWriter::GetNamespace(const std::string& symbolName)
+{
+    auto components = SplitScope(symbolName);
+
+    std::string scope;
+    for (size_t i = 0; i + 1 < components.size(); ++i)
+    {
+        if (!scope.empty())
+        {
+            scope += "::";
+        }
+        scope += components[i];
+    }
+
+    return scope;
+}
+
+uint64_t PDBSplitOutputWriter::GetDigest(const char* data, size_t size)
+{
+    // FNV-1a
+    uint64_t digest = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        digest ^= static_cast<unsigned char>(data[i]);
+        digest *= 0x100000001b3ull;
+    }
+    return digest;
+}
+
+void PDBSplitOutputWriter::WriteIfChanged(const std::filesystem::path& path, const std::string& content)
+{
+    std::error_code errorCode;
+
+    if (std::filesystem::file_size(path, errorCode) == content.size() && !errorCode)
+    {
+        std::ifstream existingFile(path, std::ios::in | std::ios::binary);
+        std::string existingContent(content.size(), '\0');
+
+        if (existingFile.read(existingContent.data(), existingContent.size()) && existingContent == content)
+        {
+            ++m_unchangedFileCount;
+            return;
+        }
+    }
+
+    std::filesystem::create_directories(path.parent_path(), errorCode);
+
+    auto temporaryPath = path;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write " + path.string());
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path);
+    ++m_writtenFileCount;
+}
+
+std::string PDBSplitOutputWriter::SanitizeComponent(const std::string& component)
+{
+    std::string result;
+    result.reserve(component.size());
+
+    for (unsigned char c : component)
+    {
+        result += (std::isalnum(c) || c == '_' || c == '-' || c == '$') ? static_cast<char>(c) : '_';
+    }
+
+    if (result.empty())
+    {
+        result = "_";
+    }
+
+    for (const auto* reservedFileName : ReservedFileNames)
+    {
+        if (ToLower(result) == reservedFileName)
+        {
+            result += '_';
+            break;
+        }
+    }
+
+    if (result.size() > MaximumComponentLength)
+    {
+        const auto digest = GetDigest(component.data(), component.size());
+        result = result.substr(0, MaximumComponentLength - 17) + '_' + ToHex(digest, 16);
+    }
+
+    return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//
+// Writes a tree of headers below an output directory. Every file is
+// written by the writer pool and left untouched when the content on disk
+// is already the same, so build systems only see real changes.
+//
+class PDBSplitOutputWriter
+{
+public:
+    enum class SplitType
+    {
+        PerType,
+        PerNamespace,
+    };
+
+    explicit PDBSplitOutputWriter(const std::filesystem::path& outputDirectory);
+
+    // Maps a unit key (a type name, or a namespace scope when splitting per
+    // namespace) to a unique path relative to the output directory.
+    const std::string& GetUnitPath(const std::string& unitKey);
+
+    void Write(const std::string& relativePath, std::string content);
+    void Finish();
+
+    size_t GetWrittenFileCount() const;
+    size_t GetUnchangedFileCount() const;
+
+    static std::vector<std::string> SplitScope(const std::string& symbolName);
+    static std::string GetNamespace(const std::string& symbolName);
+    static uint64_t GetDigest(const char* data, size_t size);
+
+private:
+    void WriteIfChanged(const std::filesystem::path& path, const std::string& content);
+    static std::string SanitizeComponent(const std::string& component);
+
+private:
+    std::filesystem::path m_outputDirectory;
+
+    std::unordered_map<std::string, std::string> m_unitPaths;
+    std::unordered_set<std::string> m_usedPaths;
+
+    std::atomic<size_t> m_writtenFileCount = 0;
+    std::atomic<size_t> m_unchangedFileCount = 0;
+
+    ThreadPool m_writerPool;
+};
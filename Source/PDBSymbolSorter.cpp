@@ -1,4 +1,5 @@
 #include "PDBSymbolSorter.h"
+#include <algorithm>
 #include <cassert>
 
 std::vector<DWORD>& PDBSymbolSorter::GetSortedSymbolIndexes()
@@ -6,6 +7,14 @@ std::vector<DWORD>& PDBSymbolSorter::GetSortedSymbolIndexes()
     return m_sortedSymbolIndexes;
 }
 
+const std::vector<DWORD>& PDBSymbolSorter::GetSymbolDependencies(DWORD symIndex) const
+{
+    static const std::vector<DWORD> NoDependencies;
+
+    auto it = m_dependencies.find(symIndex);
+    return it == m_dependencies.end() ? NoDependencies : it->second;
+}
+
 PDBSymbolSorterBase::ImageArchitecture PDBSymbolSorter::GetImageArchitecture() const
 {
     return m_architecture;
@@ -17,10 +26,15 @@ void PDBSymbolSorter::Clear()
 
     m_visitedUdts.clear();
     m_sortedSymbolIndexes.clear();
+    m_sortedSymbolIndexSet.clear();
+    m_dependencies.clear();
+    m_visitStack.clear();
 }
 
 void PDBSymbolSorter::VisitEnumType(const Symbol& symbol)
 {
+    AddDependency(symbol);
+
     if (HasBeenVisited(symbol))
     {
         return;
@@ -50,12 +64,16 @@ void PDBSymbolSorter::VisitPointerType(const Symbol& symbol)
 
 void PDBSymbolSorter::VisitUdt(const Symbol& symbol)
 {
+    AddDependency(symbol);
+
     if (HasBeenVisited(symbol))
     {
         return;
     }
 
+    m_visitStack.push_back(symbol.symIndexId);
     PDBSymbolVisitorBase::VisitUdt(symbol);
+    m_visitStack.pop_back();
 
     AddSymbol(symbol);
 }
@@ -74,8 +92,6 @@ void PDBSymbolSorter::VisitFunctionArg(const SymbolFunctionArg& functionArg)
 
 bool PDBSymbolSorter::HasBeenVisited(const Symbol& symbol)
 {
-    static DWORD UnnamedCounter = 0;
-
     auto key = symbol.name;
     if (m_visitedUdts.find(key) != m_visitedUdts.end())
     {
@@ -84,7 +100,7 @@ bool PDBSymbolSorter::HasBeenVisited(const Symbol& symbol)
 
     if (PDB::IsUnnamedSymbol(symbol))
     {
-        key += std::to_string(++UnnamedCounter);
+        key += std::to_string(++m_unnamedCounter);
     }
 
     m_visitedUdts.emplace(std::move(key), symbol.symIndexId);
@@ -93,8 +109,32 @@ bool PDBSymbolSorter::HasBeenVisited(const Symbol& symbol)
 
 void PDBSymbolSorter::AddSymbol(const Symbol& symbol)
 {
-    if (std::find(m_sortedSymbolIndexes.begin(), m_sortedSymbolIndexes.end(), symbol.symIndexId) == m_sortedSymbolIndexes.end())
+    if (m_sortedSymbolIndexSet.insert(symbol.symIndexId).second)
     {
         m_sortedSymbolIndexes.push_back(symbol.symIndexId);
     }
 }
+
+void PDBSymbolSorter::AddDependency(const Symbol& symbol)
+{
+    if (m_visitStack.empty())
+    {
+        return;
+    }
+
+    // Named types are emitted once, under the index that was seen first.
+    auto visitedIt = m_visitedUdts.find(symbol.name);
+    const DWORD symIndex = visitedIt == m_visitedUdts.end() ? symbol.symIndexId : visitedIt->second;
+
+    const DWORD dependentSymIndex = m_visitStack.back();
+    if (symIndex == dependentSymIndex)
+    {
+        return;
+    }
+
+    auto& dependencies = m_dependencies[dependentSymIndex];
+    if (std::find(dependencies.begin(), dependencies.end(), symIndex) == dependencies.end())
+    {
+        dependencies.push_back(symIndex);
+    }
+}
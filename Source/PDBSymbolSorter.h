@@ -3,11 +3,14 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 class PDBSymbolSorter : public PDBSymbolSorterBase
 {
 public:
     std::vector<DWORD>& GetSortedSymbolIndexes() override;
+    const std::vector<DWORD>& GetSymbolDependencies(DWORD symIndex) const override;
     ImageArchitecture GetImageArchitecture() const override;
     void Clear() override;
 
@@ -21,9 +24,16 @@ protected:
 private:
     bool HasBeenVisited(const Symbol& symbol);
     void AddSymbol(const Symbol& symbol);
+    void AddDependency(const Symbol& symbol);
 
 private:
     ImageArchitecture m_architecture = ImageArchitecture::None;
     std::map<std::string, DWORD> m_visitedUdts;
+    DWORD m_unnamedCounter = 0;
     std::vector<DWORD> m_sortedSymbolIndexes;
+    std::unordered_set<DWORD> m_sortedSymbolIndexSet;
+
+    // Edges from an enum/UDT to the enums/UDTs it needs complete (by value).
+    std::unordered_map<DWORD, std::vector<DWORD>> m_dependencies;
+    std::vector<DWORD> m_visitStack;
 };
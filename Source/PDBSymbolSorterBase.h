@@ -14,6 +14,7 @@ public:
     };
 
     virtual	std::vector<DWORD>& GetSortedSymbolIndexes() = 0;
+    virtual	const std::vector<DWORD>& GetSymbolDependencies(DWORD symIndex) const = 0;
     virtual	ImageArchitecture GetImageArchitecture() const = 0;
     virtual	void Clear() = 0;
 };
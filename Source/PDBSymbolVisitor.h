@@ -6,11 +6,18 @@
 #include <memory>
 #include <stack>
 
-template <typename MEMBER_DEFINITION_TYPE>
-class PDBSymbolVisitor : public PDBSymbolVisitorBase
+//
+// RECONSTRUCTOR_TYPE defaults to the polymorphic PDBReconstructorBase. Passing
+// a final reconstructor class instead lets every event call resolve statically.
+//
+// PDBSymbolVisitorBase is only the entry point: the visitor is final and walks
+// the symbol graph itself, so the traversal makes no virtual calls of its own.
+//
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE = PDBReconstructorBase>
+class PDBSymbolVisitor final : public PDBSymbolVisitorBase
 {
 public:
-    PDBSymbolVisitor(PDBReconstructorBase* reconstructVisitor);
+    PDBSymbolVisitor(RECONSTRUCTOR_TYPE* reconstructVisitor);
     void Run(const Symbol& symbol);
 
 protected:
@@ -77,16 +84,18 @@ private:
     };
 
     using AnonymousUdtStack = std::stack<std::shared_ptr<AnonymousUdt>>;
-    using ContextStack = std::stack<std::shared_ptr<UdtFieldDefinitionBase>>;
+    using ContextStack = std::stack<std::shared_ptr<MEMBER_DEFINITION_TYPE>>;
 
 private:
+    void VisitUdtFields(const SymbolUdt& symbolUdt);
+
     void CheckForDataFieldPadding(const SymbolUdtField* udtField);
     void CheckForBitFieldFieldPadding(const SymbolUdtField* udtField);
     void CheckForAnonymousUnion(const SymbolUdtField* udtField);
     void CheckForAnonymousStruct(const SymbolUdtField* udtField);
     void CheckForEndOfAnonymousUdt(const SymbolUdtField* udtField);
 
-    std::shared_ptr<UdtFieldDefinitionBase> MemberDefinitionFactory();
+    std::shared_ptr<MEMBER_DEFINITION_TYPE> MemberDefinitionFactory();
 
     void PushAnonymousUdt(std::shared_ptr<AnonymousUdt> item);
     void PopAnonymousUdt();
@@ -104,7 +113,7 @@ private:
     AnonymousUdtStack m_anonymousStructStack;
     BitFieldRange m_currentBitField;
     ContextStack m_memberContextStack;
-    PDBReconstructorBase* m_reconstructVisitor;
+    RECONSTRUCTOR_TYPE* m_reconstructVisitor;
 };
 
 #include "PDBSymbolVisitor.inl"
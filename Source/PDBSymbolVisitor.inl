@@ -6,32 +6,76 @@
 #include <memory>
 #include <stack>
 
-template <typename MEMBER_DEFINITION_TYPE>
-PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::PDBSymbolVisitor(PDBReconstructorBase* ReconstructVisitor) :
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::PDBSymbolVisitor(RECONSTRUCTOR_TYPE* ReconstructVisitor) :
     m_reconstructVisitor(ReconstructVisitor)
 {
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::Run(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::Run(const Symbol& symbol)
 {
-    Visit(symbol);
+    PDBSymbolVisitor::Visit(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::Visit(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::Visit(const Symbol& symbol)
 {
-    PDBSymbolVisitorBase::Visit(symbol);
+    //
+    // The traversal mirrors PDBSymbolVisitorBase, but every call is qualified
+    // so that it binds to this class statically instead of going through the
+    // vtable for each symbol and field.
+    //
+
+    switch (symbol.tag)
+    {
+    case SymTagBaseType:
+        PDBSymbolVisitor::VisitBaseType(symbol);
+        break;
+
+    case SymTagEnum:
+        PDBSymbolVisitor::VisitEnumType(symbol);
+        break;
+
+    case SymTagTypedef:
+        PDBSymbolVisitor::VisitTypedefType(symbol);
+        break;
+
+    case SymTagPointerType:
+        PDBSymbolVisitor::VisitPointerType(symbol);
+        break;
+
+    case SymTagArrayType:
+        PDBSymbolVisitor::VisitArrayType(symbol);
+        break;
+
+    case SymTagFunction:
+    case SymTagFunctionType:
+        PDBSymbolVisitor::VisitFunctionType(symbol);
+        break;
+
+    case SymTagFunctionArgType:
+        PDBSymbolVisitor::VisitFunctionArgType(symbol);
+        break;
+
+    case SymTagUDT:
+        PDBSymbolVisitor::VisitUdt(symbol);
+        break;
+
+    default:
+        PDBSymbolVisitor::VisitOtherType(symbol);
+        break;
+    }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitBaseType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitBaseType(const Symbol& symbol)
 {
     m_memberContextStack.top()->VisitBaseType(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitEnumType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitEnumType(const Symbol& symbol)
 {
     if (m_memberContextStack.size())
     {
@@ -41,53 +85,78 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitEnumType(const Symbol& symbo
         if (m_reconstructVisitor->OnEnumType(symbol))
         {
             m_reconstructVisitor->OnEnumTypeBegin(symbol);
-            PDBSymbolVisitorBase::VisitEnumType(symbol);
+            for (const auto& enumField : std::get<SymbolEnum>(symbol.variant).fields)
+            {
+                PDBSymbolVisitor::VisitEnumField(enumField);
+            }
             m_reconstructVisitor->OnEnumTypeEnd(symbol);
         }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitTypedefType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitTypedefType(const Symbol& symbol)
 {
+    const auto& symbolTypedef = std::get<SymbolTypedef>(symbol.variant);
+
     m_memberContextStack.top()->VisitTypedefTypeBegin(symbol);
-    PDBSymbolVisitorBase::VisitTypedefType(symbol);
+    assert(symbolTypedef.type);
+    PDBSymbolVisitor::Visit(*symbolTypedef.type);
     m_memberContextStack.top()->VisitTypedefTypeEnd(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitPointerType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitPointerType(const Symbol& symbol)
 {
+    const auto& symbolPointer = std::get<SymbolPointer>(symbol.variant);
+
     m_memberContextStack.top()->VisitPointerTypeBegin(symbol);
-    PDBSymbolVisitorBase::VisitPointerType(symbol);
+    assert(symbolPointer.type);
+    PDBSymbolVisitor::Visit(*symbolPointer.type);
     m_memberContextStack.top()->VisitPointerTypeEnd(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitArrayType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitArrayType(const Symbol& symbol)
 {
+    const auto& symbolArray = std::get<SymbolArray>(symbol.variant);
+
     m_memberContextStack.top()->VisitArrayTypeBegin(symbol);
-    PDBSymbolVisitorBase::VisitArrayType(symbol);
+    assert(symbolArray.elementType);
+    PDBSymbolVisitor::Visit(*symbolArray.elementType);
     m_memberContextStack.top()->VisitArrayTypeEnd(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitFunctionType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitFunctionType(const Symbol& symbol)
 {
+    const auto& symbolFunction = std::get<SymbolFunction>(symbol.variant);
+
     m_memberContextStack.top()->VisitFunctionTypeBegin(symbol);
-    PDBSymbolVisitorBase::VisitFunctionType(symbol);
+    for (const auto& argument : symbolFunction.arguments)
+    {
+        PDBSymbolVisitor::VisitFunctionArg(argument);
+    }
+
+    if (symbolFunction.returnType)
+    {
+        PDBSymbolVisitor::Visit(*symbolFunction.returnType);
+    }
     m_memberContextStack.top()->VisitFunctionTypeEnd(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitFunctionArgType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitFunctionArgType(const Symbol& symbol)
 {
+    const auto& symbolFunctionArg = std::get<SymbolFunctionArgType>(symbol.variant);
+
     m_memberContextStack.top()->VisitFunctionArgTypeBegin(symbol);
-    PDBSymbolVisitorBase::VisitFunctionArgType(symbol);
+    assert(symbolFunctionArg.type);
+    PDBSymbolVisitor::Visit(*symbolFunctionArg.type);
     m_memberContextStack.top()->VisitFunctionArgTypeEnd(symbol);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdt(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitUdt(const Symbol& symbol)
 {
     if (!PDB::IsUnnamedSymbol(symbol) && m_memberContextStack.size())
     {
@@ -107,7 +176,7 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdt(const Symbol& symbol)
                 m_memberContextStack.push(MemberDefinitionFactory());
 
                 m_reconstructVisitor->OnUdtBegin(symbol);
-                PDBSymbolVisitorBase::VisitUdt(symbol);
+                VisitUdtFields(std::get<SymbolUdt>(symbol.variant));
                 m_reconstructVisitor->OnUdtEnd(symbol);
 
                 m_memberContextStack.pop();
@@ -119,20 +188,48 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdt(const Symbol& symbol)
     }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitOtherType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitUdtFields(const SymbolUdt& symbolUdt)
+{
+    //
+    // Runs of bit fields are visited as one group, ending on the last bit
+    // field of the run.
+    //
+
+    const auto endOfUdtFieldIt = symbolUdt.fields.end();
+    for (auto udtFieldIt = symbolUdt.fields.begin(); udtFieldIt != endOfUdtFieldIt; ++udtFieldIt)
+    {
+        if (udtFieldIt->bits == 0)
+        {
+            PDBSymbolVisitor::VisitUdtField(*udtFieldIt);
+            PDBSymbolVisitor::VisitUdtFieldEnd(*udtFieldIt);
+        }
+        else
+        {
+            do
+            {
+                PDBSymbolVisitor::VisitUdtField(*udtFieldIt);
+            } while (++udtFieldIt != endOfUdtFieldIt && udtFieldIt->bitPosition != 0);
+
+            PDBSymbolVisitor::VisitUdtFieldBitFieldEnd(*(--udtFieldIt));
+        }
+    }
+}
+
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitOtherType(const Symbol& symbol)
 {
 
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitEnumField(const SymbolEnumField& EnumField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitEnumField(const SymbolEnumField& EnumField)
 {
     m_reconstructVisitor->OnEnumField(EnumField);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtField(const SymbolUdtField& udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitUdtField(const SymbolUdtField& udtField)
 {
     BOOL IsBitFieldMember = udtField.bits != 0;
     BOOL IsFirstBitFieldMember = IsBitFieldMember && !m_previousBitFieldField;
@@ -165,7 +262,7 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtField(const SymbolUdtFiel
     }
 
     m_reconstructVisitor->OnUdtFieldBegin(udtField);
-    Visit(*udtField.type);
+    PDBSymbolVisitor::Visit(*udtField.type);
     m_reconstructVisitor->OnUdtField(udtField, *m_memberContextStack.top().get());
     m_reconstructVisitor->OnUdtFieldEnd(udtField);
 
@@ -177,14 +274,14 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtField(const SymbolUdtFiel
     }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtFieldEnd(const SymbolUdtField& udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitUdtFieldEnd(const SymbolUdtField& udtField)
 {
     CheckForEndOfAnonymousUdt(&udtField);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtFieldBitFieldEnd(const SymbolUdtField& udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitUdtFieldBitFieldEnd(const SymbolUdtField& udtField)
 {
     assert(m_currentBitField.HasValue() == true);
     //assert(m_currentBitField.last == udtField);
@@ -193,21 +290,21 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitUdtFieldBitFieldEnd(const Sy
 
     m_currentBitField.Clear();
 
-    VisitUdtFieldEnd(udtField);
+    PDBSymbolVisitor::VisitUdtFieldEnd(udtField);
 
     m_previousBitFieldField = nullptr;
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::VisitFunctionArg(const SymbolFunctionArg& functionArg)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::VisitFunctionArg(const SymbolFunctionArg& functionArg)
 {
     m_memberContextStack.top()->SetMemberName(functionArg.name);
     assert(functionArg.type);
-    Visit(*functionArg.type);
+    PDBSymbolVisitor::Visit(*functionArg.type);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForDataFieldPadding(const SymbolUdtField* udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::CheckForDataFieldPadding(const SymbolUdtField* udtField)
 {
     UdtFieldContext UdtFieldCtx(udtField);
     DWORD PreviousUdtFieldOffset = 0;
@@ -243,8 +340,8 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForDataFieldPadding(const Sy
     }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForBitFieldFieldPadding(const SymbolUdtField* udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::CheckForBitFieldFieldPadding(const SymbolUdtField* udtField)
 {
     BOOL WasPreviousBitFieldMember = m_previousBitFieldField ? m_previousBitFieldField->bits != 0 : FALSE;
 
@@ -258,8 +355,8 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForBitFieldFieldPadding(cons
     }
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForAnonymousUnion(const SymbolUdtField* udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::CheckForAnonymousUnion(const SymbolUdtField* udtField)
 {
     UdtFieldContext UdtFieldCtx(udtField);
     if (UdtFieldCtx.IsLast())
@@ -290,8 +387,8 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForAnonymousUnion(const Symb
     } while (UdtFieldCtx.GetNext());
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForAnonymousStruct(const SymbolUdtField* udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::CheckForAnonymousStruct(const SymbolUdtField* udtField)
 {
     UdtFieldContext UdtFieldCtx(udtField);
     if (UdtFieldCtx.IsLast())
@@ -331,8 +428,8 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForAnonymousStruct(const Sym
     } while (UdtFieldCtx.GetNext());
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForEndOfAnonymousUdt(const SymbolUdtField* udtField)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::CheckForEndOfAnonymousUdt(const SymbolUdtField* udtField)
 {
     m_previousUdtField = ((udtField->tag == SymTagData
                            || udtField->tag == SymTagBaseClass
@@ -420,15 +517,15 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::CheckForEndOfAnonymousUdt(const S
     } while (LastAnonymousUdt == nullptr && !m_anonymousUdtStack.empty());
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-std::shared_ptr<UdtFieldDefinitionBase> PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::MemberDefinitionFactory()
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+std::shared_ptr<MEMBER_DEFINITION_TYPE> PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::MemberDefinitionFactory()
 {
     auto MemberDefinition = std::make_shared<MEMBER_DEFINITION_TYPE>();
     return MemberDefinition;
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::PushAnonymousUdt(std::shared_ptr<AnonymousUdt> item)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::PushAnonymousUdt(std::shared_ptr<AnonymousUdt> item)
 {
     m_anonymousUdtStack.push(item);
     if (item->kind == UdtUnion)
@@ -436,8 +533,8 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::PushAnonymousUdt(std::shared_ptr<
     else	m_anonymousStructStack.push(item);
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::PopAnonymousUdt()
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::PopAnonymousUdt()
 {
     if (m_anonymousUdtStack.top()->kind == UdtUnion)
         m_anonymousUnionStack.pop();
@@ -445,9 +542,9 @@ void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::PopAnonymousUdt()
     m_anonymousUdtStack.pop();
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
 const SymbolUdtField*
-PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::GetNextUdtFieldWithRespectToBitFields(const SymbolUdtField* udtField)
+PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::GetNextUdtFieldWithRespectToBitFields(const SymbolUdtField* udtField)
 {
     const SymbolUdtField* nextUdtField = udtField;
 
@@ -462,14 +559,14 @@ PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::GetNextUdtFieldWithRespectToBitFields(
     return nextUdtField;
 }
 
-template <typename MEMBER_DEFINITION_TYPE>
-bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::Is64BitBasicType(const Symbol& symbol)
+template <typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::Is64BitBasicType(const Symbol& symbol)
 {
     return (symbol.tag == SymTagBaseType && symbol.size == 8);
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::AnonymousUdt::AnonymousUdt(UdtKind kind, const SymbolUdtField* first, const SymbolUdtField* last, DWORD size, DWORD memberCount)
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::AnonymousUdt::AnonymousUdt(UdtKind kind, const SymbolUdtField* first, const SymbolUdtField* last, DWORD size, DWORD memberCount)
 {
     this->kind = kind;
     this->first = first;
@@ -478,27 +575,27 @@ PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::AnonymousUdt::AnonymousUdt(UdtKind kin
     this->memberCount = memberCount;
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::BitFieldRange::BitFieldRange() : first(nullptr), last(nullptr)
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::BitFieldRange::BitFieldRange() : first(nullptr), last(nullptr)
 {
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::BitFieldRange::Clear()
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+void PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::BitFieldRange::Clear()
 {
     first = nullptr;
     last = nullptr;
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::BitFieldRange::HasValue() const
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::BitFieldRange::HasValue() const
 {
     return /*First != nullptr &&*/
         last != nullptr;
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::UdtFieldContext::UdtFieldContext(const SymbolUdtField* udtField, BOOL respectBitFields)
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::UdtFieldContext::UdtFieldContext(const SymbolUdtField* udtField, BOOL respectBitFields)
 {
     this->udtField = udtField;
 
@@ -514,20 +611,20 @@ PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::UdtFieldContext::UdtFieldContext(const
     }
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::UdtFieldContext::IsFirst() const
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::UdtFieldContext::IsFirst() const
 {
     return previousUdtField < std::get<SymbolUdt>(udtField->parent->variant).FieldFirst();
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::UdtFieldContext::IsLast() const
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::UdtFieldContext::IsLast() const
 {
     return nextUdtField == std::get<SymbolUdt>(udtField->parent->variant).FieldLast();
 }
 
-template<typename MEMBER_DEFINITION_TYPE>
-bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE>::UdtFieldContext::GetNext()
+template<typename MEMBER_DEFINITION_TYPE, typename RECONSTRUCTOR_TYPE>
+bool PDBSymbolVisitor<MEMBER_DEFINITION_TYPE, RECONSTRUCTOR_TYPE>::UdtFieldContext::GetNext()
 {
     previousUdtField = currentUdtField;
     currentUdtField = nextUdtField;
@@ -0,0 +1,99 @@
+#include "UnixSocket.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//
+// Sends queries to a running "pdbex <path> -S <socket>" server:
+//   pdbex_query <socket> <query...>      one query from the command line
+//   pdbex_query <socket>                 one query per line from stdin
+//
+// Payloads go to stdout, errors to stderr; the exit code is 1 if any query
+// failed.
+//
+
+namespace
+{
+    bool SendQuery(UnixSocket& socket, const std::string& query, bool& failed)
+    {
+        std::string status;
+        if (!socket.Write(query + '\n') || !socket.ReadLine(status))
+        {
+            return false;
+        }
+
+        if (status.compare(0, 3, "OK ") == 0)
+        {
+            std::string payload;
+            if (!socket.Read(payload, strtoull(status.c_str() + 3, nullptr, 10)))
+            {
+                return false;
+            }
+
+            std::cout << payload;
+        }
+        else
+        {
+            std::cerr << (status.compare(0, 4, "ERR ") == 0 ? status.substr(4) : status) << std::endl;
+            failed = true;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <socket> [query]" << std::endl;
+        return 1;
+    }
+
+    UnixSocket socket;
+    if (!socket.Connect(argv[1]))
+    {
+        std::cerr << "Cannot connect to " << argv[1] << std::endl;
+        return 1;
+    }
+
+    bool failed = false;
+
+    if (argc > 2)
+    {
+        std::string query = argv[2];
+        for (int i = 3; i < argc; ++i)
+        {
+            query += ' ';
+            query += argv[i];
+        }
+
+        if (!SendQuery(socket, query, failed))
+        {
+            std::cerr << "Connection lost" << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::string query;
+        while (std::getline(std::cin, query))
+        {
+            if (query.empty())
+            {
+                continue;
+            }
+
+            if (!SendQuery(socket, query, failed))
+            {
+                std::cerr << "Connection lost" << std::endl;
+                return 1;
+            }
+
+            std::cout.flush();
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+#include "SymbolAddressIndex.h"
+
+#include <algorithm>
+#include <bit>
+
+void SymbolAddressIndex::Build(SymbolModule& module)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_built)
+    {
+        return;
+    }
+
+    module.ForEachPublicSymbol([this](const SymbolPublic& publicSymbol)
+    {
+        // Absolute symbols have no place in the image.
+        if (publicSymbol.rva == 0)
+        {
+            return;
+        }
+
+        m_entries.push_back({
+            publicSymbol.rva,
+            publicSymbol.section,
+            publicSymbol.offset,
+            publicSymbol.length,
+            static_cast<uint32_t>(m_names.size()),
+            static_cast<uint32_t>(publicSymbol.name.size()) });
+
+        m_names += publicSymbol.name;
+    });
+
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs)
+    {
+        return lhs.rva < rhs.rva;
+    });
+
+    // Aliases of one address resolve to the first name seen.
+    m_entries.erase(std::unique(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs)
+    {
+        return lhs.rva == rhs.rva;
+    }), m_entries.end());
+
+    m_eytzinger.resize(m_entries.size() + 1);
+    m_eytzingerEntries.resize(m_entries.size() + 1);
+
+    size_t sortedIndex = 0;
+    BuildEytzinger(sortedIndex, 1);
+
+    m_built = true;
+}
+
+void SymbolAddressIndex::Symbolize(const std::vector<DWORD>& rvas, std::vector<SymbolAddress>& addresses) const
+{
+    addresses.resize(rvas.size());
+
+    for (size_t i = 0; i < rvas.size(); ++i)
+    {
+        auto& address = addresses[i];
+        address = SymbolAddress();
+
+        const ptrdiff_t entryIndex = FindEntry(rvas[i]);
+        if (entryIndex < 0)
+        {
+            continue;
+        }
+
+        const auto& entry = m_entries[entryIndex];
+        const DWORD displacement = rvas[i] - entry.rva;
+
+        if (entry.length != 0 && displacement >= entry.length)
+        {
+            continue;
+        }
+
+        address.name = std::string_view(m_names.data() + entry.nameOffset, entry.nameLength);
+        address.section = entry.section;
+        address.offset = entry.offset + displacement;
+        address.displacement = displacement;
+    }
+}
+
+void SymbolAddressIndex::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_built = false;
+    m_entries.clear();
+    m_names.clear();
+    m_eytzinger.clear();
+    m_eytzingerEntries.clear();
+}
+
+void SymbolAddressIndex::BuildEytzinger(size_t& sortedIndex, size_t node)
+{
+    // In-order traversal of the implicit tree visits the entries in
+    // sorted order.
+    if (node >= m_eytzinger.size())
+    {
+        return;
+    }
+
+    BuildEytzinger(sortedIndex, 2 * node);
+
+    m_eytzinger[node] = m_entries[sortedIndex].rva;
+    m_eytzingerEntries[node] = static_cast<uint32_t>(sortedIndex);
+    ++sortedIndex;
+
+    BuildEytzinger(sortedIndex, 2 * node + 1);
+}
+
+ptrdiff_t SymbolAddressIndex::FindEntry(DWORD rva) const
+{
+    const size_t count = m_entries.size();
+
+    size_t node = 1;
+    while (node <= count)
+    {
+        node = 2 * node + (m_eytzinger[node] <= rva);
+    }
+
+    // Undo the right turns taken after the last left turn; that left turn
+    // was at the first RVA above rva. No left turn leaves node at 0.
+    node >>= std::countr_one(node) + 1;
+
+    const size_t upperBound = node == 0 ? count : m_eytzingerEntries[node];
+    return static_cast<ptrdiff_t>(upperBound) - 1;
+}
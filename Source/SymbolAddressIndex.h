@@ -0,0 +1,59 @@
+#pragma once
+#include "PDB.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// RVA -> public symbol lookups for symbolizing large batches of addresses,
+// such as profiler samples.
+//
+// Public symbols are kept in a flat array sorted by RVA, with their names
+// in one string pool. Lookups search a copy of the RVAs in Eytzinger
+// (breadth-first) order: the search walks down an implicit binary tree
+// with one branch-free step per level, and the top levels stay in cache
+// across a batch.
+//
+// An RVA resolves to the closest public symbol at or below it. Symbols
+// with a known length only cover that many bytes.
+//
+class SymbolAddressIndex
+{
+public:
+    // Reads the public symbols unless they are read already. After that,
+    // lookups may run concurrently.
+    void Build(SymbolModule& module);
+
+    void Symbolize(const std::vector<DWORD>& rvas, std::vector<SymbolAddress>& addresses) const;
+
+    void Clear();
+
+private:
+    struct Entry
+    {
+        DWORD rva;
+        DWORD section;
+        DWORD offset;
+        DWORD length;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    void BuildEytzinger(size_t& sortedIndex, size_t node);
+
+    // Index into m_entries of the last entry with an RVA <= rva, or -1.
+    ptrdiff_t FindEntry(DWORD rva) const;
+
+private:
+    std::mutex m_mutex;
+    bool m_built = false;
+
+    std::vector<Entry> m_entries;
+    std::string m_names;
+
+    // 1-based implicit tree over the entry RVAs, and the entry index of
+    // every tree node.
+    std::vector<DWORD> m_eytzinger;
+    std::vector<uint32_t> m_eytzingerEntries;
+};
@@ -0,0 +1,361 @@
+#include "SymbolDumpDecoder.h"
+#include "PDBJsonReconstructor.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // A leaf is selected by its own path or by the path of a member or
+    // array it is part of.
+    bool IsSelected(const std::string& path, const std::vector<std::string>& fieldPaths)
+    {
+        for (const auto& fieldPath : fieldPaths)
+        {
+            if (path.compare(0, fieldPath.size(), fieldPath) != 0)
+            {
+                continue;
+            }
+
+            const size_t length = fieldPath.size();
+            if (path.size() == length || path[length] == '.' || path[length] == '[')
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool GetValueKind(const Symbol& type, SymbolDumpFieldKind& kind)
+    {
+        switch (type.baseType)
+        {
+        case btChar:
+        case btInt:
+        case btLong:
+        case btHresult:
+            kind = SymbolDumpFieldKind::Signed;
+            return true;
+
+        case btWChar:
+        case btUInt:
+        case btULong:
+        case btChar8:
+        case btChar16:
+        case btChar32:
+            kind = SymbolDumpFieldKind::Unsigned;
+            return true;
+
+        case btBool:
+            kind = SymbolDumpFieldKind::Bool;
+            return true;
+
+        case btFloat:
+            kind = SymbolDumpFieldKind::Float;
+            return type.size == sizeof(float) || type.size == sizeof(double);
+
+        case btNoType:
+            // Enums without an underlying type are ints.
+            kind = SymbolDumpFieldKind::Signed;
+            return type.tag == SymTagEnum;
+
+        default:
+            return false;
+        }
+    }
+
+    template<typename T>
+    void AppendNumber(std::string& output, T value, int base = 10)
+    {
+        char text[32];
+        output.append(text, std::to_chars(text, text + sizeof(text), value, base).ptr);
+    }
+
+    template<typename T>
+    void AppendFloat(std::string& output, T value, bool isJson)
+    {
+        // JSON has no literals for NaN or infinities.
+        if (isJson && !std::isfinite(value))
+        {
+            output += "null";
+            return;
+        }
+
+        char text[32];
+        output.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    }
+}
+
+SymbolDumpDecoder::SymbolDumpDecoder(const Symbol& udt, SymbolDumpFormat format, const std::vector<std::string>& fieldPaths)
+    : m_size(udt.size)
+    , m_format(format)
+{
+    std::string path;
+    AddMembers(udt, 0, path);
+
+    if (!fieldPaths.empty())
+    {
+        std::erase_if(m_fields, [&fieldPaths](const SymbolDumpField& field)
+        {
+            return !IsSelected(field.path, fieldPaths);
+        });
+    }
+
+    m_keys.reserve(m_fields.size());
+
+    for (const auto& field : m_fields)
+    {
+        std::string key;
+
+        if (m_format == SymbolDumpFormat::Json)
+        {
+            key += ',';
+            PDBJsonReconstructor::AppendString(key, field.path);
+            key += ':';
+        }
+        else
+        {
+            key += ' ';
+            key += field.path;
+            key += '=';
+        }
+
+        m_keys.push_back(std::move(key));
+    }
+}
+
+DWORD SymbolDumpDecoder::GetSize() const
+{
+    return m_size;
+}
+
+const std::vector<SymbolDumpField>& SymbolDumpDecoder::GetFields() const
+{
+    return m_fields;
+}
+
+void SymbolDumpDecoder::Decode(const SymbolDumpImage& image, const uint64_t* addresses, size_t count, std::string& output) const
+{
+    const bool isJson = m_format == SymbolDumpFormat::Json;
+
+    // Only instances spanning ranges are copied out of the dump.
+    std::vector<uint8_t> buffer(m_size);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64_t address = addresses[i];
+
+        const uint8_t* data = image.GetPointer(address, m_size);
+        if (!data && image.Read(address, buffer.data(), buffer.size()))
+        {
+            data = buffer.data();
+        }
+
+        output += isJson ? "{\"address\":\"0x" : "0x";
+        AppendNumber(output, address, 16);
+
+        if (isJson)
+        {
+            output += '"';
+        }
+
+        if (!data)
+        {
+            output += isJson ? ",\"unreadable\":true" : " unreadable";
+        }
+        else
+        {
+            for (size_t j = 0; j < m_fields.size(); ++j)
+            {
+                output += m_keys[j];
+                AppendValue(m_fields[j], data, output);
+            }
+        }
+
+        output += isJson ? "}\n" : "\n";
+    }
+}
+
+void SymbolDumpDecoder::AddMembers(const Symbol& udt, DWORD baseOffset, std::string& path)
+{
+    const auto& symbolUdt = std::get<SymbolUdt>(udt.variant);
+    const size_t pathLength = path.size();
+
+    for (const auto& udtField : symbolUdt.fields)
+    {
+        if (!udtField.type)
+        {
+            continue;
+        }
+
+        // Virtual bases live wherever the most derived type puts them.
+        if (udtField.isBaseClass && PDB::IsVirtualBaseClass(symbolUdt, udtField))
+        {
+            continue;
+        }
+
+        const bool isData = udtField.tag == SymTagData && udtField.dataKind != DataIsStaticMember;
+        if (!udtField.isBaseClass && !isData)
+        {
+            continue;
+        }
+
+        const auto& name = udtField.isBaseClass ? udtField.type->name : udtField.name;
+
+        path.resize(pathLength);
+        if (pathLength != 0 && !name.empty())
+        {
+            path += '.';
+        }
+        path += name;
+
+        AddValue(*udtField.type, baseOffset + udtField.offset, udtField.bits, udtField.bitPosition, path);
+    }
+
+    path.resize(pathLength);
+}
+
+void SymbolDumpDecoder::AddValue(const Symbol& type, DWORD offset, DWORD bits, DWORD bitPosition, std::string& path)
+{
+    const Symbol* resolvedType = PDB::StripTypedefs(&type);
+    if (!resolvedType)
+    {
+        return;
+    }
+
+    SymbolDumpFieldKind kind;
+
+    switch (resolvedType->tag)
+    {
+    case SymTagUDT:
+        AddMembers(*resolvedType, offset, path);
+        return;
+
+    case SymTagArrayType:
+    {
+        const Symbol* elementType = PDB::StripTypedefs(std::get<SymbolArray>(resolvedType->variant).elementType.get());
+        if (!elementType || elementType->size == 0)
+        {
+            return;
+        }
+
+        const DWORD elementSize = elementType->size;
+        const DWORD elementCount = (std::min)(resolvedType->size / elementSize, ArrayElementLimit);
+        const size_t pathLength = path.size();
+
+        for (DWORD i = 0; i < elementCount; ++i)
+        {
+            path.resize(pathLength);
+            path += '[';
+            path += std::to_string(i);
+            path += ']';
+
+            AddValue(*elementType, offset + i * elementSize, 0, 0, path);
+        }
+
+        path.resize(pathLength);
+        return;
+    }
+
+    case SymTagPointerType:
+        kind = SymbolDumpFieldKind::Pointer;
+        break;
+
+    case SymTagEnum:
+    case SymTagBaseType:
+        if (!GetValueKind(*resolvedType, kind))
+        {
+            return;
+        }
+        break;
+
+    default:
+        return;
+    }
+
+    const DWORD size = resolvedType->size;
+    if (size == 0 || size > sizeof(uint64_t) || offset + size > m_size || bitPosition >= 64)
+    {
+        return;
+    }
+
+    SymbolDumpField field;
+    field.path = path;
+    field.offset = offset;
+    field.size = size;
+    field.bits = bits;
+    field.bitPosition = bits != 0 ? bitPosition : 0;
+    field.kind = kind;
+
+    m_fields.push_back(std::move(field));
+}
+
+void SymbolDumpDecoder::AppendValue(const SymbolDumpField& field, const uint8_t* data, std::string& output) const
+{
+    // Dumps of the images PDBs describe are little endian, as is the host.
+    uint64_t value = 0;
+    memcpy(&value, data + field.offset, field.size);
+
+    const DWORD valueBits = field.bits != 0 ? field.bits : field.size * 8;
+
+    if (field.bits != 0)
+    {
+        value >>= field.bitPosition;
+    }
+
+    if (valueBits < 64)
+    {
+        value &= (uint64_t{ 1 } << valueBits) - 1;
+    }
+
+    const bool isJson = m_format == SymbolDumpFormat::Json;
+
+    switch (field.kind)
+    {
+    case SymbolDumpFieldKind::Unsigned:
+        AppendNumber(output, value);
+        break;
+
+    case SymbolDumpFieldKind::Signed:
+        if (valueBits < 64 && (value >> (valueBits - 1)) != 0)
+        {
+            value |= ~((uint64_t{ 1 } << valueBits) - 1);
+        }
+
+        AppendNumber(output, static_cast<int64_t>(value));
+        break;
+
+    case SymbolDumpFieldKind::Float:
+        if (field.size == sizeof(float))
+        {
+            float floatValue;
+            memcpy(&floatValue, &value, sizeof(floatValue));
+            AppendFloat(output, floatValue, isJson);
+        }
+        else
+        {
+            double doubleValue;
+            memcpy(&doubleValue, &value, sizeof(doubleValue));
+            AppendFloat(output, doubleValue, isJson);
+        }
+        break;
+
+    case SymbolDumpFieldKind::Bool:
+        output += value != 0 ? "true" : "false";
+        break;
+
+    case SymbolDumpFieldKind::Pointer:
+        // Addresses do not fit a JSON number.
+        output += isJson ? "\"0x" : "0x";
+        AppendNumber(output, value, 16);
+
+        if (isJson)
+        {
+            output += '"';
+        }
+        break;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "PDB.h"
+#include "SymbolDumpImage.h"
+
+#include <string>
+#include <vector>
+
+enum class SymbolDumpFieldKind : uint8_t
+{
+    Unsigned,
+    Signed,
+    Float,
+    Bool,
+    Pointer,
+};
+
+// A leaf of the decoded type: a value of at most 8 bytes.
+struct SymbolDumpField
+{
+    std::string path;
+    DWORD offset = 0;
+    DWORD size = 0;
+    DWORD bits = 0;
+    DWORD bitPosition = 0;
+    SymbolDumpFieldKind kind = SymbolDumpFieldKind::Unsigned;
+};
+
+enum class SymbolDumpFormat : uint8_t
+{
+    // "0x<address> <path>=<value> ..."
+    Text,
+
+    // {"address":"0x<address>","<path>":<value>,...}
+    Json,
+};
+
+//
+// Decodes instances of one UDT out of a dump.
+//
+// The layout is flattened once into its leaves, the way the PDB lays them
+// out: members of nested types get dotted paths ("Header.Lock"), array
+// elements indexed ones ("Slots[3]"), base classes are named after their
+// type and every member of a union is decoded. Each leaf keeps its output
+// key, so an instance costs one read out of the mapped dump and one append
+// per leaf.
+//
+class SymbolDumpDecoder
+{
+public:
+    // Arrays are decoded up to this many elements each.
+    static const DWORD ArrayElementLimit = 64;
+
+    // Non-empty fieldPaths keeps only the leaves at or below those paths
+    // ("Header" keeps "Header.Lock", "Slots" keeps "Slots[3]").
+    SymbolDumpDecoder(const Symbol& udt, SymbolDumpFormat format, const std::vector<std::string>& fieldPaths = {});
+
+    DWORD GetSize() const;
+    const std::vector<SymbolDumpField>& GetFields() const;
+
+    // Thread-safe. Appends one line per address; instances not fully in
+    // the dump are written as unreadable.
+    void Decode(const SymbolDumpImage& image, const uint64_t* addresses, size_t count, std::string& output) const;
+
+private:
+    void AddMembers(const Symbol& udt, DWORD baseOffset, std::string& path);
+    void AddValue(const Symbol& type, DWORD offset, DWORD bits, DWORD bitPosition, std::string& path);
+    void AppendValue(const SymbolDumpField& field, const uint8_t* data, std::string& output) const;
+
+private:
+    DWORD m_size = 0;
+    SymbolDumpFormat m_format = SymbolDumpFormat::Text;
+    std::vector<SymbolDumpField> m_fields;
+
+    // What precedes each value: " path=" or ",\"path\":".
+    std::vector<std::string> m_keys;
+};
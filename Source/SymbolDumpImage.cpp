@@ -0,0 +1,387 @@
+#include "SymbolDumpImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // "MDMP"
+    const uint32_t MinidumpSignature = 0x504d444d;
+
+    const uint32_t MemoryListStream = 5;
+    const uint32_t Memory64ListStream = 9;
+
+#pragma pack(push, 4)
+
+    struct MinidumpHeader
+    {
+        uint32_t signature;
+        uint32_t version;
+        uint32_t streamCount;
+        uint32_t streamDirectoryRva;
+        uint32_t checkSum;
+        uint32_t timeDateStamp;
+        uint64_t flags;
+    };
+
+    struct MinidumpLocation
+    {
+        uint32_t dataSize;
+        uint32_t rva;
+    };
+
+    struct MinidumpDirectory
+    {
+        uint32_t streamType;
+        MinidumpLocation location;
+    };
+
+    struct MinidumpMemoryDescriptor
+    {
+        uint64_t startOfMemoryRange;
+        MinidumpLocation memory;
+    };
+
+    struct MinidumpMemoryDescriptor64
+    {
+        uint64_t startOfMemoryRange;
+        uint64_t dataSize;
+    };
+
+    struct MinidumpMemory64List
+    {
+        uint64_t rangeCount;
+        uint64_t baseRva;
+    };
+
+#pragma pack(pop)
+}
+
+SymbolDumpImage::~SymbolDumpImage()
+{
+    Close();
+}
+
+bool SymbolDumpImage::Open(const std::filesystem::path& path, uint64_t baseAddress)
+{
+    Close();
+
+    m_file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view)
+    {
+        Close();
+        return false;
+    }
+
+    uint32_t signature = 0;
+    if (m_size >= sizeof(MinidumpHeader))
+    {
+        memcpy(&signature, m_view, sizeof(signature));
+    }
+
+    m_isMinidump = signature == MinidumpSignature;
+
+    if (!m_isMinidump)
+    {
+        m_ranges.push_back(SymbolDumpRange{ baseAddress, m_size, 0 });
+        return true;
+    }
+
+    if (!LoadMinidumpRanges())
+    {
+        Close();
+        return false;
+    }
+
+    SortRanges();
+    return true;
+}
+
+void SymbolDumpImage::Close()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+    m_size = 0;
+    m_isMinidump = false;
+    m_ranges.clear();
+}
+
+bool SymbolDumpImage::IsOpen() const
+{
+    return m_view != nullptr;
+}
+
+bool SymbolDumpImage::IsMinidump() const
+{
+    return m_isMinidump;
+}
+
+const std::vector<SymbolDumpRange>& SymbolDumpImage::GetRanges() const
+{
+    return m_ranges;
+}
+
+const uint8_t* SymbolDumpImage::GetPointer(uint64_t virtualAddress, size_t size) const
+{
+    const auto* range = FindRange(virtualAddress);
+    if (!range || virtualAddress - range->virtualAddress + size > range->size)
+    {
+        return nullptr;
+    }
+
+    return m_view + range->fileOffset + (virtualAddress - range->virtualAddress);
+}
+
+bool SymbolDumpImage::Read(uint64_t virtualAddress, void* buffer, size_t size) const
+{
+    auto* output = static_cast<uint8_t*>(buffer);
+
+    while (size != 0)
+    {
+        const auto* range = FindRange(virtualAddress);
+        if (!range)
+        {
+            return false;
+        }
+
+        const uint64_t rangeOffset = virtualAddress - range->virtualAddress;
+        const size_t readSize = static_cast<size_t>((std::min)(static_cast<uint64_t>(size), range->size - rangeOffset));
+
+        memcpy(output, m_view + range->fileOffset + rangeOffset, readSize);
+
+        output += readSize;
+        virtualAddress += readSize;
+        size -= readSize;
+    }
+
+    return true;
+}
+
+void SymbolDumpImage::Prefetch(const uint64_t* virtualAddresses, size_t count, size_t size) const
+{
+    std::vector<WIN32_MEMORY_RANGE_ENTRY> entries;
+    entries.reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto* range = FindRange(virtualAddresses[i]);
+        if (!range)
+        {
+            continue;
+        }
+
+        const uint64_t rangeOffset = virtualAddresses[i] - range->virtualAddress;
+
+        WIN32_MEMORY_RANGE_ENTRY entry;
+        entry.VirtualAddress = const_cast<uint8_t*>(m_view + range->fileOffset + rangeOffset);
+        entry.NumberOfBytes = static_cast<SIZE_T>((std::min)(static_cast<uint64_t>(size), range->size - rangeOffset));
+
+        entries.push_back(entry);
+    }
+
+    if (!entries.empty())
+    {
+        // Only a hint; a failure leaves the pages to be faulted in.
+        PrefetchVirtualMemory(GetCurrentProcess(), entries.size(), entries.data(), 0);
+    }
+}
+
+bool SymbolDumpImage::LoadMinidumpRanges()
+{
+    //
+    // Every table is checked against the file size before it is read;
+    // ranges reaching past the end of the file are cut short.
+    //
+    auto isInFile = [this](uint64_t offset, uint64_t size)
+    {
+        return offset <= m_size && size <= m_size - offset;
+    };
+
+    auto addRange = [this](uint64_t virtualAddress, uint64_t size, uint64_t fileOffset)
+    {
+        if (fileOffset < m_size)
+        {
+            size = (std::min)(size, m_size - fileOffset);
+        }
+        else
+        {
+            size = 0;
+        }
+
+        if (size != 0)
+        {
+            m_ranges.push_back(SymbolDumpRange{ virtualAddress, size, fileOffset });
+        }
+    };
+
+    MinidumpHeader header;
+    memcpy(&header, m_view, sizeof(header));
+
+    if (!isInFile(header.streamDirectoryRva, uint64_t{ header.streamCount } * sizeof(MinidumpDirectory)))
+    {
+        return false;
+    }
+
+    const auto* directories = reinterpret_cast<const MinidumpDirectory*>(m_view + header.streamDirectoryRva);
+
+    for (uint32_t i = 0; i < header.streamCount; ++i)
+    {
+        const auto& location = directories[i].location;
+
+        if (directories[i].streamType == Memory64ListStream &&
+            isInFile(location.rva, sizeof(MinidumpMemory64List)))
+        {
+            MinidumpMemory64List list;
+            memcpy(&list, m_view + location.rva, sizeof(list));
+
+            const uint64_t descriptorsOffset = uint64_t{ location.rva } + sizeof(MinidumpMemory64List);
+            if (list.rangeCount > m_size / sizeof(MinidumpMemoryDescriptor64) ||
+                !isInFile(descriptorsOffset, list.rangeCount * sizeof(MinidumpMemoryDescriptor64)))
+            {
+                return false;
+            }
+
+            // The memory of all ranges follows baseRva back to back.
+            const auto* descriptors = reinterpret_cast<const MinidumpMemoryDescriptor64*>(m_view + descriptorsOffset);
+            uint64_t fileOffset = list.baseRva;
+
+            for (uint64_t j = 0; j < list.rangeCount; ++j)
+            {
+                addRange(descriptors[j].startOfMemoryRange, descriptors[j].dataSize, fileOffset);
+                fileOffset += descriptors[j].dataSize;
+            }
+        }
+        else if (directories[i].streamType == MemoryListStream &&
+                 isInFile(location.rva, sizeof(uint32_t)))
+        {
+            uint32_t rangeCount;
+            memcpy(&rangeCount, m_view + location.rva, sizeof(rangeCount));
+
+            const uint64_t descriptorsOffset = uint64_t{ location.rva } + sizeof(uint32_t);
+            if (!isInFile(descriptorsOffset, uint64_t{ rangeCount } * sizeof(MinidumpMemoryDescriptor)))
+            {
+                return false;
+            }
+
+            const auto* descriptors = reinterpret_cast<const MinidumpMemoryDescriptor*>(m_view + descriptorsOffset);
+
+            for (uint32_t j = 0; j < rangeCount; ++j)
+            {
+                addRange(descriptors[j].startOfMemoryRange, descriptors[j].memory.dataSize, descriptors[j].memory.rva);
+            }
+        }
+    }
+
+    return true;
+}
+
+void SymbolDumpImage::SortRanges()
+{
+    std::sort(m_ranges.begin(), m_ranges.end(), [](const SymbolDumpRange& left, const SymbolDumpRange& right)
+    {
+        return left.virtualAddress < right.virtualAddress;
+    });
+
+    //
+    // Full memory dumps store memory in many ranges that usually follow
+    // each other both in memory and in the file; those are joined. Ranges
+    // overlapping an earlier one lose the overlapping part.
+    //
+    std::vector<SymbolDumpRange> ranges;
+    ranges.reserve(m_ranges.size());
+
+    for (auto range : m_ranges)
+    {
+        if (!ranges.empty())
+        {
+            auto& last = ranges.back();
+            const uint64_t lastEnd = last.virtualAddress + last.size;
+
+            if (range.virtualAddress < lastEnd)
+            {
+                const uint64_t overlap = (std::min)(lastEnd - range.virtualAddress, range.size);
+
+                range.virtualAddress += overlap;
+                range.fileOffset += overlap;
+                range.size -= overlap;
+
+                if (range.size == 0)
+                {
+                    continue;
+                }
+            }
+
+            if (range.virtualAddress == lastEnd && range.fileOffset == last.fileOffset + last.size)
+            {
+                last.size += range.size;
+                continue;
+            }
+        }
+
+        ranges.push_back(range);
+    }
+
+    m_ranges = std::move(ranges);
+}
+
+const SymbolDumpRange* SymbolDumpImage::FindRange(uint64_t virtualAddress) const
+{
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), virtualAddress, [](uint64_t address, const SymbolDumpRange& range)
+    {
+        return address < range.virtualAddress;
+    });
+
+    if (it == m_ranges.begin())
+    {
+        return nullptr;
+    }
+
+    --it;
+    return virtualAddress - it->virtualAddress < it->size ? &*it : nullptr;
+}
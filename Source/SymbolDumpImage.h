@@ -0,0 +1,66 @@
+#pragma once
+#include "PDB.h"
+
+#include <filesystem>
+#include <vector>
+
+// Memory at virtualAddress is stored at fileOffset in the dump.
+struct SymbolDumpRange
+{
+    uint64_t virtualAddress;
+    uint64_t size;
+    uint64_t fileOffset;
+};
+
+//
+// Read-only view of the memory held by a dump file. Minidumps are taken
+// apart by their memory lists (full memory dumps keep theirs in the
+// Memory64List stream); any other file is taken as a raw image of memory
+// starting at a given address.
+//
+// Ranges are kept sorted by address, with ranges adjacent both in memory
+// and in the file joined, so an address is translated by one binary
+// search. The file is mapped and read in place.
+//
+class SymbolDumpImage
+{
+public:
+    SymbolDumpImage() = default;
+    ~SymbolDumpImage();
+
+    SymbolDumpImage(const SymbolDumpImage&) = delete;
+    SymbolDumpImage& operator=(const SymbolDumpImage&) = delete;
+
+    // baseAddress only applies to raw images.
+    bool Open(const std::filesystem::path& path, uint64_t baseAddress);
+    void Close();
+    bool IsOpen() const;
+
+    bool IsMinidump() const;
+    const std::vector<SymbolDumpRange>& GetRanges() const;
+
+    // Thread-safe. Null unless all of the bytes are in one range.
+    const uint8_t* GetPointer(uint64_t virtualAddress, size_t size) const;
+
+    // Thread-safe. Also reads across ranges that are adjacent in memory.
+    bool Read(uint64_t virtualAddress, void* buffer, size_t size) const;
+
+    // Thread-safe. Asks the system to page in size bytes at each address,
+    // in one request, so faults on them do not wait for the disk one at a
+    // time. Addresses not in the dump are ignored.
+    void Prefetch(const uint64_t* virtualAddresses, size_t count, size_t size) const;
+
+private:
+    bool LoadMinidumpRanges();
+    void SortRanges();
+    const SymbolDumpRange* FindRange(uint64_t virtualAddress) const;
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    uint64_t m_size = 0;
+
+    bool m_isMinidump = false;
+    std::vector<SymbolDumpRange> m_ranges;
+};
@@ -0,0 +1,194 @@
+#include "SymbolDumpWalker.h"
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_set>
+
+namespace
+{
+    template<typename T>
+    void AppendNumber(std::string& output, T value, int base = 10)
+    {
+        char text[32];
+        output.append(text, std::to_chars(text, text + sizeof(text), value, base).ptr);
+    }
+
+    const char* GetEndString(SymbolDumpWalkEnd end)
+    {
+        switch (end)
+        {
+        case SymbolDumpWalkEnd::Head:       return "head";
+        case SymbolDumpWalkEnd::Null:       return "null";
+        case SymbolDumpWalkEnd::Cycle:      return "cycle";
+        case SymbolDumpWalkEnd::Unreadable: return "unreadable";
+        case SymbolDumpWalkEnd::Limit:      return "limit";
+        default:                            return "";
+        }
+    }
+
+    bool HasEndAddress(SymbolDumpWalkEnd end)
+    {
+        return end == SymbolDumpWalkEnd::Cycle || end == SymbolDumpWalkEnd::Unreadable;
+    }
+}
+
+SymbolDumpWalker::SymbolDumpWalker(
+    const SymbolDumpImage& image,
+    DWORD nextOffset,
+    DWORD linkOffset,
+    DWORD headPointerOffset,
+    DWORD nodeSize,
+    DWORD pointerSize)
+    : m_image(image)
+    , m_nextOffset(nextOffset)
+    , m_linkOffset(linkOffset)
+    , m_headPointerOffset(headPointerOffset)
+    , m_nodeSize(nodeSize)
+    , m_pointerSize(pointerSize)
+{
+}
+
+void SymbolDumpWalker::Walk(const uint64_t* heads, size_t count, std::vector<SymbolDumpWalkResult>& results) const
+{
+    results.assign(count, SymbolDumpWalkResult());
+
+    // Per list: where its next pointer is, and the nodes it has reached.
+    std::vector<uint64_t> pointers(count);
+    std::vector<std::unordered_set<uint64_t>> visited(count);
+    std::vector<size_t> active(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        pointers[i] = heads[i] + m_headPointerOffset;
+        active[i] = i;
+    }
+
+    // Each page is prefetched once per walk; the lists of one walk often
+    // share pages.
+    std::unordered_set<uint64_t> prefetchedPages;
+    std::vector<uint64_t> pages;
+
+    auto addPages = [&prefetchedPages, &pages](uint64_t address, uint64_t size)
+    {
+        const uint64_t lastPage = (address + size - 1) / PageSize;
+
+        for (uint64_t page = address / PageSize; page <= lastPage; ++page)
+        {
+            if (prefetchedPages.insert(page).second)
+            {
+                pages.push_back(page * PageSize);
+            }
+        }
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        addPages(pointers[i], m_pointerSize);
+    }
+
+    while (!active.empty())
+    {
+        m_image.Prefetch(pages.data(), pages.size(), PageSize);
+        pages.clear();
+
+        size_t activeCount = 0;
+
+        for (size_t i : active)
+        {
+            auto& result = results[i];
+
+            uint64_t value = 0;
+            if (!m_image.Read(pointers[i], &value, m_pointerSize))
+            {
+                // The node is only known to be in the dump once its next
+                // pointer has been read.
+                result.end = SymbolDumpWalkEnd::Unreadable;
+                result.endAddress = heads[i];
+
+                if (!result.nodes.empty())
+                {
+                    result.endAddress = result.nodes.back();
+                    result.nodes.pop_back();
+                }
+                continue;
+            }
+
+            if (value == 0)
+            {
+                result.end = SymbolDumpWalkEnd::Null;
+                continue;
+            }
+
+            if (value == heads[i])
+            {
+                result.end = SymbolDumpWalkEnd::Head;
+                continue;
+            }
+
+            const uint64_t node = value - m_linkOffset;
+
+            if (result.nodes.size() == NodeLimit)
+            {
+                result.end = SymbolDumpWalkEnd::Limit;
+                continue;
+            }
+
+            if (!visited[i].insert(node).second)
+            {
+                result.end = SymbolDumpWalkEnd::Cycle;
+                result.endAddress = node;
+                continue;
+            }
+
+            result.nodes.push_back(node);
+            pointers[i] = node + m_nextOffset;
+            active[activeCount++] = i;
+
+            // The whole node, as its fields are decoded after the walk.
+            addPages(node, (std::max)(m_nodeSize, m_nextOffset + m_pointerSize));
+        }
+
+        active.resize(activeCount);
+    }
+}
+
+void SymbolDumpWalker::AppendResult(uint64_t head, const SymbolDumpWalkResult& result, bool isJson, std::string& output)
+{
+    const bool hasEndAddress = HasEndAddress(result.end);
+
+    if (isJson)
+    {
+        output += "{\"head\":\"0x";
+        AppendNumber(output, head, 16);
+        output += "\",\"nodes\":";
+        AppendNumber(output, result.nodes.size());
+        output += ",\"end\":\"";
+        output += GetEndString(result.end);
+        output += '"';
+
+        if (hasEndAddress)
+        {
+            output += ",\"endAddress\":\"0x";
+            AppendNumber(output, result.endAddress, 16);
+            output += '"';
+        }
+
+        output += "}\n";
+        return;
+    }
+
+    output += "head 0x";
+    AppendNumber(output, head, 16);
+    output += " nodes ";
+    AppendNumber(output, result.nodes.size());
+    output += " end ";
+    output += GetEndString(result.end);
+
+    if (hasEndAddress)
+    {
+        output += " 0x";
+        AppendNumber(output, result.endAddress, 16);
+    }
+
+    output += '\n';
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "SymbolDumpImage.h"
+
+#include <string>
+#include <vector>
+
+enum class SymbolDumpWalkEnd : uint8_t
+{
+    // The last node links back to the head (circular lists).
+    Head,
+
+    // The last node's next pointer is null.
+    Null,
+
+    // A node was reached a second time; endAddress is that node.
+    Cycle,
+
+    // The next pointer of the head or of a node is not in the dump;
+    // endAddress is that head or node, which is not in the list.
+    Unreadable,
+
+    // The list has more than NodeLimit nodes.
+    Limit,
+};
+
+struct SymbolDumpWalkResult
+{
+    // Addresses of the visited nodes, in list order.
+    std::vector<uint64_t> nodes;
+    SymbolDumpWalkEnd end = SymbolDumpWalkEnd::Null;
+    uint64_t endAddress = 0;
+};
+
+//
+// Walks linked lists of one node type through a dump.
+//
+// A node links to the next one by a pointer to the next node's link member
+// (linkOffset into the node), found at nextOffset into the node: for nodes
+// chained by a LIST_ENTRY, the offsets of the LIST_ENTRY and its Flink.
+// The node is recovered the way CONTAINING_RECORD does, by subtracting
+// linkOffset. A list is given by the address of its head, which holds the
+// first pointer at headPointerOffset: a LIST_ENTRY head holds its Flink at
+// 0, a bare pointer to the first node at 0 too. Circular lists end where a
+// pointer leads back to the head.
+//
+// Following a pointer needs the node it points to, so one list can only be
+// walked a node at a time. Many lists are walked in lockstep instead: each
+// round advances every unfinished list by one node and then prefetches all
+// of the pages of the nodes just reached with one request, so the page
+// faults of a round overlap instead of following each other.
+//
+class SymbolDumpWalker
+{
+public:
+    // Lists longer than this are cut off.
+    static const size_t NodeLimit = 1 << 24;
+
+    static const uint64_t PageSize = 0x1000;
+
+    // pointerSize is 4 or 8.
+    SymbolDumpWalker(
+        const SymbolDumpImage& image,
+        DWORD nextOffset,
+        DWORD linkOffset,
+        DWORD headPointerOffset,
+        DWORD nodeSize,
+        DWORD pointerSize);
+
+    // Thread-safe. Walks the list at each of the heads into results[i].
+    void Walk(const uint64_t* heads, size_t count, std::vector<SymbolDumpWalkResult>& results) const;
+
+    // "head 0x<head> nodes <n> end <kind>[ 0x<address>]" or one JSON
+    // record, and a newline.
+    static void AppendResult(uint64_t head, const SymbolDumpWalkResult& result, bool isJson, std::string& output);
+
+private:
+    const SymbolDumpImage& m_image;
+    DWORD m_nextOffset = 0;
+    DWORD m_linkOffset = 0;
+    DWORD m_headPointerOffset = 0;
+    DWORD m_nodeSize = 0;
+    DWORD m_pointerSize = 0;
+};
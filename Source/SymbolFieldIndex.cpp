@@ -0,0 +1,341 @@
+#include "SymbolFieldIndex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+namespace
+{
+    std::string JoinPath(const std::string& path, const std::string& component)
+    {
+        return path.empty() ? component : path + '.' + component;
+    }
+
+    bool ParseIndex(const std::string& text, DWORD& index)
+    {
+        if (text.empty())
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        index = static_cast<DWORD>(strtoul(text.c_str(), &end, 0));
+        return *end == '\0';
+    }
+}
+
+void SymbolFieldIndex::FindFieldsAtOffset(const Symbol& udt, DWORD offset, std::vector<SymbolFieldLocation>& fields)
+{
+    if (auto layout = GetLayout(udt))
+    {
+        FindFieldsAtOffset(*layout, offset, std::string(), 0, fields);
+    }
+}
+
+bool SymbolFieldIndex::FindFieldAtPath(const Symbol& udt, const std::string& path, SymbolFieldLocation& field)
+{
+    auto layout = GetLayout(udt);
+    return layout && FindFieldAtPath(*layout, path, std::string(), 0, field);
+}
+
+void SymbolFieldIndex::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layouts.clear();
+}
+
+std::shared_ptr<const SymbolFieldIndex::Layout> SymbolFieldIndex::GetLayout(const Symbol& udt)
+{
+    if (!PDB::IsUdt(&udt))
+    {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_layouts.find(&udt);
+        if (it != m_layouts.end())
+        {
+            return it->second;
+        }
+    }
+
+    auto layout = std::make_shared<Layout>();
+    std::vector<std::pair<std::string, uint32_t>> aliases;
+
+    Flatten(udt, 0, std::string(), std::string(), *layout, aliases);
+
+    // Real paths win over base-class-skipping aliases.
+    for (auto& [alias, entryIndex] : aliases)
+    {
+        layout->paths.emplace(std::move(alias), entryIndex);
+    }
+
+    auto& leaves = layout->leaves;
+    const auto& entries = layout->entries;
+
+    for (uint32_t i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].isLeaf)
+        {
+            leaves.push_back(i);
+        }
+    }
+
+    std::stable_sort(leaves.begin(), leaves.end(), [&entries](uint32_t lhs, uint32_t rhs)
+    {
+        return entries[lhs].offset < entries[rhs].offset;
+    });
+
+    layout->leafMaxEnd.reserve(leaves.size());
+    for (const auto leaf : leaves)
+    {
+        const DWORD end = entries[leaf].offset + entries[leaf].size;
+        layout->leafMaxEnd.push_back(layout->leafMaxEnd.empty() ? end : (std::max)(layout->leafMaxEnd.back(), end));
+    }
+
+    // Another thread may have built the same layout meanwhile; keep the
+    // first one so callers always see a single instance.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_layouts.emplace(&udt, std::move(layout)).first->second;
+}
+
+void SymbolFieldIndex::FindFieldsAtOffset(
+    const Layout& layout,
+    DWORD offset,
+    const std::string& pathPrefix,
+    DWORD baseOffset,
+    std::vector<SymbolFieldLocation>& fields)
+{
+    const auto& entries = layout.entries;
+    const size_t firstField = fields.size();
+
+    auto it = std::upper_bound(layout.leaves.begin(), layout.leaves.end(), offset, [&entries](DWORD value, uint32_t leaf)
+    {
+        return value < entries[leaf].offset;
+    });
+
+    for (size_t i = it - layout.leaves.begin(); i-- > 0 && layout.leafMaxEnd[i] > offset;)
+    {
+        const auto& entry = entries[layout.leaves[i]];
+        if (offset >= entry.offset + entry.size)
+        {
+            continue;
+        }
+
+        const Symbol* type = PDB::StripTypedefs(entry.type);
+        if (!type || type->tag != SymTagArrayType)
+        {
+            fields.emplace_back();
+            ToLocation(entry, pathPrefix, baseOffset, fields.back());
+            continue;
+        }
+
+        //
+        // Step into the array element covering offset, and into its members
+        // when the element is a UDT.
+        //
+
+        std::string path = pathPrefix + entry.path;
+        DWORD relativeOffset = offset - entry.offset;
+
+        while (type && type->tag == SymTagArrayType)
+        {
+            const Symbol* elementType = PDB::StripTypedefs(std::get<SymbolArray>(type->variant).elementType.get());
+            if (!elementType || elementType->size == 0)
+            {
+                break;
+            }
+
+            path += '[' + std::to_string(relativeOffset / elementType->size) + ']';
+            relativeOffset %= elementType->size;
+            type = elementType;
+        }
+
+        const DWORD elementOffset = baseOffset + offset - relativeOffset;
+        std::vector<SymbolFieldLocation> elementFields;
+
+        if (PDB::IsUdt(type))
+        {
+            if (auto elementLayout = GetLayout(*type))
+            {
+                FindFieldsAtOffset(*elementLayout, relativeOffset, path + '.', elementOffset, elementFields);
+            }
+        }
+
+        // The element's members are in order already; add them back to
+        // front like the rest of this level.
+        fields.insert(fields.end(), std::make_move_iterator(elementFields.rbegin()), std::make_move_iterator(elementFields.rend()));
+
+        // Scalar elements, and padding inside UDT elements, report the
+        // element itself.
+        if (elementFields.empty())
+        {
+            fields.emplace_back();
+            auto& field = fields.back();
+            field.path = std::move(path);
+            field.offset = elementOffset;
+            field.size = type ? type->size : 0;
+            field.type = type;
+        }
+    }
+
+    // Collected back to front.
+    std::reverse(fields.begin() + firstField, fields.end());
+}
+
+bool SymbolFieldIndex::FindFieldAtPath(
+    const Layout& layout,
+    const std::string& path,
+    const std::string& pathPrefix,
+    DWORD baseOffset,
+    SymbolFieldLocation& field)
+{
+    auto it = layout.paths.find(path);
+    if (it != layout.paths.end())
+    {
+        ToLocation(layout.entries[it->second], pathPrefix, baseOffset, field);
+        return true;
+    }
+
+    size_t position = path.find('[');
+    if (position == std::string::npos)
+    {
+        return false;
+    }
+
+    it = layout.paths.find(path.substr(0, position));
+    if (it == layout.paths.end())
+    {
+        return false;
+    }
+
+    const auto& entry = layout.entries[it->second];
+    const Symbol* type = PDB::StripTypedefs(entry.type);
+    DWORD offset = baseOffset + entry.offset;
+    std::string resolvedPath = pathPrefix + entry.path;
+
+    while (position < path.size() && path[position] == '[')
+    {
+        const size_t closingBracket = path.find(']', position);
+        DWORD index = 0;
+
+        if (closingBracket == std::string::npos ||
+            !ParseIndex(path.substr(position + 1, closingBracket - position - 1), index) ||
+            !type || type->tag != SymTagArrayType)
+        {
+            return false;
+        }
+
+        const auto& symbolArray = std::get<SymbolArray>(type->variant);
+        const Symbol* elementType = PDB::StripTypedefs(symbolArray.elementType.get());
+        if (!elementType || index >= symbolArray.elementCount)
+        {
+            return false;
+        }
+
+        offset += index * elementType->size;
+        resolvedPath += '[' + std::to_string(index) + ']';
+        type = elementType;
+        position = closingBracket + 1;
+    }
+
+    if (position == path.size())
+    {
+        field = SymbolFieldLocation();
+        field.path = std::move(resolvedPath);
+        field.offset = offset;
+        field.size = type->size;
+        field.type = type;
+        return true;
+    }
+
+    if (path[position] != '.' || !PDB::IsUdt(type))
+    {
+        return false;
+    }
+
+    auto elementLayout = GetLayout(*type);
+    return elementLayout && FindFieldAtPath(*elementLayout, path.substr(position + 1), resolvedPath + '.', offset, field);
+}
+
+void SymbolFieldIndex::Flatten(
+    const Symbol& udt,
+    DWORD offset,
+    const std::string& path,
+    const std::string& alias,
+    Layout& layout,
+    std::vector<std::pair<std::string, uint32_t>>& aliases)
+{
+    const auto& symbolUdt = std::get<SymbolUdt>(udt.variant);
+
+    for (const auto& udtField : symbolUdt.fields)
+    {
+        if (!udtField.type)
+        {
+            continue;
+        }
+
+        if (udtField.isBaseClass &&
+            std::any_of(symbolUdt.baseClassFields.begin(), symbolUdt.baseClassFields.end(), [&udtField](const SymbolUdtBaseClass& baseClass)
+            {
+                return baseClass.type == udtField.type && baseClass.isVirtual;
+            }))
+        {
+            continue;
+        }
+
+        const bool isData = udtField.tag == SymTagData && udtField.dataKind != DataIsStaticMember;
+        if (!udtField.isBaseClass && !isData)
+        {
+            continue;
+        }
+
+        const Symbol* type = PDB::StripTypedefs(udtField.type.get());
+        if (udtField.isBaseClass && !PDB::IsUdt(type))
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.path = JoinPath(path, udtField.isBaseClass ? type->name : udtField.name);
+        entry.offset = offset + udtField.offset;
+        entry.size = udtField.type->size;
+        entry.bitPosition = udtField.bitPosition;
+        entry.bits = udtField.bits;
+        entry.type = udtField.type.get();
+        entry.isLeaf = !PDB::IsUdt(type);
+
+        // Base classes do not add a component to the alias path.
+        const std::string entryAlias = udtField.isBaseClass ? alias : JoinPath(alias, udtField.name);
+        const auto entryIndex = static_cast<uint32_t>(layout.entries.size());
+
+        layout.paths.emplace(entry.path, entryIndex);
+        if (!udtField.isBaseClass && entryAlias != entry.path)
+        {
+            aliases.emplace_back(entryAlias, entryIndex);
+        }
+
+        const std::string entryPath = entry.path;
+        const DWORD entryOffset = entry.offset;
+        const bool isLeaf = entry.isLeaf;
+
+        layout.entries.push_back(std::move(entry));
+
+        if (!isLeaf)
+        {
+            Flatten(*type, entryOffset, entryPath, entryAlias, layout, aliases);
+        }
+    }
+}
+
+void SymbolFieldIndex::ToLocation(const Entry& entry, const std::string& pathPrefix, DWORD offset, SymbolFieldLocation& field)
+{
+    field.path = pathPrefix + entry.path;
+    field.offset = offset + entry.offset;
+    field.size = entry.size;
+    field.bitPosition = entry.bitPosition;
+    field.bits = entry.bits;
+    field.type = entry.type;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "PDB.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Flattened member layouts of UDTs, built per type on first use and
+// cached. Members of embedded UDTs and base classes are included with
+// dotted paths, and a base class contributes its type name as a path
+// component. Virtual bases are left out because they have no fixed offset.
+// Arrays are resolved arithmetically, so "a[3].b" is never materialized.
+//
+// Lookups may run concurrently; layouts are immutable once built.
+//
+class SymbolFieldIndex
+{
+public:
+    // Leaf members covering offset, by ascending offset. Overlapping members
+    // of a union are all reported.
+    void FindFieldsAtOffset(const Symbol& udt, DWORD offset, std::vector<SymbolFieldLocation>& fields);
+
+    // Also accepts paths that skip base class components ("Derived.member")
+    // as long as no member of the derived type has the same name.
+    bool FindFieldAtPath(const Symbol& udt, const std::string& path, SymbolFieldLocation& field);
+
+    void Clear();
+
+private:
+    struct Entry
+    {
+        std::string path;
+        DWORD offset = 0;
+        DWORD size = 0;
+        DWORD bitPosition = 0;
+        DWORD bits = 0;
+        const Symbol* type = nullptr;
+        bool isLeaf = false;
+    };
+
+    struct Layout
+    {
+        std::vector<Entry> entries;
+
+        // Leaves sorted by offset, with the running maximum of their end
+        // offsets so a lookup can stop scanning backwards early.
+        std::vector<uint32_t> leaves;
+        std::vector<DWORD> leafMaxEnd;
+
+        std::unordered_map<std::string, uint32_t> paths;
+    };
+
+    std::shared_ptr<const Layout> GetLayout(const Symbol& udt);
+
+    void FindFieldsAtOffset(
+        const Layout& layout,
+        DWORD offset,
+        const std::string& pathPrefix,
+        DWORD baseOffset,
+        std::vector<SymbolFieldLocation>& fields);
+
+    bool FindFieldAtPath(
+        const Layout& layout,
+        const std::string& path,
+        const std::string& pathPrefix,
+        DWORD baseOffset,
+        SymbolFieldLocation& field);
+
+    static void Flatten(
+        const Symbol& udt,
+        DWORD offset,
+        const std::string& path,
+        const std::string& alias,
+        Layout& layout,
+        std::vector<std::pair<std::string, uint32_t>>& aliases);
+
+    static void ToLocation(const Entry& entry, const std::string& pathPrefix, DWORD offset, SymbolFieldLocation& field);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<const Symbol*, std::shared_ptr<const Layout>> m_layouts;
+};
@@ -0,0 +1,223 @@
+#include "SymbolInlineIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+void SymbolInlineIndex::GetFrames(SymbolModule& module, const std::vector<DWORD>& rvas, std::vector<SymbolFrame>& frames, std::vector<uint32_t>& frameOffsets)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Build(module);
+
+    std::vector<uint32_t> order(rvas.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&rvas](uint32_t lhs, uint32_t rhs)
+    {
+        return rvas[lhs] < rvas[rhs];
+    });
+
+    // Frames in RVA order, and where the frames of each RVA begin and end
+    // among them.
+    std::vector<SymbolFrame> sortedFrames;
+    std::vector<std::pair<uint32_t, uint32_t>> spans(rvas.size());
+
+    ptrdiff_t procedureIndex = -1;
+    const InlineTree* tree = nullptr;
+
+    for (const auto i : order)
+    {
+        const DWORD rva = rvas[i];
+
+        if (procedureIndex < 0 || rva - m_procedures[procedureIndex].rva >= m_procedures[procedureIndex].length)
+        {
+            procedureIndex = FindProcedure(rva);
+            tree = procedureIndex >= 0 ? &GetTree(module, static_cast<uint32_t>(procedureIndex)) : nullptr;
+        }
+
+        spans[i].first = static_cast<uint32_t>(sortedFrames.size());
+
+        if (tree)
+        {
+            AddFrames(m_procedures[procedureIndex], *tree, rva, sortedFrames);
+        }
+
+        spans[i].second = static_cast<uint32_t>(sortedFrames.size());
+    }
+
+    frames.clear();
+    frames.reserve(sortedFrames.size());
+    frameOffsets.assign(1, 0);
+
+    for (const auto& span : spans)
+    {
+        frames.insert(frames.end(), sortedFrames.begin() + span.first, sortedFrames.begin() + span.second);
+        frameOffsets.push_back(static_cast<uint32_t>(frames.size()));
+    }
+}
+
+void SymbolInlineIndex::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_built = false;
+    m_procedures.clear();
+    m_names.clear();
+    m_trees.clear();
+}
+
+void SymbolInlineIndex::Build(SymbolModule& module)
+{
+    if (m_built)
+    {
+        return;
+    }
+
+    module.ForEachProcedure([this](const SymbolProcedure& procedure)
+    {
+        if (procedure.rva == 0 || procedure.length == 0)
+        {
+            return;
+        }
+
+        m_procedures.push_back({
+            procedure.rva,
+            procedure.length,
+            procedure.symIndexId,
+            static_cast<uint32_t>(m_names.size()),
+            static_cast<uint32_t>(procedure.name.size()) });
+
+        m_names += procedure.name;
+    });
+
+    std::sort(m_procedures.begin(), m_procedures.end(), [](const Procedure& lhs, const Procedure& rhs)
+    {
+        return lhs.rva < rhs.rva;
+    });
+
+    m_built = true;
+}
+
+const SymbolInlineIndex::InlineTree& SymbolInlineIndex::GetTree(SymbolModule& module, uint32_t procedureIndex)
+{
+    auto& tree = m_trees[procedureIndex];
+
+    if (tree)
+    {
+        return *tree;
+    }
+
+    tree = std::make_unique<InlineTree>();
+
+    // File names -> index into tree->files
+    std::unordered_map<std::string, uint32_t> fileIndexes;
+
+    module.ForEachInlineSite(m_procedures[procedureIndex].symIndexId, [&tree, &fileIndexes](const SymbolInlineSite& inlineSite)
+    {
+        const uint32_t depth = inlineSite.parent == 0 ? 1 : tree->sites[inlineSite.parent - 1].depth + 1;
+        const auto siteIndex = static_cast<uint32_t>(tree->sites.size());
+
+        tree->sites.push_back({ inlineSite.name, inlineSite.parent, depth });
+
+        for (const auto& range : inlineSite.ranges)
+        {
+            if (range.length == 0)
+            {
+                continue;
+            }
+
+            auto [it, inserted] = fileIndexes.emplace(range.file, static_cast<uint32_t>(tree->files.size()));
+            if (inserted)
+            {
+                tree->files.push_back(range.file);
+            }
+
+            tree->ranges.push_back({ range.rva, range.rva + range.length, range.line, siteIndex, it->second });
+        }
+    });
+
+    std::sort(tree->ranges.begin(), tree->ranges.end(), [](const Range& lhs, const Range& rhs)
+    {
+        return lhs.rva < rhs.rva;
+    });
+
+    tree->maxEnds.resize(tree->ranges.size());
+
+    DWORD maxEnd = 0;
+    for (size_t i = 0; i < tree->ranges.size(); ++i)
+    {
+        maxEnd = (std::max)(maxEnd, tree->ranges[i].end);
+        tree->maxEnds[i] = maxEnd;
+    }
+
+    return *tree;
+}
+
+void SymbolInlineIndex::AddFrames(const Procedure& procedure, const InlineTree& tree, DWORD rva, std::vector<SymbolFrame>& frames) const
+{
+    // Ranges of every site containing rva: they start at or below rva, and
+    // the running maximum ends the backward scan once no earlier range can
+    // reach rva.
+    const auto upperBound = std::upper_bound(tree.ranges.begin(), tree.ranges.end(), rva, [](DWORD value, const Range& range)
+    {
+        return value < range.rva;
+    });
+
+    const Range* innermost = nullptr;
+    const size_t firstFrame = frames.size();
+
+    for (auto i = static_cast<size_t>(upperBound - tree.ranges.begin()); i-- > 0 && tree.maxEnds[i] > rva;)
+    {
+        const auto& range = tree.ranges[i];
+
+        if (rva < range.end && (!innermost || tree.sites[range.site].depth > tree.sites[innermost->site].depth))
+        {
+            innermost = &range;
+        }
+    }
+
+    if (innermost)
+    {
+        frames.push_back({ tree.sites[innermost->site].name, tree.files[innermost->file], innermost->line });
+
+        for (uint32_t parent = tree.sites[innermost->site].parent; parent != 0; parent = tree.sites[parent - 1].parent)
+        {
+            frames.push_back({ tree.sites[parent - 1].name, {}, 0 });
+        }
+
+        // Enclosing sites take their line from their own range at rva, when
+        // they have one.
+        for (auto i = static_cast<size_t>(upperBound - tree.ranges.begin()); i-- > 0 && tree.maxEnds[i] > rva;)
+        {
+            const auto& range = tree.ranges[i];
+            if (rva >= range.end || &range == innermost)
+            {
+                continue;
+            }
+
+            // Frames are innermost first, one per depth.
+            auto& frame = frames[firstFrame + tree.sites[innermost->site].depth - tree.sites[range.site].depth];
+            if (frame.line == 0 && frame.name.data() == tree.sites[range.site].name.data())
+            {
+                frame.file = tree.files[range.file];
+                frame.line = range.line;
+            }
+        }
+    }
+
+    frames.push_back({ std::string_view(m_names.data() + procedure.nameOffset, procedure.nameLength), {}, 0 });
+}
+
+ptrdiff_t SymbolInlineIndex::FindProcedure(DWORD rva) const
+{
+    const auto it = std::upper_bound(m_procedures.begin(), m_procedures.end(), rva, [](DWORD value, const Procedure& procedure)
+    {
+        return value < procedure.rva;
+    });
+
+    if (it == m_procedures.begin() || rva - (it - 1)->rva >= (it - 1)->length)
+    {
+        return -1;
+    }
+
+    return (it - 1) - m_procedures.begin();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "PDB.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// RVA -> inline stack lookups.
+//
+// Procedures are kept in a flat array sorted by RVA. The inline sites of a
+// procedure (S_INLINESITE records, whose binary annotations DIA decodes
+// into ranges) are only read when an RVA first lands in that procedure,
+// and are then cached as a tree of sites with their ranges sorted by RVA.
+// Profiler samples cluster in few hot procedures, so large batches decode
+// little.
+//
+// Batches are resolved in RVA order, so consecutive RVAs in one procedure
+// reuse its tree without another lookup.
+//
+class SymbolInlineIndex
+{
+public:
+    // Not concurrent: decoding sites goes through the module's DIA session.
+    void GetFrames(SymbolModule& module, const std::vector<DWORD>& rvas, std::vector<SymbolFrame>& frames, std::vector<uint32_t>& frameOffsets);
+
+    void Clear();
+
+private:
+    struct Procedure
+    {
+        DWORD rva;
+        DWORD length;
+        DWORD symIndexId;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    struct Site
+    {
+        std::string name;
+        uint32_t parent;
+        uint32_t depth;
+    };
+
+    struct Range
+    {
+        DWORD rva;
+        DWORD end;
+        DWORD line;
+        uint32_t site;
+        uint32_t file;
+    };
+
+    struct InlineTree
+    {
+        // Site i has the parent sites[i].parent - 1, or none when the
+        // parent is 0.
+        std::vector<Site> sites;
+
+        // Sorted by RVA; maxEnds[i] is the highest end of ranges[0 .. i].
+        std::vector<Range> ranges;
+        std::vector<DWORD> maxEnds;
+
+        std::vector<std::string> files;
+    };
+
+    void Build(SymbolModule& module);
+    const InlineTree& GetTree(SymbolModule& module, uint32_t procedureIndex);
+    void AddFrames(const Procedure& procedure, const InlineTree& tree, DWORD rva, std::vector<SymbolFrame>& frames) const;
+
+    // Index into m_procedures of the procedure containing rva, or -1.
+    ptrdiff_t FindProcedure(DWORD rva) const;
+
+private:
+    std::mutex m_mutex;
+    bool m_built = false;
+
+    std::vector<Procedure> m_procedures;
+    std::string m_names;
+
+    // Procedure index -> decoded sites
+    std::unordered_map<uint32_t, std::unique_ptr<InlineTree>> m_trees;
+};
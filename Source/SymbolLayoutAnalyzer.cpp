@@ -0,0 +1,204 @@
+#include "SymbolLayoutAnalyzer.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    // Virtual bases of a non-virtual base are laid out by the derived type too.
+    bool HasVirtualBases(const SymbolUdt& udt)
+    {
+        return std::any_of(udt.baseClassFields.begin(), udt.baseClassFields.end(), [](const SymbolUdtBaseClass& baseClass)
+        {
+            const Symbol* type = PDB::StripTypedefs(baseClass.type.get());
+            return baseClass.isVirtual || (PDB::IsUdt(type) && HasVirtualBases(std::get<SymbolUdt>(type->variant)));
+        });
+    }
+}
+
+DWORD SymbolLayoutReport::GetWastedBytes() const
+{
+    DWORD wastedBytes = trailingPadding + bitFieldWasteBits / 8;
+
+    for (const auto& hole : holes)
+    {
+        wastedBytes += hole.size;
+    }
+
+    return wastedBytes;
+}
+
+void SymbolLayoutAnalyzer::Analyze(const Symbol& udt, SymbolLayoutReport& report)
+{
+    report = SymbolLayoutReport();
+    report.udt = &udt;
+
+    if (!PDB::IsUdt(&udt) || udt.size == 0)
+    {
+        return;
+    }
+
+    report.cacheLineCount = (udt.size + CacheLineSize - 1) / CacheLineSize;
+
+    std::vector<bool> coverage(udt.size);
+    std::vector<BitFieldUnit> bitFieldUnits;
+    std::vector<Member> members;
+
+    AddMembers(udt, 0, std::string(), coverage, bitFieldUnits, members, report);
+
+    for (const auto& unit : bitFieldUnits)
+    {
+        report.bitFieldWasteBits += unit.size * 8 - std::popcount(unit.usedBits);
+    }
+
+    report.hasVirtualBases = HasVirtualBases(std::get<SymbolUdt>(udt.variant));
+
+    // Empty types still take a byte; that is not padding.
+    if (members.empty() || report.hasVirtualBases)
+    {
+        return;
+    }
+
+    std::stable_sort(members.begin(), members.end(), [](const Member& lhs, const Member& rhs)
+    {
+        return lhs.end < rhs.end;
+    });
+
+    const bool hasVtablePointer = HasVtablePointer(udt);
+
+    for (DWORD offset = 0; offset < udt.size;)
+    {
+        if (coverage[offset])
+        {
+            ++offset;
+            continue;
+        }
+
+        const DWORD holeOffset = offset;
+        while (offset < udt.size && !coverage[offset])
+        {
+            ++offset;
+        }
+
+        if (offset == udt.size)
+        {
+            report.trailingPadding = offset - holeOffset;
+            break;
+        }
+
+        if (holeOffset == 0 && hasVtablePointer)
+        {
+            continue;
+        }
+
+        SymbolLayoutHole hole;
+        hole.offset = holeOffset;
+        hole.size = offset - holeOffset;
+
+        auto member = std::upper_bound(members.begin(), members.end(), holeOffset, [](DWORD value, const Member& member)
+        {
+            return value < member.end;
+        });
+
+        if (member != members.begin() && (member - 1)->end == holeOffset)
+        {
+            hole.after = (member - 1)->path;
+        }
+
+        report.holes.push_back(std::move(hole));
+    }
+}
+
+void SymbolLayoutAnalyzer::AddMembers(
+    const Symbol& udt,
+    DWORD baseOffset,
+    const std::string& pathPrefix,
+    std::vector<bool>& coverage,
+    std::vector<BitFieldUnit>& bitFieldUnits,
+    std::vector<Member>& members,
+    SymbolLayoutReport& report)
+{
+    const auto& symbolUdt = std::get<SymbolUdt>(udt.variant);
+
+    for (const auto& udtField : symbolUdt.fields)
+    {
+        if (!udtField.type)
+        {
+            continue;
+        }
+
+        // Virtual bases live wherever the most derived type puts them.
+        if (udtField.isBaseClass && PDB::IsVirtualBaseClass(symbolUdt, udtField))
+        {
+            continue;
+        }
+
+        const bool isData = udtField.tag == SymTagData && udtField.dataKind != DataIsStaticMember;
+        if (!udtField.isBaseClass && !isData)
+        {
+            continue;
+        }
+
+        const Symbol* type = PDB::StripTypedefs(udtField.type.get());
+        const DWORD offset = baseOffset + udtField.offset;
+        const DWORD size = udtField.type->size;
+        const std::string path = pathPrefix + (udtField.isBaseClass ? udtField.type->name : udtField.name);
+
+        if (!udtField.isBaseClass && PDB::IsUdt(type) && PDB::IsUnnamedSymbol(*type))
+        {
+            AddMembers(*type, offset, path + '.', coverage, bitFieldUnits, members, report);
+            continue;
+        }
+
+        const DWORD end = (std::min)(offset + size, static_cast<DWORD>(coverage.size()));
+        for (DWORD i = (std::min)(offset, end); i < end; ++i)
+        {
+            coverage[i] = true;
+        }
+
+        members.push_back({ offset, end, path });
+
+        if (udtField.bits != 0)
+        {
+            auto unit = std::find_if(bitFieldUnits.rbegin(), bitFieldUnits.rend(), [offset, size](const BitFieldUnit& unit)
+            {
+                return unit.offset == offset && unit.size == size;
+            });
+
+            if (unit == bitFieldUnits.rend())
+            {
+                bitFieldUnits.push_back({ offset, size, 0 });
+                unit = bitFieldUnits.rbegin();
+            }
+
+            const uint64_t bits = udtField.bits >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << udtField.bits) - 1;
+            unit->usedBits |= bits << (udtField.bitPosition & 63);
+            continue;
+        }
+
+        if (!udtField.isBaseClass && size != 0 && size <= CacheLineSize && offset % CacheLineSize + size > CacheLineSize)
+        {
+            report.straddles.push_back({ path, offset, size });
+        }
+    }
+}
+
+bool SymbolLayoutAnalyzer::HasVtablePointer(const Symbol& udt)
+{
+    const auto& symbolUdt = std::get<SymbolUdt>(udt.variant);
+
+    const bool hasVirtualBase = std::any_of(symbolUdt.baseClassFields.begin(), symbolUdt.baseClassFields.end(), [](const SymbolUdtBaseClass& baseClass)
+    {
+        return baseClass.isVirtual;
+    });
+
+    const bool hasVirtualFunction = std::any_of(symbolUdt.fields.begin(), symbolUdt.fields.end(), [](const SymbolUdtField& udtField)
+    {
+        return udtField.type &&
+            udtField.tag == SymTagFunction &&
+            std::holds_alternative<SymbolFunction>(udtField.type->variant) &&
+            std::get<SymbolFunction>(udtField.type->variant).isVirtual;
+    });
+
+    return hasVirtualBase || hasVirtualFunction;
+}
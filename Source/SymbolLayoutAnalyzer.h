@@ -0,0 +1,94 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <vector>
+
+// Bytes of a UDT that no member uses.
+struct SymbolLayoutHole
+{
+    DWORD offset = 0;
+    DWORD size = 0;
+
+    // Member ending where the hole begins; empty when there is none.
+    std::string after;
+};
+
+// A member smaller than a cache line that still spans two of them.
+struct SymbolLayoutStraddle
+{
+    std::string path;
+    DWORD offset = 0;
+    DWORD size = 0;
+};
+
+struct SymbolLayoutReport
+{
+    const Symbol* udt = nullptr;
+
+    std::vector<SymbolLayoutHole> holes;
+    DWORD trailingPadding = 0;
+
+    // Holes and trailing padding are not reported; see SymbolLayoutAnalyzer.
+    bool hasVirtualBases = false;
+
+    // Unused bits of bit field storage units.
+    DWORD bitFieldWasteBits = 0;
+
+    std::vector<SymbolLayoutStraddle> straddles;
+    DWORD cacheLineCount = 0;
+
+    DWORD GetWastedBytes() const;
+};
+
+//
+// Layout analysis in the spirit of pahole: holes between members, trailing
+// padding, unused bit field bits and members straddling cache lines.
+//
+// Works on the field tables alone, without rendering. Members of unnamed
+// nested types count as members of the type, while named members are
+// taken as a whole; their own holes show up in their own report. Unions
+// leave a hole only where none of their members reaches.
+//
+// The vtable pointer has no member; a leading hole in a type with virtual
+// functions holds it and is not reported.
+//
+// Neither do virtual bases, nor the pointer to their displacements: the PDB
+// only says where a virtual base is through the vbtable of an instance.
+// Their bytes cannot be told apart from holes, so types with virtual bases
+// get no hole or trailing padding reports at all.
+//
+class SymbolLayoutAnalyzer
+{
+public:
+    static const DWORD CacheLineSize = 64;
+
+    // Thread-safe: only reads the symbol graph.
+    static void Analyze(const Symbol& udt, SymbolLayoutReport& report);
+
+private:
+    struct Member
+    {
+        DWORD offset;
+        DWORD end;
+        std::string path;
+    };
+
+    struct BitFieldUnit
+    {
+        DWORD offset;
+        DWORD size;
+        uint64_t usedBits;
+    };
+
+    static void AddMembers(
+        const Symbol& udt,
+        DWORD baseOffset,
+        const std::string& pathPrefix,
+        std::vector<bool>& coverage,
+        std::vector<BitFieldUnit>& bitFieldUnits,
+        std::vector<Member>& members,
+        SymbolLayoutReport& report);
+
+    static bool HasVtablePointer(const Symbol& udt);
+};
@@ -0,0 +1,375 @@
+#include "SymbolLineTable.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    // Line numbers the compiler uses for code that has no source line.
+    const DWORD HiddenLineNumbers[] = { 0xf00f00, 0xfeefee };
+
+    const char SnapshotMagic[8] = { 'P', 'D', 'B', 'X', 'L', 'I', 'N', 'E' };
+    const uint32_t SnapshotVersion = 1;
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version;
+        GUID guid;
+        uint32_t age;
+        uint32_t fileCount;
+        uint32_t lineCount;
+        uint32_t fileNamesSize;
+    };
+
+    struct ModuleLine
+    {
+        DWORD rva;
+        DWORD length;
+        DWORD line;
+        uint32_t file;
+    };
+
+    struct ModuleLines
+    {
+        std::vector<ModuleLine> lines;
+        std::vector<std::string> files;
+    };
+
+    template<typename Item, typename Enumerator, typename Func>
+    void ForEachDiaItem(const ATL::CComPtr<Enumerator>& enumerator, const Func& func)
+    {
+        ULONG fetchedCount = 0;
+        ATL::CComPtr<Item> item;
+
+        while (SUCCEEDED(enumerator->Next(1, &item, &fetchedCount)) && fetchedCount == 1)
+        {
+            func(item);
+            item.Release();
+        }
+    }
+
+    //
+    // A private DIA session reading the lines of every partCount-th module.
+    //
+    class LineReader : public SymbolModuleBase
+    {
+    public:
+        ~LineReader()
+        {
+            Close();
+        }
+
+        void Read(size_t part, size_t partCount, ModuleLines& moduleLines)
+        {
+            DiaEnumSymbolsPtr compilands;
+            if (FAILED(m_globalSymbol->findChildren(SymTagCompiland, nullptr, nsNone, &compilands)))
+            {
+                return;
+            }
+
+            // DIA file ids -> index into moduleLines.files
+            std::unordered_map<DWORD, uint32_t> files;
+            size_t compilandIndex = 0;
+
+            ForEachDiaItem<IDiaSymbol>(compilands, [&](const DiaSymbolPtr& compiland)
+            {
+                if (compilandIndex++ % partCount != part)
+                {
+                    return;
+                }
+
+                ATL::CComPtr<IDiaEnumSourceFiles> sourceFiles;
+                if (FAILED(m_session->findFile(compiland, nullptr, nsNone, &sourceFiles)))
+                {
+                    return;
+                }
+
+                ForEachDiaItem<IDiaSourceFile>(sourceFiles, [&](const ATL::CComPtr<IDiaSourceFile>& sourceFile)
+                {
+                    DWORD fileId = 0;
+                    sourceFile->get_uniqueId(&fileId);
+
+                    auto [it, inserted] = files.emplace(fileId, static_cast<uint32_t>(moduleLines.files.size()));
+                    if (inserted)
+                    {
+                        moduleLines.files.push_back(GetSourceFileName(sourceFile));
+                    }
+
+                    ATL::CComPtr<IDiaEnumLineNumbers> lineNumbers;
+                    if (FAILED(m_session->findLines(compiland, sourceFile, &lineNumbers)))
+                    {
+                        return;
+                    }
+
+                    ForEachDiaItem<IDiaLineNumber>(lineNumbers, [&](const ATL::CComPtr<IDiaLineNumber>& lineNumber)
+                    {
+                        ModuleLine line = { 0, 0, 0, it->second };
+                        lineNumber->get_relativeVirtualAddress(&line.rva);
+                        lineNumber->get_length(&line.length);
+                        lineNumber->get_lineNumber(&line.line);
+
+                        if (line.length != 0 &&
+                            std::find(std::begin(HiddenLineNumbers), std::end(HiddenLineNumbers), line.line) == std::end(HiddenLineNumbers))
+                        {
+                            moduleLines.lines.push_back(line);
+                        }
+                    });
+                });
+            });
+        }
+    };
+}
+
+bool SymbolLineTable::Load(const SymbolModule& module, const std::filesystem::path& cachePath, size_t threadCount)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_loaded)
+    {
+        return true;
+    }
+
+    GUID guid = {};
+    DWORD age = 0;
+    const bool isCached = !cachePath.empty() && module.GetSignature(guid, age);
+
+    if (isCached && ReadSnapshot(cachePath, guid, age))
+    {
+        m_loaded = true;
+        return true;
+    }
+
+    if (!Decode(module.GetPath(), threadCount))
+    {
+        Reset();
+        return false;
+    }
+
+    if (isCached)
+    {
+        WriteSnapshot(cachePath, guid, age);
+    }
+
+    m_loaded = true;
+    return true;
+}
+
+void SymbolLineTable::Resolve(const std::vector<DWORD>& rvas, std::vector<SymbolLine>& lines) const
+{
+    lines.assign(rvas.size(), SymbolLine());
+
+    std::vector<uint32_t> order(rvas.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&rvas](uint32_t lhs, uint32_t rhs)
+    {
+        return rvas[lhs] < rvas[rhs];
+    });
+
+    // First line above the current RVA; only moves forward.
+    auto next = m_lines.begin();
+
+    for (const auto i : order)
+    {
+        next = std::upper_bound(next, m_lines.end(), rvas[i], [](DWORD rva, const Line& line)
+        {
+            return rva < line.rva;
+        });
+
+        if (next == m_lines.begin())
+        {
+            continue;
+        }
+
+        const auto& line = *(next - 1);
+        if (rvas[i] - line.rva < line.length)
+        {
+            lines[i].file = GetFileName(line.file);
+            lines[i].line = line.line;
+        }
+    }
+}
+
+void SymbolLineTable::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Reset();
+}
+
+void SymbolLineTable::Reset()
+{
+    m_loaded = false;
+    m_lines.clear();
+    m_fileNames.clear();
+    m_fileNameOffsets.clear();
+}
+
+bool SymbolLineTable::Decode(const std::filesystem::path& path, size_t threadCount)
+{
+    const size_t partCount = (std::max)(threadCount != 0 ? threadCount : std::thread::hardware_concurrency(), size_t{ 1 });
+
+    std::vector<ModuleLines> parts(partCount);
+    std::atomic<bool> failed = false;
+
+    {
+        ThreadPool pool(partCount);
+
+        for (size_t part = 0; part < partCount; ++part)
+        {
+            pool.Submit([&path, &parts, &failed, part, partCount]()
+            {
+                LineReader reader;
+                if (!reader.Open(path))
+                {
+                    failed = true;
+                    return;
+                }
+
+                reader.Read(part, partCount, parts[part]);
+            });
+        }
+
+        pool.Wait();
+    }
+
+    if (failed)
+    {
+        return false;
+    }
+
+    //
+    // Merge: intern the file names and remap the per-part file indexes.
+    //
+
+    std::unordered_map<std::string, uint32_t> fileIndexes;
+    std::vector<uint32_t> fileRemap;
+
+    m_fileNameOffsets.assign(1, 0);
+
+    for (auto& part : parts)
+    {
+        fileRemap.clear();
+
+        for (auto& fileName : part.files)
+        {
+            auto [it, inserted] = fileIndexes.emplace(fileName, static_cast<uint32_t>(fileIndexes.size()));
+            if (inserted)
+            {
+                m_fileNames += fileName;
+                m_fileNameOffsets.push_back(static_cast<uint32_t>(m_fileNames.size()));
+            }
+
+            fileRemap.push_back(it->second);
+        }
+
+        for (const auto& line : part.lines)
+        {
+            m_lines.push_back({ line.rva, line.length, line.line, fileRemap[line.file] });
+        }
+
+        part = ModuleLines();
+    }
+
+    std::sort(m_lines.begin(), m_lines.end(), [](const Line& lhs, const Line& rhs)
+    {
+        return lhs.rva < rhs.rva;
+    });
+
+    return !m_lines.empty();
+}
+
+bool SymbolLineTable::ReadSnapshot(const std::filesystem::path& path, const GUID& guid, DWORD age)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    SnapshotHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 ||
+        header.version != SnapshotVersion ||
+        memcmp(&header.guid, &guid, sizeof(guid)) != 0 ||
+        header.age != age)
+    {
+        return false;
+    }
+
+    std::error_code error;
+    const uint64_t expectedSize =
+        sizeof(header) +
+        (uint64_t{ header.fileCount } + 1) * sizeof(uint32_t) +
+        header.fileNamesSize +
+        uint64_t{ header.lineCount } * sizeof(Line);
+
+    if (std::filesystem::file_size(path, error) != expectedSize || error)
+    {
+        return false;
+    }
+
+    m_fileNameOffsets.resize(header.fileCount + 1);
+    m_fileNames.resize(header.fileNamesSize);
+    m_lines.resize(header.lineCount);
+
+    file.read(reinterpret_cast<char*>(m_fileNameOffsets.data()), m_fileNameOffsets.size() * sizeof(uint32_t));
+    file.read(m_fileNames.data(), m_fileNames.size());
+    file.read(reinterpret_cast<char*>(m_lines.data()), m_lines.size() * sizeof(Line));
+
+    const bool isValid =
+        file &&
+        m_fileNameOffsets.front() == 0 &&
+        m_fileNameOffsets.back() == header.fileNamesSize &&
+        std::is_sorted(m_fileNameOffsets.begin(), m_fileNameOffsets.end()) &&
+        std::all_of(m_lines.begin(), m_lines.end(), [&header](const Line& line)
+        {
+            return line.file < header.fileCount;
+        });
+
+    if (!isValid)
+    {
+        Reset();
+    }
+
+    return isValid;
+}
+
+void SymbolLineTable::WriteSnapshot(const std::filesystem::path& path, const GUID& guid, DWORD age) const
+{
+    SnapshotHeader header = {};
+    memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = SnapshotVersion;
+    header.guid = guid;
+    header.age = age;
+    header.fileCount = static_cast<uint32_t>(m_fileNameOffsets.size() - 1);
+    header.lineCount = static_cast<uint32_t>(m_lines.size());
+    header.fileNamesSize = static_cast<uint32_t>(m_fileNames.size());
+
+    // Written aside and renamed, so concurrent runs never read a partial
+    // snapshot. The snapshot is only a cache; failures are ignored.
+    auto temporaryPath = path;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_fileNameOffsets.data()), m_fileNameOffsets.size() * sizeof(uint32_t));
+        file.write(m_fileNames.data(), m_fileNames.size());
+        file.write(reinterpret_cast<const char*>(m_lines.data()), m_lines.size() * sizeof(Line));
+
+        if (!file)
+        {
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+}
+
+std::string_view SymbolLineTable::GetFileName(uint32_t file) const
+{
+    return std::string_view(m_fileNames.data() + m_fileNameOffsets[file], m_fileNameOffsets[file + 1] - m_fileNameOffsets[file]);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "PDB.h"
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// RVA -> file:line lookups over the line information of every module.
+//
+// DIA decodes the C13 line and file checksum subsections of the module
+// streams. Modules are split between worker threads, and each worker opens
+// its own DIA session because sessions must not be shared between threads.
+// The per-worker results are merged into one table sorted by RVA, with
+// file names interned once.
+//
+// The table can be saved as a snapshot keyed by the PDB's GUID and age,
+// so later runs load it instead of decoding again.
+//
+// Batches are resolved in RVA order, so each lookup only searches the
+// part of the table after the previous result.
+//
+class SymbolLineTable
+{
+public:
+    // Loads the table unless it is loaded already. After that, lookups may
+    // run concurrently.
+    bool Load(const SymbolModule& module, const std::filesystem::path& cachePath, size_t threadCount);
+
+    void Resolve(const std::vector<DWORD>& rvas, std::vector<SymbolLine>& lines) const;
+
+    void Clear();
+
+private:
+    struct Line
+    {
+        DWORD rva;
+        DWORD length;
+        DWORD line;
+        uint32_t file;
+    };
+
+    bool Decode(const std::filesystem::path& path, size_t threadCount);
+    bool ReadSnapshot(const std::filesystem::path& path, const GUID& guid, DWORD age);
+    void WriteSnapshot(const std::filesystem::path& path, const GUID& guid, DWORD age) const;
+
+    void Reset();
+    std::string_view GetFileName(uint32_t file) const;
+
+private:
+    std::mutex m_mutex;
+    bool m_loaded = false;
+
+    // Sorted by RVA.
+    std::vector<Line> m_lines;
+
+    // Name of file i is m_fileNames[m_fileNameOffsets[i] .. m_fileNameOffsets[i + 1]).
+    std::string m_fileNames;
+    std::vector<uint32_t> m_fileNameOffsets;
+};
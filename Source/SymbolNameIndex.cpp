@@ -0,0 +1,419 @@
+#include "SymbolNameIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
+namespace
+{
+    std::string Fold(const std::string& text)
+    {
+        std::string folded(text.size(), '\0');
+        std::transform(text.begin(), text.end(), folded.begin(), [](unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+        return folded;
+    }
+
+    // Distinct trigrams of text, ascending.
+    void GetTrigrams(const std::string& text, std::vector<uint32_t>& trigrams)
+    {
+        for (size_t i = 0; i + 2 < text.size(); ++i)
+        {
+            trigrams.push_back(
+                static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16 |
+                static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8 |
+                static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2])));
+        }
+
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+
+    // Levenshtein distance, or maxDistance + 1 once it is known to exceed
+    // maxDistance.
+    unsigned GetEditDistance(const std::string& lhs, const std::string& rhs, unsigned maxDistance)
+    {
+        const size_t lengthDifference = lhs.size() > rhs.size() ? lhs.size() - rhs.size() : rhs.size() - lhs.size();
+        if (lengthDifference > maxDistance)
+        {
+            return maxDistance + 1;
+        }
+
+        std::vector<unsigned> row(rhs.size() + 1);
+        std::iota(row.begin(), row.end(), 0);
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            unsigned diagonal = row[0];
+            unsigned rowMinimum = row[0] = static_cast<unsigned>(i + 1);
+
+            for (size_t j = 0; j < rhs.size(); ++j)
+            {
+                const unsigned above = row[j + 1];
+                row[j + 1] = (std::min)({ above + 1, row[j] + 1, diagonal + (lhs[i] != rhs[j]) });
+                diagonal = above;
+                rowMinimum = (std::min)(rowMinimum, row[j + 1]);
+            }
+
+            if (rowMinimum > maxDistance)
+            {
+                return maxDistance + 1;
+            }
+        }
+
+        return (std::min)(row.back(), maxDistance + 1);
+    }
+
+    void SplitGlob(const std::string& glob, std::vector<std::string>& parts)
+    {
+        size_t begin = 0;
+
+        while (begin < glob.size())
+        {
+            const auto end = (std::min)(glob.find_first_of("*?", begin), glob.size());
+            if (end > begin)
+            {
+                parts.push_back(glob.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+    }
+}
+
+void SymbolNameIndex::Build(const SymbolMap& symbolMap, const FunctionSet& functionSet)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_built)
+    {
+        return;
+    }
+
+    for (const auto&[_, symbol] : symbolMap)
+    {
+        if ((symbol->tag == SymTagUDT || symbol->tag == SymTagEnum || symbol->tag == SymTagTypedef) &&
+            !symbol->name.empty() && !PDB::IsUnnamedSymbol(*symbol))
+        {
+            m_names.push_back({ symbol->name, Fold(symbol->name), false });
+        }
+    }
+
+    for (const auto& functionName : functionSet)
+    {
+        m_names.push_back({ functionName, Fold(functionName), true });
+    }
+
+    std::sort(m_names.begin(), m_names.end(), [](const Name& lhs, const Name& rhs)
+    {
+        return std::tie(lhs.folded, lhs.name, lhs.isFunction) < std::tie(rhs.folded, rhs.name, rhs.isFunction);
+    });
+
+    // Forward declarations and definitions share their name.
+    m_names.erase(std::unique(m_names.begin(), m_names.end(), [](const Name& lhs, const Name& rhs)
+    {
+        return lhs.name == rhs.name && lhs.isFunction == rhs.isFunction;
+    }), m_names.end());
+
+    //
+    // Trigram postings: collect (trigram, name) pairs, sort them, and
+    // store the names of each trigram as one contiguous range.
+    //
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::vector<uint32_t> trigrams;
+
+    for (uint32_t i = 0; i < m_names.size(); ++i)
+    {
+        trigrams.clear();
+        GetTrigrams(m_names[i].folded, trigrams);
+
+        for (const auto trigram : trigrams)
+        {
+            pairs.emplace_back(trigram, i);
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+
+    m_postings.reserve(pairs.size());
+
+    for (const auto&[trigram, name] : pairs)
+    {
+        if (m_trigrams.empty() || m_trigrams.back() != trigram)
+        {
+            m_trigrams.push_back(trigram);
+            m_postingOffsets.push_back(static_cast<uint32_t>(m_postings.size()));
+        }
+
+        m_postings.push_back(name);
+    }
+
+    m_postingOffsets.push_back(static_cast<uint32_t>(m_postings.size()));
+
+    m_built = true;
+}
+
+void SymbolNameIndex::Search(const std::string& pattern, SymbolNameSearch search, unsigned maxDistance, std::vector<SymbolNameMatch>& matches) const
+{
+    const std::string folded = Fold(pattern);
+
+    switch (search)
+    {
+    case SymbolNameSearch::Prefix:
+        SearchPrefix(folded, matches);
+        break;
+
+    case SymbolNameSearch::Substring:
+        SearchSubstring(folded, matches);
+        break;
+
+    case SymbolNameSearch::Glob:
+        SearchGlob(folded, matches);
+        break;
+
+    case SymbolNameSearch::Fuzzy:
+        SearchFuzzy(folded, maxDistance, matches);
+        break;
+    }
+}
+
+void SymbolNameIndex::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_built = false;
+    m_names.clear();
+    m_trigrams.clear();
+    m_postingOffsets.clear();
+    m_postings.clear();
+}
+
+bool SymbolNameIndex::MatchGlob(const char* pattern, const char* text)
+{
+    const char* starPattern = nullptr;
+    const char* starText = nullptr;
+
+    while (*text)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = ++pattern;
+            starText = text;
+        }
+        else if (*pattern == '?' || *pattern == *text)
+        {
+            ++pattern;
+            ++text;
+        }
+        else if (starPattern)
+        {
+            pattern = starPattern;
+            text = ++starText;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+    {
+        ++pattern;
+    }
+
+    return *pattern == '\0';
+}
+
+void SymbolNameIndex::SearchPrefix(const std::string& prefix, std::vector<SymbolNameMatch>& matches) const
+{
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), prefix, [](const Name& name, const std::string& value)
+    {
+        return name.folded < value;
+    });
+
+    for (; it != m_names.end() && it->folded.compare(0, prefix.size(), prefix) == 0; ++it)
+    {
+        AddMatch(static_cast<uint32_t>(it - m_names.begin()), 0, matches);
+    }
+}
+
+void SymbolNameIndex::SearchSubstring(const std::string& substring, std::vector<SymbolNameMatch>& matches) const
+{
+    std::vector<uint32_t> candidates;
+
+    if (FindCandidates({ substring }, candidates))
+    {
+        for (const auto candidate : candidates)
+        {
+            if (m_names[candidate].folded.find(substring) != std::string::npos)
+            {
+                AddMatch(candidate, 0, matches);
+            }
+        }
+
+        return;
+    }
+
+    for (uint32_t i = 0; i < m_names.size(); ++i)
+    {
+        if (m_names[i].folded.find(substring) != std::string::npos)
+        {
+            AddMatch(i, 0, matches);
+        }
+    }
+}
+
+void SymbolNameIndex::SearchGlob(const std::string& glob, std::vector<SymbolNameMatch>& matches) const
+{
+    std::vector<std::string> parts;
+    SplitGlob(glob, parts);
+
+    std::vector<uint32_t> candidates;
+
+    if (!FindCandidates(parts, candidates))
+    {
+        candidates.resize(m_names.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
+    for (const auto candidate : candidates)
+    {
+        if (MatchGlob(glob.c_str(), m_names[candidate].folded.c_str()))
+        {
+            AddMatch(candidate, 0, matches);
+        }
+    }
+}
+
+void SymbolNameIndex::SearchFuzzy(const std::string& text, unsigned maxDistance, std::vector<SymbolNameMatch>& matches) const
+{
+    std::vector<uint32_t> trigrams;
+    GetTrigrams(text, trigrams);
+
+    // Every edit destroys at most three trigrams of text.
+    const ptrdiff_t threshold = static_cast<ptrdiff_t>(trigrams.size()) - 3 * static_cast<ptrdiff_t>(maxDistance);
+
+    std::vector<uint32_t> candidates;
+
+    if (threshold <= 0)
+    {
+        candidates.resize(m_names.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+    else
+    {
+        std::vector<uint16_t> hitCounts(m_names.size());
+
+        for (const auto trigram : trigrams)
+        {
+            const uint32_t* begin = nullptr;
+            const uint32_t* end = nullptr;
+
+            if (!GetPostings(trigram, begin, end))
+            {
+                continue;
+            }
+
+            for (auto it = begin; it != end; ++it)
+            {
+                if (++hitCounts[*it] == threshold)
+                {
+                    candidates.push_back(*it);
+                }
+            }
+        }
+    }
+
+    const size_t firstMatch = matches.size();
+
+    for (const auto candidate : candidates)
+    {
+        const unsigned distance = GetEditDistance(text, m_names[candidate].folded, maxDistance);
+        if (distance <= maxDistance)
+        {
+            AddMatch(candidate, distance, matches);
+        }
+    }
+
+    std::sort(matches.begin() + firstMatch, matches.end(), [](const SymbolNameMatch& lhs, const SymbolNameMatch& rhs)
+    {
+        return std::tie(lhs.distance, lhs.name) < std::tie(rhs.distance, rhs.name);
+    });
+}
+
+bool SymbolNameIndex::FindCandidates(const std::vector<std::string>& parts, std::vector<uint32_t>& candidates) const
+{
+    std::vector<uint32_t> trigrams;
+
+    for (const auto& part : parts)
+    {
+        GetTrigrams(part, trigrams);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    if (trigrams.empty())
+    {
+        return false;
+    }
+
+    std::vector<std::pair<const uint32_t*, const uint32_t*>> postings;
+
+    for (const auto trigram : trigrams)
+    {
+        const uint32_t* begin = nullptr;
+        const uint32_t* end = nullptr;
+
+        if (!GetPostings(trigram, begin, end))
+        {
+            return true;
+        }
+
+        postings.emplace_back(begin, end);
+    }
+
+    // Intersect starting with the shortest list.
+    std::sort(postings.begin(), postings.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.second - lhs.first < rhs.second - rhs.first;
+    });
+
+    candidates.assign(postings.front().first, postings.front().second);
+
+    std::vector<uint32_t> intersection;
+
+    for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i)
+    {
+        intersection.clear();
+        std::set_intersection(
+            candidates.begin(), candidates.end(),
+            postings[i].first, postings[i].second,
+            std::back_inserter(intersection));
+
+        candidates.swap(intersection);
+    }
+
+    return true;
+}
+
+bool SymbolNameIndex::GetPostings(uint32_t trigram, const uint32_t*& begin, const uint32_t*& end) const
+{
+    const auto it = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+    if (it == m_trigrams.end() || *it != trigram)
+    {
+        return false;
+    }
+
+    const size_t index = it - m_trigrams.begin();
+    begin = m_postings.data() + m_postingOffsets[index];
+    end = m_postings.data() + m_postingOffsets[index + 1];
+    return true;
+}
+
+void SymbolNameIndex::AddMatch(uint32_t name, unsigned distance, std::vector<SymbolNameMatch>& matches) const
+{
+    matches.push_back({ m_names[name].name, m_names[name].isFunction, distance });
+}
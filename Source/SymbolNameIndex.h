@@ -0,0 +1,66 @@
+#pragma once
+#include "PDB.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Case-insensitive search over the names of decoded types (UDTs, enums
+// and typedefs) and public symbols.
+//
+// Names are kept sorted by their lowercase form, so prefix searches are a
+// binary search. Substring, glob and fuzzy searches use a trigram index:
+// for every trigram, the sorted list of names containing it. A substring
+// or glob only has to check the names containing all of its trigrams,
+// and a name within edit distance k of the query contains at least
+// (trigrams of the query - 3k) of them. Queries too short to have a
+// usable trigram fall back to checking every name.
+//
+class SymbolNameIndex
+{
+public:
+    // Builds the index unless it is built already. After that, searches
+    // may run concurrently.
+    void Build(const SymbolMap& symbolMap, const FunctionSet& functionSet);
+
+    void Search(const std::string& pattern, SymbolNameSearch search, unsigned maxDistance, std::vector<SymbolNameMatch>& matches) const;
+
+    void Clear();
+
+    // '*' matches any run of characters and '?' any single character.
+    static bool MatchGlob(const char* pattern, const char* text);
+
+private:
+    struct Name
+    {
+        std::string name;
+        std::string folded;
+        bool isFunction;
+    };
+
+    void SearchPrefix(const std::string& prefix, std::vector<SymbolNameMatch>& matches) const;
+    void SearchSubstring(const std::string& substring, std::vector<SymbolNameMatch>& matches) const;
+    void SearchGlob(const std::string& glob, std::vector<SymbolNameMatch>& matches) const;
+    void SearchFuzzy(const std::string& text, unsigned maxDistance, std::vector<SymbolNameMatch>& matches) const;
+
+    // Names containing all trigrams of every part, ascending; false if no
+    // part is long enough to have a trigram.
+    bool FindCandidates(const std::vector<std::string>& parts, std::vector<uint32_t>& candidates) const;
+
+    bool GetPostings(uint32_t trigram, const uint32_t*& begin, const uint32_t*& end) const;
+
+    void AddMatch(uint32_t name, unsigned distance, std::vector<SymbolNameMatch>& matches) const;
+
+private:
+    std::mutex m_mutex;
+    bool m_built = false;
+
+    // Sorted by folded name.
+    std::vector<Name> m_names;
+
+    // Postings of m_trigrams[i] are m_postings[m_postingOffsets[i] .. m_postingOffsets[i + 1]).
+    std::vector<uint32_t> m_trigrams;
+    std::vector<uint32_t> m_postingOffsets;
+    std::vector<uint32_t> m_postings;
+};
@@ -0,0 +1,712 @@
+#include "SymbolOffsetHistory.h"
+#include "PDBLayoutFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <set>
+
+namespace
+{
+    // Average builds per perfect hash bucket.
+    const uint32_t BuildsPerBucket = 4;
+
+    // Seeds tried per bucket before giving up; buckets of a few keys take
+    // a handful.
+    const uint32_t MaxBuildSeed = 1u << 24;
+
+    uint64_t Mix(uint64_t value)
+    {
+        // splitmix64 finalizer
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    // Tables start at 8-byte boundaries.
+    const uint64_t TableAlignment = 8;
+
+    uint64_t AlignTable(uint64_t offset)
+    {
+        return (offset + TableAlignment - 1) & ~(TableAlignment - 1);
+    }
+
+    // Returns the offset of a table placed at fileSize and moves fileSize
+    // past it.
+    template<typename T>
+    uint64_t PlaceTable(uint64_t& fileSize, const std::vector<T>& table)
+    {
+        const uint64_t offset = fileSize;
+        fileSize = AlignTable(fileSize + table.size() * sizeof(T));
+        return offset;
+    }
+
+    void WritePadding(std::ofstream& output, uint64_t size)
+    {
+        const char zeros[TableAlignment] = {};
+        output.write(zeros, AlignTable(size) - size);
+    }
+
+    template<typename T>
+    void WriteTable(std::ofstream& output, const std::vector<T>& table)
+    {
+        output.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(T));
+        WritePadding(output, table.size() * sizeof(T));
+    }
+}
+
+bool SymbolOffsetHistoryWriter::AddBuild(size_t order, PDB& pdb)
+{
+    Build build;
+    if (!pdb.GetSignature(build.guid, build.age))
+    {
+        return false;
+    }
+
+    build.pdbName = pdb.GetPath().filename().string();
+
+    SymbolTypeMap types;
+    SymbolTypeDiff::CollectTypes(pdb.GetSymbolMap(), types);
+
+    std::vector<SymbolTypeDiffField> fields;
+
+    for (const auto&[name, udt] : types)
+    {
+        // Decoded outside the lock, and compared with the layout already
+        // kept for the hash.
+        fields.clear();
+        SymbolTypeDiff::GetFields(*udt, fields);
+
+        //
+        // A hash hit is only taken when the kept layout has the same fields.
+        // A layout whose hash collides with a different one is keyed by the
+        // next hash value not taken by another layout.
+        //
+        uint64_t hash = SymbolTypeDiff::GetStructuralHash(*udt);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (;; ++hash)
+            {
+                auto [it, inserted] = m_layouts.try_emplace(hash);
+                if (inserted)
+                {
+                    it->second = std::move(fields);
+                    break;
+                }
+
+                if (it->second == fields)
+                {
+                    break;
+                }
+            }
+        }
+
+        build.types.emplace_back(name, hash);
+    }
+
+    std::sort(build.types.begin(), build.types.end());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_builds.emplace(order, std::move(build));
+
+    return true;
+}
+
+bool SymbolOffsetHistoryWriter::Write(const std::filesystem::path& path) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //
+    // The same PDB given twice is one build.
+    //
+    std::vector<const Build*> builds;
+    std::set<std::string> signatures;
+
+    for (const auto&[_, build] : m_builds)
+    {
+        if (signatures.insert(PDB::GetSignatureString(build.guid, build.age)).second)
+        {
+            builds.push_back(&build);
+        }
+    }
+
+    //
+    // Field paths, interned once per distinct (type name, layout) and then
+    // numbered in name order.
+    //
+    std::map<std::pair<std::string_view, uint64_t>, std::vector<uint32_t>> typePaths;
+    std::unordered_map<std::string, uint32_t> pathIds;
+    std::vector<const std::string*> pathNames;
+
+    for (const auto* build : builds)
+    {
+        for (const auto&[name, hash] : build->types)
+        {
+            auto [it, inserted] = typePaths.try_emplace({ name, hash });
+            if (!inserted)
+            {
+                continue;
+            }
+
+            for (const auto& field : m_layouts.at(hash))
+            {
+                auto [pathIt, isNewPath] = pathIds.emplace(name + '.' + field.path, static_cast<uint32_t>(pathNames.size()));
+                if (isNewPath)
+                {
+                    pathNames.push_back(&pathIt->first);
+                }
+
+                it->second.push_back(pathIt->second);
+            }
+        }
+    }
+
+    std::vector<uint32_t> pathOrder(pathNames.size());
+    std::iota(pathOrder.begin(), pathOrder.end(), 0);
+    std::sort(pathOrder.begin(), pathOrder.end(), [&pathNames](uint32_t lhs, uint32_t rhs)
+    {
+        return *pathNames[lhs] < *pathNames[rhs];
+    });
+
+    std::vector<uint32_t> pathIndexes(pathNames.size());
+    for (uint32_t i = 0; i < pathOrder.size(); ++i)
+    {
+        pathIndexes[pathOrder[i]] = i;
+    }
+
+    //
+    // Per-build entries, and the runs of every path over the builds.
+    //
+    std::string strings;
+    std::vector<SymbolOffsetHistoryBuild> buildTable;
+    std::vector<SymbolOffsetHistoryEntry> entryTable;
+    std::vector<std::vector<SymbolOffsetHistoryRun>> pathRuns(pathNames.size());
+
+    for (uint32_t buildIndex = 0; buildIndex < builds.size(); ++buildIndex)
+    {
+        const auto* build = builds[buildIndex];
+
+        SymbolOffsetHistoryBuild buildRecord = {};
+        buildRecord.guid = build->guid;
+        buildRecord.age = build->age;
+        buildRecord.pdbNameOffset = static_cast<uint32_t>(strings.size());
+        buildRecord.firstEntry = entryTable.size();
+
+        strings += build->pdbName;
+        strings += '\0';
+
+        const size_t firstEntry = entryTable.size();
+
+        for (const auto&[name, hash] : build->types)
+        {
+            const auto& fields = m_layouts.at(hash);
+            const auto& ids = typePaths.at({ name, hash });
+
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                entryTable.push_back({ pathIndexes[ids[i]], static_cast<uint32_t>(fields[i].offset), static_cast<uint32_t>(fields[i].size) });
+            }
+        }
+
+        // A path seen twice in one type keeps its first member.
+        std::stable_sort(entryTable.begin() + firstEntry, entryTable.end(), [](const SymbolOffsetHistoryEntry& lhs, const SymbolOffsetHistoryEntry& rhs)
+        {
+            return lhs.path < rhs.path;
+        });
+
+        entryTable.erase(std::unique(entryTable.begin() + firstEntry, entryTable.end(), [](const SymbolOffsetHistoryEntry& lhs, const SymbolOffsetHistoryEntry& rhs)
+        {
+            return lhs.path == rhs.path;
+        }), entryTable.end());
+
+        for (size_t i = firstEntry; i < entryTable.size(); ++i)
+        {
+            const auto& entry = entryTable[i];
+            auto& runs = pathRuns[entry.path];
+
+            if (!runs.empty() &&
+                runs.back().firstBuild + runs.back().buildCount == buildIndex &&
+                runs.back().offset == entry.offset &&
+                runs.back().size == entry.size)
+            {
+                ++runs.back().buildCount;
+            }
+            else
+            {
+                runs.push_back({ buildIndex, 1, entry.offset, entry.size });
+            }
+        }
+
+        buildRecord.entryCount = static_cast<uint32_t>(entryTable.size() - firstEntry);
+        buildTable.push_back(buildRecord);
+    }
+
+    std::vector<SymbolOffsetHistoryPath> pathTable;
+    std::vector<SymbolOffsetHistoryRun> runTable;
+
+    for (uint32_t i = 0; i < pathOrder.size(); ++i)
+    {
+        const auto& name = *pathNames[pathOrder[i]];
+
+        SymbolOffsetHistoryPath pathRecord;
+        pathRecord.nameOffset = static_cast<uint32_t>(strings.size());
+        pathRecord.nameHash = PDBLayoutHashName(name.data(), name.size());
+        pathRecord.firstRun = static_cast<uint32_t>(runTable.size());
+        pathRecord.runCount = static_cast<uint32_t>(pathRuns[i].size());
+
+        strings += name;
+        strings += '\0';
+
+        runTable.insert(runTable.end(), pathRuns[i].begin(), pathRuns[i].end());
+        pathTable.push_back(pathRecord);
+    }
+
+    uint32_t pathBucketCount = 1;
+    while (pathBucketCount < pathTable.size() * 2)
+    {
+        pathBucketCount <<= 1;
+    }
+
+    std::vector<uint32_t> pathHashTable(pathBucketCount, SymbolOffsetHistoryInvalidIndex);
+    for (uint32_t i = 0; i < pathTable.size(); ++i)
+    {
+        uint32_t bucket = pathTable[i].nameHash & (pathBucketCount - 1);
+        while (pathHashTable[bucket] != SymbolOffsetHistoryInvalidIndex)
+        {
+            bucket = (bucket + 1) & (pathBucketCount - 1);
+        }
+
+        pathHashTable[bucket] = i;
+    }
+
+    //
+    // Minimal perfect hash over the builds: the largest buckets are placed
+    // first, each with the first seed sending all of its keys to free slots.
+    //
+    const auto buildCount = static_cast<uint32_t>(buildTable.size());
+    const uint32_t buildBucketCount = (std::max)((buildCount + BuildsPerBucket - 1) / BuildsPerBucket, 1u);
+
+    std::vector<std::vector<uint32_t>> buckets(buildBucketCount);
+    for (uint32_t i = 0; i < buildCount; ++i)
+    {
+        const uint64_t key = GetBuildKey(buildTable[i].guid, buildTable[i].age);
+        buckets[GetBuildBucket(key, buildBucketCount)].push_back(i);
+    }
+
+    std::vector<uint32_t> bucketOrder(buildBucketCount);
+    std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](uint32_t lhs, uint32_t rhs)
+    {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<uint32_t> buildSeeds(buildBucketCount, 0);
+    std::vector<uint32_t> buildSlots(buildCount, SymbolOffsetHistoryInvalidIndex);
+
+    for (const auto bucket : bucketOrder)
+    {
+        if (buckets[bucket].empty())
+        {
+            break;
+        }
+
+        std::vector<uint32_t> slots;
+        uint32_t seed = 1;
+
+        for (; seed < MaxBuildSeed; ++seed)
+        {
+            slots.clear();
+
+            for (const auto buildIndex : buckets[bucket])
+            {
+                const uint32_t slot = GetBuildSlot(GetBuildKey(buildTable[buildIndex].guid, buildTable[buildIndex].age), seed, buildCount);
+
+                if (buildSlots[slot] != SymbolOffsetHistoryInvalidIndex ||
+                    std::find(slots.begin(), slots.end(), slot) != slots.end())
+                {
+                    break;
+                }
+
+                slots.push_back(slot);
+            }
+
+            if (slots.size() == buckets[bucket].size())
+            {
+                break;
+            }
+        }
+
+        if (seed == MaxBuildSeed)
+        {
+            return false;
+        }
+
+        buildSeeds[bucket] = seed;
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            buildSlots[slots[i]] = buckets[bucket][i];
+        }
+    }
+
+    //
+    // Tables follow the header in order, each 8-byte aligned. Their offsets
+    // are known up front, so the header and the tables are written straight
+    // to the file.
+    //
+    SymbolOffsetHistoryHeader header = {};
+    memcpy(header.magic, SymbolOffsetHistoryMagic, sizeof(SymbolOffsetHistoryMagic));
+    header.version = SymbolOffsetHistoryVersion;
+    header.headerSize = sizeof(header);
+    header.buildCount = buildCount;
+    header.buildBucketCount = buildBucketCount;
+    header.pathCount = static_cast<uint32_t>(pathTable.size());
+    header.pathBucketCount = pathBucketCount;
+    header.runCount = static_cast<uint32_t>(runTable.size());
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.entryCount = entryTable.size();
+
+    uint64_t fileSize = AlignTable(sizeof(header));
+
+    header.buildTableOffset = PlaceTable(fileSize, buildTable);
+    header.buildSeedTableOffset = PlaceTable(fileSize, buildSeeds);
+    header.buildSlotTableOffset = PlaceTable(fileSize, buildSlots);
+    header.pathTableOffset = PlaceTable(fileSize, pathTable);
+    header.pathHashTableOffset = PlaceTable(fileSize, pathHashTable);
+    header.runTableOffset = PlaceTable(fileSize, runTable);
+    header.entryTableOffset = PlaceTable(fileSize, entryTable);
+    header.stringTableOffset = fileSize;
+
+    std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(output, sizeof(header));
+
+    WriteTable(output, buildTable);
+    WriteTable(output, buildSeeds);
+    WriteTable(output, buildSlots);
+    WriteTable(output, pathTable);
+    WriteTable(output, pathHashTable);
+    WriteTable(output, runTable);
+    WriteTable(output, entryTable);
+    output.write(strings.data(), strings.size());
+
+    return static_cast<bool>(output.flush());
+}
+
+uint64_t SymbolOffsetHistoryWriter::GetBuildKey(const GUID& guid, DWORD age)
+{
+    uint64_t words[2];
+    memcpy(words, &guid, sizeof(words));
+
+    return Mix(words[0] ^ Mix(words[1] ^ Mix(age)));
+}
+
+uint32_t SymbolOffsetHistoryWriter::GetBuildBucket(uint64_t key, uint32_t bucketCount)
+{
+    return static_cast<uint32_t>(key % bucketCount);
+}
+
+uint32_t SymbolOffsetHistoryWriter::GetBuildSlot(uint64_t key, uint32_t seed, uint32_t buildCount)
+{
+    return static_cast<uint32_t>(Mix(key + seed * 0x9e3779b97f4a7c15ull) % buildCount);
+}
+
+SymbolOffsetHistoryReader::~SymbolOffsetHistoryReader()
+{
+    Close();
+}
+
+bool SymbolOffsetHistoryReader::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    m_file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(SymbolOffsetHistoryHeader)))
+    {
+        Close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view)
+    {
+        Close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<const SymbolOffsetHistoryHeader*>(m_view);
+
+    if (!Validate())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void SymbolOffsetHistoryReader::Close()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+    m_size = 0;
+    m_header = nullptr;
+}
+
+bool SymbolOffsetHistoryReader::IsOpen() const
+{
+    return m_header != nullptr;
+}
+
+uint32_t SymbolOffsetHistoryReader::GetBuildCount() const
+{
+    return m_header ? m_header->buildCount : 0;
+}
+
+const SymbolOffsetHistoryBuild* SymbolOffsetHistoryReader::GetBuild(uint32_t buildIndex) const
+{
+    return buildIndex < GetBuildCount()
+        ? reinterpret_cast<const SymbolOffsetHistoryBuild*>(m_view + m_header->buildTableOffset) + buildIndex
+        : nullptr;
+}
+
+const SymbolOffsetHistoryPath* SymbolOffsetHistoryReader::GetPath(uint32_t pathIndex) const
+{
+    return m_header && pathIndex < m_header->pathCount
+        ? reinterpret_cast<const SymbolOffsetHistoryPath*>(m_view + m_header->pathTableOffset) + pathIndex
+        : nullptr;
+}
+
+const char* SymbolOffsetHistoryReader::GetString(uint32_t stringOffset) const
+{
+    return m_header && stringOffset < m_header->stringTableSize
+        ? reinterpret_cast<const char*>(m_view + m_header->stringTableOffset) + stringOffset
+        : "";
+}
+
+uint32_t SymbolOffsetHistoryReader::FindBuild(const GUID& guid, DWORD age) const
+{
+    if (GetBuildCount() == 0)
+    {
+        return SymbolOffsetHistoryInvalidIndex;
+    }
+
+    const auto* seeds = reinterpret_cast<const uint32_t*>(m_view + m_header->buildSeedTableOffset);
+    const auto* slots = reinterpret_cast<const uint32_t*>(m_view + m_header->buildSlotTableOffset);
+
+    const uint64_t key = SymbolOffsetHistoryWriter::GetBuildKey(guid, age);
+    const uint32_t seed = seeds[SymbolOffsetHistoryWriter::GetBuildBucket(key, m_header->buildBucketCount)];
+    const uint32_t buildIndex = slots[SymbolOffsetHistoryWriter::GetBuildSlot(key, seed, m_header->buildCount)];
+
+    // Keys outside the set land on some build too.
+    const auto* build = GetBuild(buildIndex);
+    if (!build || build->age != age || memcmp(&build->guid, &guid, sizeof(GUID)) != 0)
+    {
+        return SymbolOffsetHistoryInvalidIndex;
+    }
+
+    return buildIndex;
+}
+
+const SymbolOffsetHistoryPath* SymbolOffsetHistoryReader::FindPath(std::string_view path) const
+{
+    if (!m_header)
+    {
+        return nullptr;
+    }
+
+    const auto* hashTable = reinterpret_cast<const uint32_t*>(m_view + m_header->pathHashTableOffset);
+    const uint32_t hash = PDBLayoutHashName(path.data(), path.size());
+    const uint32_t mask = m_header->pathBucketCount - 1;
+
+    for (uint32_t bucket = hash & mask; hashTable[bucket] != SymbolOffsetHistoryInvalidIndex; bucket = (bucket + 1) & mask)
+    {
+        const auto* pathRecord = GetPath(hashTable[bucket]);
+        if (pathRecord && pathRecord->nameHash == hash && path == GetString(pathRecord->nameOffset))
+        {
+            return pathRecord;
+        }
+    }
+
+    return nullptr;
+}
+
+bool SymbolOffsetHistoryReader::GetOffset(uint32_t buildIndex, const SymbolOffsetHistoryPath& path, uint32_t& offset, uint32_t& size) const
+{
+    const auto* runs = reinterpret_cast<const SymbolOffsetHistoryRun*>(m_view + m_header->runTableOffset) + path.firstRun;
+
+    const auto* run = std::upper_bound(runs, runs + path.runCount, buildIndex, [](uint32_t value, const SymbolOffsetHistoryRun& run)
+    {
+        return value < run.firstBuild;
+    });
+
+    if (run == runs || buildIndex - (run - 1)->firstBuild >= (run - 1)->buildCount)
+    {
+        return false;
+    }
+
+    offset = (run - 1)->offset;
+    size = (run - 1)->size;
+    return true;
+}
+
+const SymbolOffsetHistoryEntry* SymbolOffsetHistoryReader::GetEntries(uint32_t buildIndex, uint32_t& entryCount) const
+{
+    const auto* build = GetBuild(buildIndex);
+    if (!build)
+    {
+        entryCount = 0;
+        return nullptr;
+    }
+
+    entryCount = build->entryCount;
+    return reinterpret_cast<const SymbolOffsetHistoryEntry*>(m_view + m_header->entryTableOffset) + build->firstEntry;
+}
+
+bool SymbolOffsetHistoryReader::Validate() const
+{
+    const auto& header = *m_header;
+
+    if (memcmp(header.magic, SymbolOffsetHistoryMagic, sizeof(SymbolOffsetHistoryMagic)) != 0 ||
+        header.version != SymbolOffsetHistoryVersion ||
+        header.headerSize < sizeof(SymbolOffsetHistoryHeader) ||
+        header.buildBucketCount == 0 ||
+        header.pathBucketCount == 0 ||
+        (header.pathBucketCount & (header.pathBucketCount - 1)) != 0)
+    {
+        return false;
+    }
+
+    auto fits = [this](uint64_t offset, uint64_t size)
+    {
+        return offset <= m_size && size <= m_size - offset;
+    };
+
+    if (!fits(header.buildTableOffset, uint64_t{ header.buildCount } * sizeof(SymbolOffsetHistoryBuild)) ||
+        !fits(header.buildSeedTableOffset, uint64_t{ header.buildBucketCount } * sizeof(uint32_t)) ||
+        !fits(header.buildSlotTableOffset, uint64_t{ header.buildCount } * sizeof(uint32_t)) ||
+        !fits(header.pathTableOffset, uint64_t{ header.pathCount } * sizeof(SymbolOffsetHistoryPath)) ||
+        !fits(header.pathHashTableOffset, uint64_t{ header.pathBucketCount } * sizeof(uint32_t)) ||
+        !fits(header.runTableOffset, uint64_t{ header.runCount } * sizeof(SymbolOffsetHistoryRun)) ||
+        header.entryCount > m_size ||
+        !fits(header.entryTableOffset, header.entryCount * sizeof(SymbolOffsetHistoryEntry)) ||
+        !fits(header.stringTableOffset, header.stringTableSize))
+    {
+        return false;
+    }
+
+    // Every string must be terminated inside the table.
+    if (header.stringTableSize != 0 && m_view[header.stringTableOffset + header.stringTableSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    //
+    // Lookups index the tables with the values stored in the records
+    // without checking them, so every record is checked once here.
+    //
+
+    const auto* builds = reinterpret_cast<const SymbolOffsetHistoryBuild*>(m_view + header.buildTableOffset);
+    const auto* paths = reinterpret_cast<const SymbolOffsetHistoryPath*>(m_view + header.pathTableOffset);
+    const auto* pathHashTable = reinterpret_cast<const uint32_t*>(m_view + header.pathHashTableOffset);
+    const auto* entries = reinterpret_cast<const SymbolOffsetHistoryEntry*>(m_view + header.entryTableOffset);
+
+    for (uint32_t i = 0; i < header.buildCount; ++i)
+    {
+        const auto& build = builds[i];
+
+        if (build.pdbNameOffset >= header.stringTableSize ||
+            build.firstEntry > header.entryCount ||
+            build.entryCount > header.entryCount - build.firstEntry)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.pathCount; ++i)
+    {
+        const auto& path = paths[i];
+
+        if (path.nameOffset >= header.stringTableSize ||
+            uint64_t{ path.firstRun } + path.runCount > header.runCount)
+        {
+            return false;
+        }
+    }
+
+    // A lookup miss probes until it reaches a free bucket, so there must be
+    // one.
+    uint32_t freeBucketCount = 0;
+
+    for (uint32_t bucket = 0; bucket < header.pathBucketCount; ++bucket)
+    {
+        if (pathHashTable[bucket] == SymbolOffsetHistoryInvalidIndex)
+        {
+            ++freeBucketCount;
+        }
+        else if (pathHashTable[bucket] >= header.pathCount)
+        {
+            return false;
+        }
+    }
+
+    if (freeBucketCount == 0)
+    {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < header.entryCount; ++i)
+    {
+        if (entries[i].path >= header.pathCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include "PDB.h"
+#include "SymbolTypeDiff.h"
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string_view>
+
+//
+// On-disk layout of a field offset history (-B -X). All integers are
+// little endian and all table offsets are relative to the start of the
+// file, so the file is mapped and used in place. Strings are NUL-terminated
+// and addressed by their offset inside the string table.
+//
+// Builds are numbered in the order they were given. Every field path
+// ("_EPROCESS.Token") has a series of runs, each covering consecutive
+// builds in which the field has the same offset and size; builds lacking
+// the field end a run. Every build also has its own entries, one per field
+// path in path order, so all offsets of one build are a single sequential
+// read.
+//
+// Builds are found by GUID and age through a minimal perfect hash: the key
+// picks a bucket, the bucket's seed picks the slot, and the slot names the
+// build.
+//
+
+static const char SymbolOffsetHistoryMagic[8] = { 'P', 'D', 'B', 'X', 'O', 'F', 'F', 'S' };
+static const uint32_t SymbolOffsetHistoryVersion = 1;
+static const uint32_t SymbolOffsetHistoryInvalidIndex = 0xffffffff;
+
+#pragma pack(push, 4)
+
+struct SymbolOffsetHistoryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t buildCount;
+    uint32_t buildBucketCount;
+    uint32_t pathCount;
+    uint32_t pathBucketCount;           // power of two
+    uint32_t runCount;
+    uint32_t stringTableSize;
+    uint64_t entryCount;
+    uint64_t buildTableOffset;          // SymbolOffsetHistoryBuild[buildCount]
+    uint64_t buildSeedTableOffset;      // uint32_t[buildBucketCount]
+    uint64_t buildSlotTableOffset;      // uint32_t[buildCount], build index
+    uint64_t pathTableOffset;           // SymbolOffsetHistoryPath[pathCount], sorted by name
+    uint64_t pathHashTableOffset;       // uint32_t[pathBucketCount], path index or SymbolOffsetHistoryInvalidIndex
+    uint64_t runTableOffset;            // SymbolOffsetHistoryRun[runCount]
+    uint64_t entryTableOffset;          // SymbolOffsetHistoryEntry[entryCount]
+    uint64_t stringTableOffset;
+};
+
+struct SymbolOffsetHistoryBuild
+{
+    GUID guid;
+    uint32_t age;
+    uint32_t pdbNameOffset;
+    uint64_t firstEntry;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct SymbolOffsetHistoryPath
+{
+    uint32_t nameOffset;
+    uint32_t nameHash;
+    uint32_t firstRun;
+    uint32_t runCount;
+};
+
+struct SymbolOffsetHistoryRun
+{
+    uint32_t firstBuild;
+    uint32_t buildCount;
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct SymbolOffsetHistoryEntry
+{
+    uint32_t path;
+    uint32_t offset;
+    uint32_t size;
+};
+
+#pragma pack(pop)
+
+//
+// Collects the field layouts of many PDBs and writes their history.
+// Layouts are kept once per structural hash, so builds sharing most of
+// their types cost little more than one. A hash hit is confirmed by
+// comparing the fields; colliding layouts are kept under distinct keys.
+//
+class SymbolOffsetHistoryWriter
+{
+public:
+    // Thread-safe; builds are numbered by order, not by the order of the
+    // calls. Needs a fully loaded PDB.
+    bool AddBuild(size_t order, PDB& pdb);
+
+    bool Write(const std::filesystem::path& path) const;
+
+    static uint64_t GetBuildKey(const GUID& guid, DWORD age);
+    static uint32_t GetBuildBucket(uint64_t key, uint32_t bucketCount);
+    static uint32_t GetBuildSlot(uint64_t key, uint32_t seed, uint32_t buildCount);
+
+private:
+    struct Build
+    {
+        GUID guid;
+        DWORD age;
+        std::string pdbName;
+
+        // Type name and structural hash, sorted by name.
+        std::vector<std::pair<std::string, uint64_t>> types;
+    };
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<size_t, Build> m_builds;
+    std::unordered_map<uint64_t, std::vector<SymbolTypeDiffField>> m_layouts;
+};
+
+//
+// Read-only view of a field offset history. Nothing is parsed up front;
+// lookups read the mapped file in place. Opening checks every record once,
+// so that lookups can follow the indexes and string offsets in the file
+// without checking them again.
+//
+class SymbolOffsetHistoryReader
+{
+public:
+    SymbolOffsetHistoryReader() = default;
+    ~SymbolOffsetHistoryReader();
+
+    SymbolOffsetHistoryReader(const SymbolOffsetHistoryReader&) = delete;
+    SymbolOffsetHistoryReader& operator=(const SymbolOffsetHistoryReader&) = delete;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+    bool IsOpen() const;
+
+    uint32_t GetBuildCount() const;
+    const SymbolOffsetHistoryBuild* GetBuild(uint32_t buildIndex) const;
+    const SymbolOffsetHistoryPath* GetPath(uint32_t pathIndex) const;
+    const char* GetString(uint32_t stringOffset) const;
+
+    // Build index, or SymbolOffsetHistoryInvalidIndex.
+    uint32_t FindBuild(const GUID& guid, DWORD age) const;
+    const SymbolOffsetHistoryPath* FindPath(std::string_view path) const;
+
+    bool GetOffset(uint32_t buildIndex, const SymbolOffsetHistoryPath& path, uint32_t& offset, uint32_t& size) const;
+
+    // Every field of one build, in path order.
+    const SymbolOffsetHistoryEntry* GetEntries(uint32_t buildIndex, uint32_t& entryCount) const;
+
+private:
+    bool Validate() const;
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    uint64_t m_size = 0;
+
+    const SymbolOffsetHistoryHeader* m_header = nullptr;
+};
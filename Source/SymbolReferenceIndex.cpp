@@ -0,0 +1,227 @@
+#include "SymbolReferenceIndex.h"
+
+void SymbolReferenceIndex::Build(const SymbolMap& symbolMap)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_built)
+    {
+        return;
+    }
+
+    for (const auto&[_, symbol] : symbolMap)
+    {
+        if (symbol->tag == SymTagUDT || symbol->tag == SymTagEnum)
+        {
+            AddNode(*symbol);
+        }
+    }
+
+    std::vector<PendingEdge> pendingEdges;
+
+    for (const auto&[_, symbol] : symbolMap)
+    {
+        if (!std::holds_alternative<SymbolUdt>(symbol->variant))
+        {
+            continue;
+        }
+
+        const uint32_t source = m_nodeBySymbol.at(symbol.get());
+
+        for (const auto& field : std::get<SymbolUdt>(symbol->variant).fields)
+        {
+            if (!field.type)
+            {
+                continue;
+            }
+
+            if (field.isBaseClass)
+            {
+                AddEdges(field.type.get(), SymbolReferenceKind::BaseClass, source, field, pendingEdges);
+            }
+            else if ((field.tag == SymTagData && field.dataKind != DataIsStaticMember) || field.tag == SymTagFunction)
+            {
+                // Member functions resolve to their arguments.
+                AddEdges(field.type.get(), SymbolReferenceKind::ByValue, source, field, pendingEdges);
+            }
+        }
+    }
+
+    //
+    // Group the edges by target: count, prefix sum, scatter.
+    //
+
+    m_edgeOffsets.assign(m_nodes.size() + 1, 0);
+
+    for (const auto& pendingEdge : pendingEdges)
+    {
+        ++m_edgeOffsets[pendingEdge.target + 1];
+    }
+
+    for (size_t i = 1; i < m_edgeOffsets.size(); ++i)
+    {
+        m_edgeOffsets[i] += m_edgeOffsets[i - 1];
+    }
+
+    std::vector<uint32_t> nextEdge(m_edgeOffsets.begin(), m_edgeOffsets.end() - 1);
+    m_edges.resize(pendingEdges.size());
+
+    for (const auto& pendingEdge : pendingEdges)
+    {
+        m_edges[nextEdge[pendingEdge.target]++] = pendingEdge.edge;
+    }
+
+    m_built = true;
+}
+
+void SymbolReferenceIndex::FindReferences(const Symbol& type, std::vector<SymbolReference>& references) const
+{
+    uint32_t node = 0;
+    if (!FindNode(type, node))
+    {
+        return;
+    }
+
+    for (uint32_t i = m_edgeOffsets[node]; i < m_edgeOffsets[node + 1]; ++i)
+    {
+        const auto& edge = m_edges[i];
+        references.push_back({ edge.field->parent ? edge.field->parent : m_nodes[edge.source], edge.field, edge.kind });
+    }
+}
+
+void SymbolReferenceIndex::FindDependents(const Symbol& type, unsigned kinds, std::vector<const Symbol*>& dependents) const
+{
+    uint32_t node = 0;
+    if (!FindNode(type, node))
+    {
+        return;
+    }
+
+    std::vector<bool> visited(m_nodes.size());
+    std::vector<uint32_t> queue = { node };
+
+    visited[node] = true;
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const uint32_t target = queue[head];
+
+        for (uint32_t i = m_edgeOffsets[target]; i < m_edgeOffsets[target + 1]; ++i)
+        {
+            const auto& edge = m_edges[i];
+            if (!(kinds & SymbolReferenceKindBit(edge.kind)) || visited[edge.source])
+            {
+                continue;
+            }
+
+            visited[edge.source] = true;
+            queue.push_back(edge.source);
+            dependents.push_back(m_nodes[edge.source]);
+        }
+    }
+}
+
+void SymbolReferenceIndex::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_built = false;
+    m_nodes.clear();
+    m_nodeBySymbol.clear();
+    m_nodeByName.clear();
+    m_edgeOffsets.clear();
+    m_edges.clear();
+}
+
+uint32_t SymbolReferenceIndex::AddNode(const Symbol& symbol)
+{
+    const auto node = static_cast<uint32_t>(m_nodes.size());
+
+    if (!symbol.name.empty() && !PDB::IsUnnamedSymbol(symbol))
+    {
+        auto [it, inserted] = m_nodeByName.emplace(symbol.name, node);
+        if (!inserted)
+        {
+            auto& representative = m_nodes[it->second];
+            if (representative->size == 0 && symbol.size != 0)
+            {
+                representative = &symbol;
+            }
+
+            m_nodeBySymbol.emplace(&symbol, it->second);
+            return it->second;
+        }
+    }
+
+    m_nodes.push_back(&symbol);
+    m_nodeBySymbol.emplace(&symbol, node);
+    return node;
+}
+
+bool SymbolReferenceIndex::FindNode(const Symbol& symbol, uint32_t& node) const
+{
+    auto it = m_nodeBySymbol.find(&symbol);
+    if (it != m_nodeBySymbol.end())
+    {
+        node = it->second;
+        return true;
+    }
+
+    auto nameIt = m_nodeByName.find(symbol.name);
+    if (symbol.name.empty() || nameIt == m_nodeByName.end())
+    {
+        return false;
+    }
+
+    node = nameIt->second;
+    return true;
+}
+
+void SymbolReferenceIndex::AddEdges(
+    const Symbol* type,
+    SymbolReferenceKind kind,
+    uint32_t source,
+    const SymbolUdtField& field,
+    std::vector<PendingEdge>& pendingEdges) const
+{
+    while (type)
+    {
+        if (const auto* symbolTypedef = std::get_if<SymbolTypedef>(&type->variant))
+        {
+            type = symbolTypedef->type.get();
+        }
+        else if (const auto* argumentType = std::get_if<SymbolFunctionArgType>(&type->variant))
+        {
+            type = argumentType->type.get();
+        }
+        else if (const auto* pointer = std::get_if<SymbolPointer>(&type->variant))
+        {
+            kind = kind == SymbolReferenceKind::ByValue ? SymbolReferenceKind::Pointer : kind;
+            type = pointer->type.get();
+        }
+        else if (const auto* array = std::get_if<SymbolArray>(&type->variant))
+        {
+            kind = kind == SymbolReferenceKind::ByValue ? SymbolReferenceKind::Array : kind;
+            type = array->elementType.get();
+        }
+        else if (const auto* function = std::get_if<SymbolFunction>(&type->variant))
+        {
+            for (const auto& argument : function->arguments)
+            {
+                AddEdges(argument.type.get(), SymbolReferenceKind::FunctionArgument, source, field, pendingEdges);
+            }
+
+            return;
+        }
+        else
+        {
+            uint32_t target = 0;
+            if (FindNode(*type, target))
+            {
+                pendingEdges.push_back({ target, { source, kind, &field } });
+            }
+
+            return;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "PDB.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Reverse references between UDTs and enums, for questions like "which
+// structs embed a LIST_ENTRY" or "who points to _EPROCESS".
+//
+// Every named type is one node, whichever of its symbols (definition or
+// forward declarations) is referenced; unnamed types are nodes of their
+// own. References are resolved through typedefs, pointers and arrays
+// down to the UDT or enum they end at, and the first pointer or array on
+// the way determines the kind. Arguments of member functions and of
+// function pointers count as function argument references.
+//
+// The edges are built in one pass over the decoded symbols and stored
+// grouped by target (compressed sparse row), so the referrers of a type
+// are one contiguous range.
+//
+class SymbolReferenceIndex
+{
+public:
+    // Builds the index unless it is built already. After that, lookups
+    // may run concurrently.
+    void Build(const SymbolMap& symbolMap);
+
+    void FindReferences(const Symbol& type, std::vector<SymbolReference>& references) const;
+    void FindDependents(const Symbol& type, unsigned kinds, std::vector<const Symbol*>& dependents) const;
+
+    void Clear();
+
+private:
+    struct Edge
+    {
+        uint32_t source;
+        SymbolReferenceKind kind;
+        const SymbolUdtField* field;
+    };
+
+    struct PendingEdge
+    {
+        uint32_t target;
+        Edge edge;
+    };
+
+    uint32_t AddNode(const Symbol& symbol);
+    bool FindNode(const Symbol& symbol, uint32_t& node) const;
+
+    void AddEdges(
+        const Symbol* type,
+        SymbolReferenceKind kind,
+        uint32_t source,
+        const SymbolUdtField& field,
+        std::vector<PendingEdge>& pendingEdges) const;
+
+private:
+    std::mutex m_mutex;
+    bool m_built = false;
+
+    // Representative symbol of each node; definitions win over forward
+    // declarations.
+    std::vector<const Symbol*> m_nodes;
+    std::unordered_map<const Symbol*, uint32_t> m_nodeBySymbol;
+    std::unordered_map<std::string, uint32_t> m_nodeByName;
+
+    // Edges into node n are m_edges[m_edgeOffsets[n] .. m_edgeOffsets[n + 1]).
+    std::vector<uint32_t> m_edgeOffsets;
+    std::vector<Edge> m_edges;
+};
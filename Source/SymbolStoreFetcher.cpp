@@ -0,0 +1,513 @@
+#include "SymbolStoreFetcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+    // "RSDS"
+    const DWORD CodeViewSignatureRsds = 0x53445352;
+
+    const wchar_t* const PartialExtension = L".partial";
+    const wchar_t* const UserAgent = L"pdbex";
+
+    const size_t ReceiveBufferSize = 64 * 1024;
+
+    // Every PDB (MSF 7.00) starts with this.
+    const char MsfSignature[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0\0";
+
+    struct CodeViewRsdsHeader
+    {
+        DWORD signature;
+        GUID guid;
+        DWORD age;
+        // Followed by the NUL-terminated path of the PDB.
+    };
+
+    template<typename T>
+    bool ReadAt(std::ifstream& file, uint64_t offset, T& value)
+    {
+        file.seekg(offset);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    template<typename OPTIONAL_HEADER>
+    bool ReadDebugDirectory(std::ifstream& file, uint64_t optionalHeaderOffset, IMAGE_DATA_DIRECTORY& debugDirectory)
+    {
+        OPTIONAL_HEADER optionalHeader;
+        if (!ReadAt(file, optionalHeaderOffset, optionalHeader) ||
+            optionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_DEBUG)
+        {
+            return false;
+        }
+
+        debugDirectory = optionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG];
+        return true;
+    }
+
+    bool GetFileOffset(const std::vector<IMAGE_SECTION_HEADER>& sections, DWORD rva, DWORD& fileOffset)
+    {
+        for (const auto& section : sections)
+        {
+            const DWORD size = (std::max)(section.Misc.VirtualSize, section.SizeOfRawData);
+
+            if (rva >= section.VirtualAddress && rva - section.VirtualAddress < size)
+            {
+                fileOffset = rva - section.VirtualAddress + section.PointerToRawData;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool QueryHeader(HINTERNET request, DWORD infoLevel, std::wstring& value)
+    {
+        wchar_t buffer[128];
+        DWORD size = sizeof(buffer);
+
+        if (!WinHttpQueryHeaders(request, infoLevel, WINHTTP_HEADER_NAME_BY_INDEX, buffer, &size, WINHTTP_NO_HEADER_INDEX))
+        {
+            return false;
+        }
+
+        value.assign(buffer, size / sizeof(wchar_t));
+        return true;
+    }
+
+    bool HasMsfSignature(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+
+        char signature[sizeof(MsfSignature) - 1];
+        return file.read(signature, sizeof(signature)) &&
+               memcmp(signature, MsfSignature, sizeof(signature)) == 0;
+    }
+
+    std::wstring ToWideString(const std::string& text)
+    {
+        std::wstring wideText(text.size() + 1, L'\0');
+        const size_t length = mbstowcs(wideText.data(), text.c_str(), wideText.size());
+        wideText.resize(length == static_cast<size_t>(-1) ? 0 : length);
+
+        return wideText;
+    }
+}
+
+std::string SymbolStoreKey::GetStorePath() const
+{
+    return pdbName + '/' + PDB::GetSignatureString(guid, age) + '/' + pdbName;
+}
+
+SymbolStoreFetcher::SymbolStoreFetcher(const std::filesystem::path& cacheDirectory, const std::string& serverUrl, size_t connectionCount)
+    : m_cacheDirectory(cacheDirectory)
+    , m_pool(connectionCount)
+{
+    const auto url = ToWideString(serverUrl);
+
+    URL_COMPONENTS components = {};
+    components.dwStructSize = sizeof(components);
+    components.dwHostNameLength = static_cast<DWORD>(-1);
+    components.dwUrlPathLength = static_cast<DWORD>(-1);
+
+    if (url.empty() || !WinHttpCrackUrl(url.c_str(), 0, 0, &components))
+    {
+        return;
+    }
+
+    m_isSecure = components.nScheme == INTERNET_SCHEME_HTTPS;
+
+    m_basePath.assign(components.lpszUrlPath, components.dwUrlPathLength);
+    if (m_basePath.empty() || m_basePath.back() != L'/')
+    {
+        m_basePath += L'/';
+    }
+
+    m_session = WinHttpOpen(UserAgent, WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+    if (!m_session)
+    {
+        return;
+    }
+
+    // The pool already bounds the requests; keep the connections to match.
+    DWORD connectionLimit = static_cast<DWORD>(m_pool.GetThreadCount());
+    WinHttpSetOption(m_session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &connectionLimit, sizeof(connectionLimit));
+
+    const std::wstring hostName(components.lpszHostName, components.dwHostNameLength);
+    m_connection = WinHttpConnect(m_session, hostName.c_str(), components.nPort, 0);
+}
+
+SymbolStoreFetcher::~SymbolStoreFetcher()
+{
+    // Downloads catch their own failures; only wait for them to finish.
+    m_pool.Wait();
+
+    if (m_connection)
+    {
+        WinHttpCloseHandle(m_connection);
+    }
+
+    if (m_session)
+    {
+        WinHttpCloseHandle(m_session);
+    }
+}
+
+bool SymbolStoreFetcher::IsOpen() const
+{
+    return m_connection != nullptr;
+}
+
+std::shared_future<SymbolStoreFetchResult> SymbolStoreFetcher::Fetch(const SymbolStoreKey& key)
+{
+    const auto storePath = key.GetStorePath();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_downloads.find(storePath);
+    if (it != m_downloads.end())
+    {
+        return it->second;
+    }
+
+    //
+    // Cached PDBs are answered right away rather than queued behind the
+    // downloads.
+    //
+    std::error_code error;
+    const auto pdbPath = m_cacheDirectory / storePath;
+
+    if (std::filesystem::is_regular_file(pdbPath, error))
+    {
+        std::promise<SymbolStoreFetchResult> cached;
+        cached.set_value(SymbolStoreFetchResult{ SymbolStoreFetchStatus::Cached, pdbPath });
+        return cached.get_future().share();
+    }
+
+    auto promise = std::make_shared<std::promise<SymbolStoreFetchResult>>();
+    auto future = promise->get_future().share();
+    m_downloads.emplace(storePath, future);
+
+    m_pool.Submit([this, key, storePath, promise]()
+    {
+        SymbolStoreFetchResult result;
+
+        try
+        {
+            result = Download(key);
+        }
+        catch (...)
+        {
+            result.status = SymbolStoreFetchStatus::Failed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_downloads.erase(storePath);
+        }
+
+        promise->set_value(std::move(result));
+    });
+
+    return future;
+}
+
+bool SymbolStoreFetcher::GetKey(const std::filesystem::path& imagePath, SymbolStoreKey& key)
+{
+    std::ifstream file(imagePath, std::ios::in | std::ios::binary);
+
+    IMAGE_DOS_HEADER dosHeader;
+    if (!ReadAt(file, 0, dosHeader) || dosHeader.e_magic != IMAGE_DOS_SIGNATURE)
+    {
+        return false;
+    }
+
+    const uint64_t fileHeaderOffset = static_cast<uint64_t>(dosHeader.e_lfanew) + sizeof(DWORD);
+    const uint64_t optionalHeaderOffset = fileHeaderOffset + sizeof(IMAGE_FILE_HEADER);
+
+    DWORD ntSignature;
+    IMAGE_FILE_HEADER fileHeader;
+    WORD optionalHeaderMagic;
+
+    if (!ReadAt(file, dosHeader.e_lfanew, ntSignature) || ntSignature != IMAGE_NT_SIGNATURE ||
+        !ReadAt(file, fileHeaderOffset, fileHeader) ||
+        !ReadAt(file, optionalHeaderOffset, optionalHeaderMagic))
+    {
+        return false;
+    }
+
+    IMAGE_DATA_DIRECTORY debugDirectory;
+
+    switch (optionalHeaderMagic)
+    {
+    case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+        if (!ReadDebugDirectory<IMAGE_OPTIONAL_HEADER32>(file, optionalHeaderOffset, debugDirectory))
+        {
+            return false;
+        }
+        break;
+
+    case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+        if (!ReadDebugDirectory<IMAGE_OPTIONAL_HEADER64>(file, optionalHeaderOffset, debugDirectory))
+        {
+            return false;
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    std::vector<IMAGE_SECTION_HEADER> sections(fileHeader.NumberOfSections);
+    file.seekg(optionalHeaderOffset + fileHeader.SizeOfOptionalHeader);
+
+    if (!file.read(reinterpret_cast<char*>(sections.data()), sections.size() * sizeof(IMAGE_SECTION_HEADER)))
+    {
+        return false;
+    }
+
+    DWORD debugDirectoryOffset;
+    if (debugDirectory.VirtualAddress == 0 || !GetFileOffset(sections, debugDirectory.VirtualAddress, debugDirectoryOffset))
+    {
+        return false;
+    }
+
+    for (DWORD i = 0; i < debugDirectory.Size / sizeof(IMAGE_DEBUG_DIRECTORY); ++i)
+    {
+        IMAGE_DEBUG_DIRECTORY debugEntry;
+        if (!ReadAt(file, debugDirectoryOffset + uint64_t{ i } * sizeof(IMAGE_DEBUG_DIRECTORY), debugEntry))
+        {
+            return false;
+        }
+
+        CodeViewRsdsHeader codeView;
+
+        if (debugEntry.Type != IMAGE_DEBUG_TYPE_CODEVIEW ||
+            debugEntry.SizeOfData <= sizeof(CodeViewRsdsHeader) ||
+            !ReadAt(file, debugEntry.PointerToRawData, codeView) ||
+            codeView.signature != CodeViewSignatureRsds)
+        {
+            continue;
+        }
+
+        std::string pdbPath(debugEntry.SizeOfData - sizeof(CodeViewRsdsHeader), '\0');
+        if (!file.read(pdbPath.data(), pdbPath.size()))
+        {
+            return false;
+        }
+
+        pdbPath.resize(strnlen(pdbPath.c_str(), pdbPath.size()));
+
+        // The path is the one the linker wrote; the store only knows the name.
+        const size_t nameStart = pdbPath.find_last_of("\\/");
+
+        key.pdbName = nameStart == std::string::npos ? pdbPath : pdbPath.substr(nameStart + 1);
+        key.guid = codeView.guid;
+        key.age = codeView.age;
+
+        return !key.pdbName.empty();
+    }
+
+    return false;
+}
+
+SymbolStoreFetchResult SymbolStoreFetcher::Download(const SymbolStoreKey& key)
+{
+    SymbolStoreFetchResult result;
+
+    const auto storePath = key.GetStorePath();
+    const auto pdbPath = m_cacheDirectory / storePath;
+
+    auto partialPath = pdbPath;
+    partialPath += PartialExtension;
+
+    std::error_code error;
+    std::filesystem::create_directories(pdbPath.parent_path(), error);
+
+    const auto objectPath = m_basePath + ToWideString(storePath);
+
+    //
+    // A range the server cannot satisfy means the partial file does not
+    // belong to what the server has now; it is dropped and the download
+    // starts over once.
+    //
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        const auto partialSize = std::filesystem::file_size(partialPath, error);
+        const uint64_t rangeStart = error ? 0 : partialSize;
+
+        uint64_t bytesReceived = 0;
+        uint64_t fileSize = 0;
+        const DWORD status = Request(objectPath, rangeStart, partialPath, bytesReceived, fileSize);
+        result.bytesDownloaded += bytesReceived;
+
+        switch (status)
+        {
+        case HTTP_STATUS_OK:
+        case HTTP_STATUS_PARTIAL_CONTENT:
+            //
+            // A response that ends early without an error, or an error page
+            // a proxy answered with, must not land in the cache, where it
+            // would stay: the file must have the declared size and be a PDB.
+            //
+            if ((fileSize != 0 && std::filesystem::file_size(partialPath, error) != fileSize) ||
+                !HasMsfSignature(partialPath))
+            {
+                std::filesystem::remove(partialPath, error);
+                result.status = SymbolStoreFetchStatus::Failed;
+                return result;
+            }
+
+            std::filesystem::rename(partialPath, pdbPath, error);
+            if (error)
+            {
+                result.status = SymbolStoreFetchStatus::Failed;
+                return result;
+            }
+
+            result.status = SymbolStoreFetchStatus::Downloaded;
+            result.pdbPath = pdbPath;
+            result.resumed = status == HTTP_STATUS_PARTIAL_CONTENT;
+            return result;
+
+        case HTTP_STATUS_NOT_FOUND:
+            std::filesystem::remove(partialPath, error);
+            result.status = SymbolStoreFetchStatus::NotFound;
+            return result;
+
+        case HTTP_STATUS_RANGE_NOT_SATISFIABLE:
+            std::filesystem::remove(partialPath, error);
+            continue;
+
+        default:
+            // What was received stays for the next fetch to continue.
+            result.status = SymbolStoreFetchStatus::Failed;
+            return result;
+        }
+    }
+
+    result.status = SymbolStoreFetchStatus::Failed;
+    return result;
+}
+
+DWORD SymbolStoreFetcher::Request(const std::wstring& objectPath, uint64_t rangeStart, const std::filesystem::path& partialPath, uint64_t& bytesReceived, uint64_t& fileSize)
+{
+    bytesReceived = 0;
+    fileSize = 0;
+
+    HINTERNET request = WinHttpOpenRequest(
+        m_connection,
+        L"GET",
+        objectPath.c_str(),
+        nullptr,
+        WINHTTP_NO_REFERER,
+        WINHTTP_DEFAULT_ACCEPT_TYPES,
+        m_isSecure ? WINHTTP_FLAG_SECURE : 0);
+
+    if (!request)
+    {
+        return 0;
+    }
+
+    std::wstring headers;
+    if (rangeStart != 0)
+    {
+        headers = L"Range: bytes=" + std::to_wstring(rangeStart) + L"-\r\n";
+    }
+
+    DWORD status = 0;
+    DWORD statusSize = sizeof(status);
+
+    if (!WinHttpSendRequest(
+            request,
+            headers.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : headers.c_str(),
+            static_cast<DWORD>(headers.size()),
+            WINHTTP_NO_REQUEST_DATA,
+            0,
+            0,
+            0) ||
+        !WinHttpReceiveResponse(request, nullptr) ||
+        !WinHttpQueryHeaders(
+            request,
+            WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+            WINHTTP_HEADER_NAME_BY_INDEX,
+            &status,
+            &statusSize,
+            WINHTTP_NO_HEADER_INDEX))
+    {
+        WinHttpCloseHandle(request);
+        return 0;
+    }
+
+    //
+    // The size of the whole file: Content-Length of a full response, or the
+    // total in Content-Range ("bytes <first>-<last>/<total>") of a range
+    // response. A range response must continue the partial file exactly.
+    //
+    std::wstring header;
+
+    if (status == HTTP_STATUS_OK && QueryHeader(request, WINHTTP_QUERY_CONTENT_LENGTH, header))
+    {
+        fileSize = wcstoull(header.c_str(), nullptr, 10);
+    }
+    else if (status == HTTP_STATUS_PARTIAL_CONTENT)
+    {
+        unsigned long long first = 0;
+        unsigned long long last = 0;
+        unsigned long long total = 0;
+
+        if (!QueryHeader(request, WINHTTP_QUERY_CONTENT_RANGE, header) ||
+            swscanf(header.c_str(), L"bytes %llu-%llu/%llu", &first, &last, &total) != 3 ||
+            first != rangeStart)
+        {
+            WinHttpCloseHandle(request);
+
+            std::error_code error;
+            std::filesystem::remove(partialPath, error);
+            return 0;
+        }
+
+        fileSize = total;
+    }
+
+    if (status == HTTP_STATUS_OK || status == HTTP_STATUS_PARTIAL_CONTENT)
+    {
+        // A server ignoring the range sends the whole file again.
+        const auto mode = status == HTTP_STATUS_PARTIAL_CONTENT
+            ? std::ios::out | std::ios::binary | std::ios::app
+            : std::ios::out | std::ios::binary | std::ios::trunc;
+
+        std::ofstream file(partialPath, mode);
+        std::vector<char> buffer(ReceiveBufferSize);
+
+        for (;;)
+        {
+            DWORD readSize = 0;
+            if (!file || !WinHttpReadData(request, buffer.data(), static_cast<DWORD>(buffer.size()), &readSize))
+            {
+                status = 0;
+                break;
+            }
+
+            if (readSize == 0)
+            {
+                break;
+            }
+
+            file.write(buffer.data(), readSize);
+            bytesReceived += readSize;
+        }
+
+        file.close();
+        if (!file)
+        {
+            status = 0;
+        }
+    }
+
+    WinHttpCloseHandle(request);
+    return status;
+}
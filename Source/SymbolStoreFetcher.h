@@ -0,0 +1,95 @@
+#pragma once
+#include "PDB.h"
+#include "ThreadPool.h"
+
+#include <winhttp.h>
+
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// What a symbol store files a PDB under: <pdbName>/<GUID><age>/<pdbName>.
+struct SymbolStoreKey
+{
+    std::string pdbName;
+    GUID guid = {};
+    DWORD age = 0;
+
+    std::string GetStorePath() const;
+};
+
+enum class SymbolStoreFetchStatus : uint8_t
+{
+    Cached,
+    Downloaded,
+    NotFound,
+    Failed,
+};
+
+struct SymbolStoreFetchResult
+{
+    SymbolStoreFetchStatus status = SymbolStoreFetchStatus::Failed;
+
+    // In the cache; set when the PDB was cached or downloaded.
+    std::filesystem::path pdbPath;
+
+    uint64_t bytesDownloaded = 0;
+
+    // The download continued a partial file an earlier run left behind.
+    bool resumed = false;
+};
+
+//
+// Fetches PDBs from a symbol server into a local cache laid out like a
+// symbol store, so the cache can itself serve as a downstream store
+// ("srv*<cache>*<server>").
+//
+// Downloads run on a pool of one worker per connection, and the WinHTTP
+// session keeps at most as many connections to the server. Fetching a key
+// already being downloaded joins that download. A download goes to
+// "<pdb>.partial" next to its final path and is renamed once complete; an
+// interrupted one is continued with a range request by the next fetch.
+// A download is complete when it has the size the server declared and
+// starts with the MSF signature; anything else is deleted.
+//
+class SymbolStoreFetcher
+{
+public:
+    SymbolStoreFetcher(const std::filesystem::path& cacheDirectory, const std::string& serverUrl, size_t connectionCount);
+    ~SymbolStoreFetcher();
+
+    SymbolStoreFetcher(const SymbolStoreFetcher&) = delete;
+    SymbolStoreFetcher& operator=(const SymbolStoreFetcher&) = delete;
+
+    // False when the server URL could not be used.
+    bool IsOpen() const;
+
+    // Thread-safe.
+    std::shared_future<SymbolStoreFetchResult> Fetch(const SymbolStoreKey& key);
+
+    // Reads the CodeView (RSDS) record of a PE image.
+    static bool GetKey(const std::filesystem::path& imagePath, SymbolStoreKey& key);
+
+private:
+    SymbolStoreFetchResult Download(const SymbolStoreKey& key);
+
+    // HTTP status of the response, or zero when the request failed.
+    // fileSize is the size the complete file must have, or zero when the
+    // response does not declare it.
+    DWORD Request(const std::wstring& objectPath, uint64_t rangeStart, const std::filesystem::path& partialPath, uint64_t& bytesReceived, uint64_t& fileSize);
+
+private:
+    std::filesystem::path m_cacheDirectory;
+
+    HINTERNET m_session = nullptr;
+    HINTERNET m_connection = nullptr;
+    std::wstring m_basePath;
+    bool m_isSecure = false;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_future<SymbolStoreFetchResult>> m_downloads;
+
+    ThreadPool m_pool;
+};
@@ -0,0 +1,235 @@
+#include "SymbolTypeDiff.h"
+
+#include <string_view>
+
+namespace
+{
+    void HashString(uint64_t& hash, std::string_view text)
+    {
+        // The terminator keeps "ab" + "c" apart from "a" + "bc".
+        SymbolTypeDiff::HashBytes(hash, text.data(), text.size());
+        SymbolTypeDiff::HashBytes(hash, "", 1);
+    }
+
+    void HashValue(uint64_t& hash, DWORD value)
+    {
+        SymbolTypeDiff::HashBytes(hash, &value, sizeof(value));
+    }
+}
+
+void SymbolTypeDiff::HashBytes(uint64_t& hash, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= HashPrime;
+    }
+}
+
+void SymbolTypeDiff::CollectTypes(const SymbolMap& symbols, SymbolTypeMap& types)
+{
+    types.clear();
+
+    for (const auto&[_, symbol] : symbols)
+    {
+        if (symbol->tag != SymTagUDT || symbol->size == 0 || PDB::IsUnnamedSymbol(*symbol))
+        {
+            continue;
+        }
+
+        types.emplace(symbol->name, symbol.get());
+    }
+}
+
+uint64_t SymbolTypeDiff::GetStructuralHash(const Symbol& udt)
+{
+    std::string path;
+    std::string typeName;
+
+    // Per-member hashes are summed, so member order does not matter.
+    uint64_t fieldHashSum = 0;
+
+    ForEachField(udt, 0, path, typeName, [&fieldHashSum](const std::string& path, const std::string& typeName, DWORD offset, const SymbolUdtField& udtField)
+    {
+        uint64_t hash = HashOffsetBasis;
+
+        HashString(hash, path);
+        HashString(hash, typeName);
+        HashValue(hash, offset);
+        HashValue(hash, udtField.type->size);
+        HashValue(hash, udtField.bits);
+        HashValue(hash, udtField.bits != 0 ? udtField.bitPosition : 0);
+
+        fieldHashSum += hash;
+    });
+
+    uint64_t hash = HashOffsetBasis;
+
+    HashValue(hash, udt.size);
+    HashValue(hash, std::get<SymbolUdt>(udt.variant).kind);
+    HashBytes(hash, &fieldHashSum, sizeof(fieldHashSum));
+
+    return hash;
+}
+
+bool SymbolTypeDiff::Compare(const Symbol& oldUdt, const Symbol& newUdt, SymbolTypeChange& change)
+{
+    change = SymbolTypeChange();
+    change.oldUdt = &oldUdt;
+    change.newUdt = &newUdt;
+
+    std::vector<SymbolTypeDiffField> oldFields;
+    std::vector<SymbolTypeDiffField> newFields;
+
+    GetFields(oldUdt, oldFields);
+    GetFields(newUdt, newFields);
+
+    // Members sharing a path are matched in order of appearance.
+    struct PathMatch
+    {
+        std::vector<size_t> oldIndexes;
+        size_t next = 0;
+    };
+
+    std::unordered_map<std::string_view, PathMatch> oldPaths;
+    for (size_t i = 0; i < oldFields.size(); ++i)
+    {
+        oldPaths[oldFields[i].path].oldIndexes.push_back(i);
+    }
+
+    std::vector<bool> matched(oldFields.size());
+    std::vector<SymbolFieldChange> newFieldChanges;
+
+    for (auto& newField : newFields)
+    {
+        SymbolFieldChange fieldChange;
+
+        auto it = oldPaths.find(newField.path);
+        if (it == oldPaths.end() || it->second.next == it->second.oldIndexes.size())
+        {
+            fieldChange.kind = SymbolFieldChangeKind::Added;
+            fieldChange.newField = std::move(newField);
+            newFieldChanges.push_back(std::move(fieldChange));
+            continue;
+        }
+
+        const size_t oldIndex = it->second.oldIndexes[it->second.next++];
+        const auto& oldField = oldFields[oldIndex];
+        matched[oldIndex] = true;
+
+        if (oldField.offset != newField.offset)
+        {
+            fieldChange.flags |= SymbolFieldChangeOffset;
+        }
+
+        if (oldField.size != newField.size)
+        {
+            fieldChange.flags |= SymbolFieldChangeSize;
+        }
+
+        if (oldField.bits != newField.bits || oldField.bitPosition != newField.bitPosition)
+        {
+            fieldChange.flags |= SymbolFieldChangeBitField;
+        }
+
+        if (oldField.typeName != newField.typeName)
+        {
+            fieldChange.flags |= SymbolFieldChangeType;
+        }
+
+        if (fieldChange.flags != 0)
+        {
+            fieldChange.oldField = oldField;
+            fieldChange.newField = std::move(newField);
+            newFieldChanges.push_back(std::move(fieldChange));
+        }
+    }
+
+    for (size_t i = 0; i < oldFields.size(); ++i)
+    {
+        if (!matched[i])
+        {
+            SymbolFieldChange fieldChange;
+            fieldChange.kind = SymbolFieldChangeKind::Removed;
+            fieldChange.oldField = std::move(oldFields[i]);
+            change.fields.push_back(std::move(fieldChange));
+        }
+    }
+
+    change.fields.insert(
+        change.fields.end(),
+        std::make_move_iterator(newFieldChanges.begin()),
+        std::make_move_iterator(newFieldChanges.end()));
+
+    return !change.fields.empty() ||
+        oldUdt.size != newUdt.size ||
+        std::get<SymbolUdt>(oldUdt.variant).kind != std::get<SymbolUdt>(newUdt.variant).kind;
+}
+
+template<typename Func>
+void SymbolTypeDiff::ForEachField(const Symbol& udt, DWORD baseOffset, std::string& path, std::string& typeName, const Func& func)
+{
+    const auto& symbolUdt = std::get<SymbolUdt>(udt.variant);
+    const size_t pathLength = path.size();
+
+    for (const auto& udtField : symbolUdt.fields)
+    {
+        if (!udtField.type)
+        {
+            continue;
+        }
+
+        // Virtual bases live wherever the most derived type puts them.
+        if (udtField.isBaseClass && PDB::IsVirtualBaseClass(symbolUdt, udtField))
+        {
+            continue;
+        }
+
+        const bool isData = udtField.tag == SymTagData && udtField.dataKind != DataIsStaticMember;
+        if (!udtField.isBaseClass && !isData)
+        {
+            continue;
+        }
+
+        path.resize(pathLength);
+        path += udtField.isBaseClass ? udtField.type->name : udtField.name;
+
+        const Symbol* type = PDB::StripTypedefs(udtField.type.get());
+        const DWORD offset = baseOffset + udtField.offset;
+
+        if (!udtField.isBaseClass && PDB::IsUdt(type) && PDB::IsUnnamedSymbol(*type))
+        {
+            path += '.';
+            ForEachField(*type, offset, path, typeName, func);
+            continue;
+        }
+
+        typeName.clear();
+        PDB::AppendTypeName(typeName, udtField.type.get());
+
+        func(path, typeName, offset, udtField);
+    }
+
+    path.resize(pathLength);
+}
+
+void SymbolTypeDiff::GetFields(const Symbol& udt, std::vector<SymbolTypeDiffField>& fields)
+{
+    std::string path;
+    std::string typeName;
+
+    ForEachField(udt, 0, path, typeName, [&fields](const std::string& path, const std::string& typeName, DWORD offset, const SymbolUdtField& udtField)
+    {
+        SymbolTypeDiffField field;
+        field.path = path;
+        field.typeName = typeName;
+        field.offset = offset;
+        field.size = udtField.type->size;
+        field.bits = udtField.bits;
+        field.bitPosition = udtField.bits != 0 ? udtField.bitPosition : 0;
+
+        fields.push_back(std::move(field));
+    });
+}
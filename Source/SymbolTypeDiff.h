@@ -0,0 +1,92 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <vector>
+
+// Named UDT definitions by name.
+using SymbolTypeMap = std::unordered_map<std::string, const Symbol*>;
+
+// A member as the diff sees it: flattened out of unnamed nested types.
+struct SymbolTypeDiffField
+{
+    std::string path;
+    std::string typeName;
+    DWORD offset = 0;
+    DWORD size = 0;
+    DWORD bits = 0;
+    DWORD bitPosition = 0;
+
+    bool operator==(const SymbolTypeDiffField&) const = default;
+};
+
+enum class SymbolFieldChangeKind : uint8_t
+{
+    Added,
+    Removed,
+
+    // Present in both; see the flags for what differs.
+    Changed,
+};
+
+constexpr unsigned SymbolFieldChangeOffset = 1u << 0;
+constexpr unsigned SymbolFieldChangeSize = 1u << 1;
+constexpr unsigned SymbolFieldChangeBitField = 1u << 2;
+constexpr unsigned SymbolFieldChangeType = 1u << 3;
+
+// oldField is unset for added members, newField for removed ones.
+struct SymbolFieldChange
+{
+    SymbolFieldChangeKind kind = SymbolFieldChangeKind::Changed;
+    unsigned flags = 0;
+    SymbolTypeDiffField oldField;
+    SymbolTypeDiffField newField;
+};
+
+struct SymbolTypeChange
+{
+    const Symbol* oldUdt = nullptr;
+    const Symbol* newUdt = nullptr;
+
+    // Removed members first, then the members of the new layout in order.
+    std::vector<SymbolFieldChange> fields;
+};
+
+//
+// Structural comparison of a UDT between two builds.
+//
+// Members are matched by path: members of unnamed nested types are taken
+// as members of the type, like base classes named after their type, while
+// named members are compared by type name only; their own changes show up
+// under their own name. Static members, functions and virtual bases do not
+// take part.
+//
+// The structural hash covers the size, kind and every member with its
+// offset, size, bit field and type name, independent of member order, so
+// the many unchanged types of two builds are told apart by one comparison
+// each. Only types whose hashes differ are compared member by member.
+//
+class SymbolTypeDiff
+{
+public:
+    // FNV-1a, which the structural hashes are built with.
+    static const uint64_t HashOffsetBasis = 0xcbf29ce484222325ull;
+    static const uint64_t HashPrime = 0x100000001b3ull;
+    static void HashBytes(uint64_t& hash, const void* data, size_t size);
+
+    // Definitions win over forward declarations of the same name.
+    static void CollectTypes(const SymbolMap& symbols, SymbolTypeMap& types);
+
+    // Thread-safe: only reads the symbol graph.
+    static uint64_t GetStructuralHash(const Symbol& udt);
+
+    // Thread-safe. Returns false when the layouts are the same.
+    static bool Compare(const Symbol& oldUdt, const Symbol& newUdt, SymbolTypeChange& change);
+
+    // The members the hash covers, in declaration order.
+    static void GetFields(const Symbol& udt, std::vector<SymbolTypeDiffField>& fields);
+
+private:
+    template<typename Func>
+    static void ForEachField(const Symbol& udt, DWORD baseOffset, std::string& path, std::string& typeName, const Func& func);
+};
@@ -0,0 +1,232 @@
+#include "SymbolTypeMerger.h"
+#include "SymbolTypeDiff.h"
+#include "PDBSymbolSorter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+
+namespace
+{
+    bool IsDefinition(const Symbol& symbol)
+    {
+        return symbol.tag != SymTagUDT || symbol.size != 0;
+    }
+
+    //
+    // Structural hashes only name the types a UDT holds by value. Mixing in
+    // their layout hashes makes a UDT differ when something it holds by
+    // value differs; types behind pointers stay identified by name.
+    //
+    void HashValueTypes(const Symbol& udt, const std::unordered_map<std::string, uint64_t>& layoutHashes, uint64_t& hash)
+    {
+        for (const auto& udtField : std::get<SymbolUdt>(udt.variant).fields)
+        {
+            const Symbol* type = udtField.type.get();
+
+            while (type && (type->tag == SymTagTypedef || type->tag == SymTagArrayType))
+            {
+                type = type->tag == SymTagTypedef
+                    ? std::get<SymbolTypedef>(type->variant).type.get()
+                    : std::get<SymbolArray>(type->variant).elementType.get();
+            }
+
+            if (!type || (type->tag != SymTagUDT && type->tag != SymTagEnum))
+            {
+                continue;
+            }
+
+            if (type->tag == SymTagUDT && PDB::IsUnnamedSymbol(*type))
+            {
+                HashValueTypes(*type, layoutHashes, hash);
+                continue;
+            }
+
+            auto it = layoutHashes.find(type->name);
+            if (it != layoutHashes.end())
+            {
+                SymbolTypeDiff::HashBytes(hash, &it->second, sizeof(it->second));
+            }
+        }
+    }
+}
+
+void SymbolTypeMerger::Add(PDB& pdb, const std::string& sourceName)
+{
+    const auto& symbolMap = pdb.GetSymbolMap();
+
+    std::unordered_map<std::string, std::vector<Symbol*>> symbolsByName;
+    PDBSymbolSorter sorter;
+
+    for (const auto&[_, symbol] : symbolMap)
+    {
+        if ((symbol->tag != SymTagUDT && symbol->tag != SymTagEnum) || PDB::IsUnnamedSymbol(*symbol))
+        {
+            continue;
+        }
+
+        // Forward declarations and const/volatile variants share the name.
+        symbolsByName[symbol->name].push_back(symbol.get());
+
+        if (IsDefinition(*symbol))
+        {
+            sorter.Visit(*symbol);
+        }
+    }
+
+    //
+    // Every layout is hashed before anything is renamed, under the names
+    // this PDB gives its types, so the result does not depend on the order
+    // types are visited in. A type comes after the types it holds by value.
+    //
+    std::vector<std::pair<const Symbol*, uint64_t>> sortedSymbols;
+    std::unordered_map<std::string, uint64_t> layoutHashes;
+
+    for (const auto symIndex : sorter.GetSortedSymbolIndexes())
+    {
+        const auto symbol = pdb.GetSymbolBySymbolIndex(symIndex);
+        assert(symbol);
+
+        if (PDB::IsUnnamedSymbol(*symbol))
+        {
+            continue;
+        }
+
+        uint64_t hash = GetLayoutHash(*symbol);
+        if (symbol->tag == SymTagUDT)
+        {
+            HashValueTypes(*symbol, layoutHashes, hash);
+        }
+
+        sortedSymbols.emplace_back(symbol.get(), hash);
+        layoutHashes.emplace(symbol->name, hash);
+    }
+
+    // Names and the merged names they are renamed to, applied at the end.
+    std::unordered_map<std::string, std::string> renames;
+
+    for (const auto&[symbol, hash] : sortedSymbols)
+    {
+        const std::string& name = symbol->name;
+
+        auto& layouts = m_layouts[name];
+        auto layoutIt = std::find_if(layouts.begin(), layouts.end(), [hash](const Layout& layout)
+        {
+            return layout.hash == hash;
+        });
+
+        if (layoutIt != layouts.end())
+        {
+            ++m_duplicateCount;
+        }
+        else
+        {
+            // Renamed layouts of other names may already use this name.
+            std::string mergedName = layouts.empty() && m_mergedNames.count(name) == 0
+                ? name
+                : GetMergedName(name, sourceName);
+
+            m_mergedNames.insert(mergedName);
+            layoutIt = layouts.insert(layouts.end(), Layout{ hash, std::move(mergedName) });
+        }
+
+        if (layoutIt->mergedName != name && renames.emplace(name, layoutIt->mergedName).second)
+        {
+            m_conflicts.push_back(SymbolTypeConflict{ name, sourceName, layoutIt->mergedName });
+        }
+    }
+
+    for (const auto&[name, mergedName] : renames)
+    {
+        for (auto* namedSymbol : symbolsByName[name])
+        {
+            namedSymbol->name = mergedName;
+        }
+    }
+
+    const DWORD symIndexBase = m_nextSymIndex;
+
+    for (const auto&[_, symbol] : symbolMap)
+    {
+        symbol->symIndexId += symIndexBase;
+        m_nextSymIndex = (std::max)(m_nextSymIndex, symbol->symIndexId + 1);
+
+        m_symbols.emplace(symbol->symIndexId, symbol);
+        (IsDefinition(*symbol) ? m_definitions : m_declarations).push_back(symbol);
+    }
+}
+
+void SymbolTypeMerger::ForEachSymbol(const std::function<void(const Symbol&)>& func) const
+{
+    for (const auto& symbol : m_definitions)
+    {
+        func(*symbol);
+    }
+
+    for (const auto& symbol : m_declarations)
+    {
+        func(*symbol);
+    }
+}
+
+const SymbolPtr SymbolTypeMerger::GetSymbolBySymbolIndex(DWORD symIndex) const
+{
+    auto it = m_symbols.find(symIndex);
+    return it == m_symbols.end() ? nullptr : it->second;
+}
+
+const std::vector<SymbolTypeConflict>& SymbolTypeMerger::GetConflicts() const
+{
+    return m_conflicts;
+}
+
+size_t SymbolTypeMerger::GetTypeCount() const
+{
+    return m_mergedNames.size();
+}
+
+size_t SymbolTypeMerger::GetDuplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+std::string SymbolTypeMerger::GetMergedName(const std::string& name, const std::string& sourceName)
+{
+    std::string suffix = sourceName;
+    std::replace_if(suffix.begin(), suffix.end(), [](char c)
+    {
+        return !std::isalnum(static_cast<unsigned char>(c)) && c != '_';
+    }, '_');
+
+    std::string mergedName = name + "_" + suffix;
+
+    for (size_t i = 2; m_mergedNames.count(mergedName) != 0; ++i)
+    {
+        mergedName = name + "_" + suffix + "_" + std::to_string(i);
+    }
+
+    return mergedName;
+}
+
+uint64_t SymbolTypeMerger::GetLayoutHash(const Symbol& symbol)
+{
+    if (symbol.tag == SymTagUDT)
+    {
+        return SymbolTypeDiff::GetStructuralHash(symbol);
+    }
+
+    // Enumerators in order, with their values.
+    uint64_t hash = SymbolTypeDiff::HashOffsetBasis;
+    SymbolTypeDiff::HashBytes(hash, &symbol.size, sizeof(symbol.size));
+
+    for (const auto& enumField : std::get<SymbolEnum>(symbol.variant).fields)
+    {
+        int64_t value = 0;
+        PDB::GetVariantInteger(enumField.value, value);
+
+        SymbolTypeDiff::HashBytes(hash, enumField.name.c_str(), enumField.name.size() + 1);
+        SymbolTypeDiff::HashBytes(hash, &value, sizeof(value));
+    }
+
+    return hash;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "PDB.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A name with a different layout in a later PDB than in an earlier one.
+struct SymbolTypeConflict
+{
+    std::string name;
+    std::string sourceName;
+
+    // What the later layout is emitted as.
+    std::string mergedName;
+};
+
+//
+// Merges the types of several PDBs, typically the modules of one product,
+// into one symbol graph the sorter and the reconstructors take as one PDB.
+//
+// Enums and UDTs are unified by name and structural hash (see
+// SymbolTypeDiff): a name whose layout was already seen is emitted once.
+// A name seen with a different layout keeps its first layout, and every
+// other layout is renamed to "<name>_<source>", shared by all later PDBs
+// having that same layout. A layout hash covers the layouts of the types
+// held by value, so a type holding a differing type by value differs as
+// well; types behind pointers only count by name. Every layout of a PDB is
+// hashed before any of its types is renamed.
+//
+// Symbol indexes are only unique within their PDB; the symbols of every
+// added PDB are renumbered into a range of their own.
+//
+class SymbolTypeMerger
+{
+public:
+    // PDBs are added in order of precedence. The PDB must be fully loaded
+    // and stay open while the merger is used; its symbols are renamed and
+    // renumbered, so it is not good for anything else afterwards.
+    void Add(PDB& pdb, const std::string& sourceName);
+
+    // Definitions of all PDBs come first, so a later definition wins over
+    // an earlier forward declaration.
+    void ForEachSymbol(const std::function<void(const Symbol&)>& func) const;
+
+    const SymbolPtr GetSymbolBySymbolIndex(DWORD symIndex) const;
+    const std::vector<SymbolTypeConflict>& GetConflicts() const;
+
+    size_t GetTypeCount() const;
+    size_t GetDuplicateCount() const;
+
+private:
+    struct Layout
+    {
+        uint64_t hash;
+        std::string mergedName;
+    };
+
+    std::string GetMergedName(const std::string& name, const std::string& sourceName);
+
+    static uint64_t GetLayoutHash(const Symbol& symbol);
+
+private:
+    DWORD m_nextSymIndex = 0;
+    std::unordered_map<DWORD, SymbolPtr> m_symbols;
+    std::vector<SymbolPtr> m_definitions;
+    std::vector<SymbolPtr> m_declarations;
+
+    // Every layout seen under a name, first one first.
+    std::unordered_map<std::string, std::vector<Layout>> m_layouts;
+    std::unordered_set<std::string> m_mergedNames;
+
+    std::vector<SymbolTypeConflict> m_conflicts;
+    size_t m_duplicateCount = 0;
+};
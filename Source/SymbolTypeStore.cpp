@@ -0,0 +1,566 @@
+#include "SymbolTypeStore.h"
+#include "SymbolTypeDiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const char StoreMagic[8] = { 'P', 'D', 'B', 'X', 'T', 'Y', 'P', 'S' };
+    const uint32_t StoreVersion = 1;
+
+    const char ManifestMagic[8] = { 'P', 'D', 'B', 'X', 'M', 'A', 'N', 'F' };
+    const uint32_t ManifestVersion = 1;
+
+    const size_t RecordAlignment = 8;
+
+    const wchar_t* const TypesFileName = L"types.dat";
+    const wchar_t* const IndexFileName = L"types.idx";
+    const wchar_t* const ManifestDirectoryName = L"manifests";
+
+#pragma pack(push, 4)
+
+    struct ManifestHeader
+    {
+        char magic[8];
+        uint32_t version;
+        GUID guid;
+        uint32_t age;
+        uint32_t typeCount;
+        uint32_t namesSize;
+        int64_t ingestTime;
+    };
+
+    struct ManifestEntry
+    {
+        uint64_t hash;
+        uint32_t nameOffset;
+        uint32_t reserved;
+    };
+
+#pragma pack(pop)
+
+    bool ReadManifestHeader(std::ifstream& file, ManifestHeader& header)
+    {
+        return file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+               memcmp(header.magic, ManifestMagic, sizeof(ManifestMagic)) == 0 &&
+               header.version == ManifestVersion;
+    }
+
+    // Compares everything but the hash, which is the key the record is
+    // stored under.
+    bool IsSameRecord(const char* storedRecord, const std::string& record)
+    {
+        const size_t hashSize = sizeof(SymbolTypeStoreRecord::hash);
+
+        return reinterpret_cast<const SymbolTypeStoreRecord*>(storedRecord)->recordSize == record.size() &&
+               memcmp(storedRecord + hashSize, record.data() + hashSize, record.size() - hashSize) == 0;
+    }
+}
+
+SymbolTypeStore::~SymbolTypeStore()
+{
+    Close();
+}
+
+bool SymbolTypeStore::Open(const std::filesystem::path& directory)
+{
+    Close();
+
+    std::error_code error;
+    std::filesystem::create_directories(directory / ManifestDirectoryName, error);
+
+    const auto typesPath = directory / TypesFileName;
+
+    if (!std::filesystem::exists(typesPath, error))
+    {
+        SymbolTypeStoreHeader header = {};
+        memcpy(header.magic, StoreMagic, sizeof(StoreMagic));
+        header.version = StoreVersion;
+
+        std::ofstream file(typesPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    m_directory = directory;
+
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+
+    LoadIndex();
+    return true;
+}
+
+void SymbolTypeStore::Close()
+{
+    Unmap();
+
+    m_directory.clear();
+    m_index.clear();
+}
+
+bool SymbolTypeStore::IsOpen() const
+{
+    return m_view != nullptr;
+}
+
+bool SymbolTypeStore::Ingest(PDB& pdb, SymbolTypeStoreIngestResult& result)
+{
+    result = SymbolTypeStoreIngestResult();
+
+    SymbolTypeStoreManifest manifest;
+    if (!IsOpen() || !pdb.GetSignature(manifest.guid, manifest.age))
+    {
+        return false;
+    }
+
+    manifest.pdbName = pdb.GetPath().filename().string();
+
+    const auto manifestPath = m_directory / ManifestDirectoryName / manifest.pdbName / PDB::GetSignatureString(manifest.guid, manifest.age);
+
+    std::error_code error;
+    if (std::filesystem::exists(manifestPath, error))
+    {
+        result.isKnownPdb = true;
+        return true;
+    }
+
+    SymbolTypeMap types;
+    SymbolTypeDiff::CollectTypes(pdb.GetSymbolMap(), types);
+
+    //
+    // Only layouts the store has not seen are serialized; the rest of the
+    // PDB costs a manifest entry per type.
+    //
+    std::string records;
+    std::string record;
+    std::vector<SymbolTypeStoreIndexEntry> entries;
+
+    // Hash -> offset in records of the records this ingest adds.
+    std::unordered_map<uint64_t, size_t> newRecords;
+
+    for (const auto&[name, udt] : types)
+    {
+        record.clear();
+        AppendRecord(record, 0, *udt);
+
+        //
+        // A hash hit is only taken when the stored record matches byte for
+        // byte. A layout whose hash collides with a different one is keyed
+        // by the next hash value not taken by another layout.
+        //
+        uint64_t hash = SymbolTypeDiff::GetStructuralHash(*udt);
+
+        for (;; ++hash)
+        {
+            if (const auto* storedRecord = FindRecord(hash))
+            {
+                if (IsSameRecord(reinterpret_cast<const char*>(storedRecord), record))
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            auto newRecordIt = newRecords.find(hash);
+            if (newRecordIt != newRecords.end())
+            {
+                if (IsSameRecord(records.data() + newRecordIt->second, record))
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            reinterpret_cast<SymbolTypeStoreRecord*>(record.data())->hash = hash;
+
+            newRecords.emplace(hash, records.size());
+            entries.push_back({ hash, records.size() });
+            records += record;
+            break;
+        }
+
+        manifest.types.emplace_back(name, hash);
+    }
+
+    std::sort(manifest.types.begin(), manifest.types.end());
+
+    manifest.ingestTime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (!records.empty() && !AppendRecords(records, entries))
+    {
+        return false;
+    }
+
+    if (!WriteManifest(manifestPath, manifest))
+    {
+        return false;
+    }
+
+    result.typeCount = manifest.types.size();
+    result.newTypeCount = entries.size();
+    result.bytesWritten = records.size() + entries.size() * sizeof(SymbolTypeStoreIndexEntry);
+
+    return true;
+}
+
+void SymbolTypeStore::GetManifestPaths(std::vector<std::filesystem::path>& paths) const
+{
+    paths.clear();
+
+    std::vector<std::pair<int64_t, std::filesystem::path>> manifests;
+    std::error_code error;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(m_directory / ManifestDirectoryName, error))
+    {
+        if (!entry.is_regular_file(error) || entry.path().extension() == ".tmp")
+        {
+            continue;
+        }
+
+        std::ifstream file(entry.path(), std::ios::in | std::ios::binary);
+
+        ManifestHeader header;
+        if (ReadManifestHeader(file, header))
+        {
+            manifests.emplace_back(header.ingestTime, entry.path());
+        }
+    }
+
+    std::sort(manifests.begin(), manifests.end());
+
+    for (auto& manifest : manifests)
+    {
+        paths.push_back(std::move(manifest.second));
+    }
+}
+
+bool SymbolTypeStore::ReadManifest(const std::filesystem::path& path, SymbolTypeStoreManifest& manifest) const
+{
+    manifest = SymbolTypeStoreManifest();
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    ManifestHeader header;
+    if (!ReadManifestHeader(file, header))
+    {
+        return false;
+    }
+
+    std::vector<ManifestEntry> entries(header.typeCount);
+    std::string names(header.namesSize, '\0');
+
+    file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(ManifestEntry));
+    file.read(names.data(), names.size());
+
+    if (!file || (!names.empty() && names.back() != '\0'))
+    {
+        return false;
+    }
+
+    manifest.pdbName = path.parent_path().filename().string();
+    manifest.guid = header.guid;
+    manifest.age = header.age;
+    manifest.ingestTime = header.ingestTime;
+    manifest.types.reserve(entries.size());
+
+    for (const auto& entry : entries)
+    {
+        if (entry.nameOffset >= names.size())
+        {
+            return false;
+        }
+
+        manifest.types.emplace_back(names.c_str() + entry.nameOffset, entry.hash);
+    }
+
+    return true;
+}
+
+const SymbolTypeStoreRecord* SymbolTypeStore::FindRecord(uint64_t hash) const
+{
+    auto it = m_index.find(hash);
+    return it != m_index.end() ? reinterpret_cast<const SymbolTypeStoreRecord*>(m_view + it->second) : nullptr;
+}
+
+const SymbolTypeStoreField* SymbolTypeStore::GetFields(const SymbolTypeStoreRecord& record)
+{
+    return reinterpret_cast<const SymbolTypeStoreField*>(&record + 1);
+}
+
+const char* SymbolTypeStore::GetString(const SymbolTypeStoreRecord& record, uint32_t stringOffset)
+{
+    return reinterpret_cast<const char*>(GetFields(record) + record.fieldCount) + stringOffset;
+}
+
+bool SymbolTypeStore::Map()
+{
+    const auto typesPath = m_directory / TypesFileName;
+
+    m_file = CreateFileW(
+        typesPath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(SymbolTypeStoreHeader)))
+    {
+        Unmap();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Unmap();
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view)
+    {
+        Unmap();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const SymbolTypeStoreHeader*>(m_view);
+    if (memcmp(header->magic, StoreMagic, sizeof(StoreMagic)) != 0 || header->version != StoreVersion)
+    {
+        Unmap();
+        return false;
+    }
+
+    return true;
+}
+
+void SymbolTypeStore::Unmap()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+    m_size = 0;
+}
+
+void SymbolTypeStore::LoadIndex()
+{
+    m_index.clear();
+
+    std::ifstream file(m_directory / IndexFileName, std::ios::in | std::ios::binary);
+
+    //
+    // Entries are only trusted when their record lies wholly inside the
+    // mapped file and its fields and strings fit inside the record; a torn
+    // last entry is dropped.
+    //
+    SymbolTypeStoreIndexEntry entry;
+    while (file.read(reinterpret_cast<char*>(&entry), sizeof(entry)))
+    {
+        if (entry.recordOffset < sizeof(SymbolTypeStoreHeader) ||
+            entry.recordOffset % RecordAlignment != 0 ||
+            entry.recordOffset + sizeof(SymbolTypeStoreRecord) > m_size)
+        {
+            continue;
+        }
+
+        const auto* record = reinterpret_cast<const SymbolTypeStoreRecord*>(m_view + entry.recordOffset);
+        if (record->hash != entry.hash || entry.recordOffset + record->recordSize > m_size)
+        {
+            continue;
+        }
+
+        const uint64_t fieldsEnd = sizeof(SymbolTypeStoreRecord) + uint64_t(record->fieldCount) * sizeof(SymbolTypeStoreField);
+        if (fieldsEnd > record->recordSize)
+        {
+            continue;
+        }
+
+        // The strings, if any, end with a terminator or the zero padding.
+        if (fieldsEnd < record->recordSize && m_view[entry.recordOffset + record->recordSize - 1] != '\0')
+        {
+            continue;
+        }
+
+        m_index.emplace(entry.hash, entry.recordOffset);
+    }
+}
+
+bool SymbolTypeStore::AppendRecords(const std::string& records, std::vector<SymbolTypeStoreIndexEntry>& entries)
+{
+    //
+    // The mapping is dropped while the file grows and taken again after.
+    // Records land past whatever the file ends with, aligned; an earlier
+    // failed write may have left it unaligned.
+    //
+    const uint64_t fileSize = m_size;
+    const uint64_t recordsOffset = (fileSize + RecordAlignment - 1) / RecordAlignment * RecordAlignment;
+
+    Unmap();
+
+    {
+        std::ofstream file(m_directory / TypesFileName, std::ios::out | std::ios::binary | std::ios::app);
+
+        const char zeros[RecordAlignment] = {};
+        file.write(zeros, recordsOffset - fileSize);
+        file.write(records.data(), records.size());
+
+        if (!file.flush())
+        {
+            Map();
+            return false;
+        }
+    }
+
+    for (auto& entry : entries)
+    {
+        entry.recordOffset += recordsOffset;
+    }
+
+    {
+        std::ofstream file(m_directory / IndexFileName, std::ios::out | std::ios::binary | std::ios::app);
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SymbolTypeStoreIndexEntry));
+
+        if (!file.flush())
+        {
+            Map();
+            return false;
+        }
+    }
+
+    if (!Map())
+    {
+        return false;
+    }
+
+    for (const auto& entry : entries)
+    {
+        m_index.emplace(entry.hash, entry.recordOffset);
+    }
+
+    return true;
+}
+
+bool SymbolTypeStore::WriteManifest(const std::filesystem::path& path, const SymbolTypeStoreManifest& manifest) const
+{
+    std::vector<ManifestEntry> entries;
+    std::string names;
+
+    for (const auto&[name, hash] : manifest.types)
+    {
+        entries.push_back({ hash, static_cast<uint32_t>(names.size()), 0 });
+        names += name;
+        names += '\0';
+    }
+
+    ManifestHeader header = {};
+    memcpy(header.magic, ManifestMagic, sizeof(ManifestMagic));
+    header.version = ManifestVersion;
+    header.guid = manifest.guid;
+    header.age = manifest.age;
+    header.typeCount = static_cast<uint32_t>(entries.size());
+    header.namesSize = static_cast<uint32_t>(names.size());
+    header.ingestTime = manifest.ingestTime;
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // Written aside and renamed, so a manifest is either whole or absent.
+    auto temporaryPath = path;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ManifestEntry));
+        file.write(names.data(), names.size());
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+}
+
+void SymbolTypeStore::AppendRecord(std::string& records, uint64_t hash, const Symbol& udt)
+{
+    std::vector<SymbolTypeDiffField> fields;
+    SymbolTypeDiff::GetFields(udt, fields);
+
+    std::vector<SymbolTypeStoreField> storeFields;
+    std::string strings;
+
+    for (const auto& field : fields)
+    {
+        SymbolTypeStoreField storeField;
+        storeField.pathOffset = static_cast<uint32_t>(strings.size());
+        strings += field.path;
+        strings += '\0';
+
+        storeField.typeNameOffset = static_cast<uint32_t>(strings.size());
+        strings += field.typeName;
+        strings += '\0';
+
+        storeField.offset = field.offset;
+        storeField.size = field.size;
+        storeField.bits = field.bits;
+        storeField.bitPosition = field.bitPosition;
+
+        storeFields.push_back(storeField);
+    }
+
+    const size_t unalignedSize = sizeof(SymbolTypeStoreRecord) + storeFields.size() * sizeof(SymbolTypeStoreField) + strings.size();
+
+    SymbolTypeStoreRecord record;
+    record.hash = hash;
+    record.recordSize = static_cast<uint32_t>((unalignedSize + RecordAlignment - 1) / RecordAlignment * RecordAlignment);
+    record.size = udt.size;
+    record.kind = std::get<SymbolUdt>(udt.variant).kind;
+    record.fieldCount = static_cast<uint32_t>(storeFields.size());
+
+    records.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    records.append(reinterpret_cast<const char*>(storeFields.data()), storeFields.size() * sizeof(SymbolTypeStoreField));
+    records += strings;
+    records.resize(records.size() + record.recordSize - unalignedSize, '\0');
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "PDB.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// On-disk layout of a type store. All integers are little endian.
+//
+// types.dat is a header followed by type records, appended one after the
+// other at 8-byte boundaries and never rewritten, so the file is mapped
+// and read in place. A record is followed by its fields and then by its
+// strings, which the fields address by offset from the end of the fields.
+//
+// types.idx is an array of index entries, appended after the records they
+// point to are written. Records a failed ingest left behind without an
+// entry are unreachable and written again by the next ingest.
+//
+// manifests/<pdb name>/<GUID><age> lists the types of one PDB by name,
+// with the hash of each, like the layout of a symbol store.
+//
+
+#pragma pack(push, 4)
+
+struct SymbolTypeStoreHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct SymbolTypeStoreRecord
+{
+    uint64_t hash;
+    uint32_t recordSize;                // including fields, strings and alignment
+    uint32_t size;
+    uint32_t kind;                      // UdtKind
+    uint32_t fieldCount;
+};
+
+struct SymbolTypeStoreField
+{
+    uint32_t pathOffset;                // dotted path for members of unnamed nested types
+    uint32_t typeNameOffset;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t bits;
+    uint32_t bitPosition;
+};
+
+struct SymbolTypeStoreIndexEntry
+{
+    uint64_t hash;
+    uint64_t recordOffset;
+};
+
+#pragma pack(pop)
+
+struct SymbolTypeStoreManifest
+{
+    std::string pdbName;
+    GUID guid = {};
+    DWORD age = 0;
+
+    // Seconds since the Unix epoch.
+    int64_t ingestTime = 0;
+
+    // Sorted by name.
+    std::vector<std::pair<std::string, uint64_t>> types;
+};
+
+struct SymbolTypeStoreIngestResult
+{
+    size_t typeCount = 0;
+    size_t newTypeCount = 0;
+    uint64_t bytesWritten = 0;
+
+    // The manifest of this PDB existed; nothing was written.
+    bool isKnownPdb = false;
+};
+
+//
+// Persistent store of type layouts shared by many PDBs, typically many
+// builds of the same binaries. Every distinct layout is kept once, keyed
+// by its structural hash (see SymbolTypeDiff), and each PDB adds only a
+// manifest and the layouts no earlier PDB had.
+//
+// A hash hit is confirmed by comparing the stored record, so layouts are
+// never conflated: a layout whose hash collides with a different one is
+// stored under the next hash value no other layout has, and manifests
+// record that value. Types of different names sharing a layout share its
+// record.
+//
+// One process ingests at a time; any number may read.
+//
+class SymbolTypeStore
+{
+public:
+    SymbolTypeStore() = default;
+    ~SymbolTypeStore();
+
+    SymbolTypeStore(const SymbolTypeStore&) = delete;
+    SymbolTypeStore& operator=(const SymbolTypeStore&) = delete;
+
+    // Creates an empty store when the directory holds none.
+    bool Open(const std::filesystem::path& directory);
+    void Close();
+    bool IsOpen() const;
+
+    // Needs a fully loaded PDB.
+    bool Ingest(PDB& pdb, SymbolTypeStoreIngestResult& result);
+
+    // Oldest ingest first.
+    void GetManifestPaths(std::vector<std::filesystem::path>& paths) const;
+    bool ReadManifest(const std::filesystem::path& path, SymbolTypeStoreManifest& manifest) const;
+
+    // Records stay valid until the store is closed or ingests a PDB.
+    const SymbolTypeStoreRecord* FindRecord(uint64_t hash) const;
+    static const SymbolTypeStoreField* GetFields(const SymbolTypeStoreRecord& record);
+    static const char* GetString(const SymbolTypeStoreRecord& record, uint32_t stringOffset);
+
+private:
+    bool Map();
+    void Unmap();
+    void LoadIndex();
+    bool AppendRecords(const std::string& records, std::vector<SymbolTypeStoreIndexEntry>& entries);
+    bool WriteManifest(const std::filesystem::path& path, const SymbolTypeStoreManifest& manifest) const;
+
+    static void AppendRecord(std::string& records, uint64_t hash, const Symbol& udt);
+
+private:
+    std::filesystem::path m_directory;
+
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    uint64_t m_size = 0;
+
+    // Hash -> offset of the record in types.dat
+    std::unordered_map<uint64_t, uint64_t> m_index;
+};
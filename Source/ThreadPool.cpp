@@ -0,0 +1,174 @@
+#include "ThreadPool.h"
+
+namespace
+{
+    // Pool and queue of the worker running on this thread, if any.
+    thread_local const ThreadPool* t_currentPool = nullptr;
+    thread_local size_t t_currentQueueIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+
+    m_queues.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::WorkerRoutine, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_taskAvailable.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(Task task)
+{
+    size_t queueIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Counted before the task is visible, so a worker finishing it
+        // early never sees the pending count drop below it.
+        ++m_pendingTaskCount;
+        ++m_queuedTaskCount;
+
+        queueIndex = t_currentPool == this ? t_currentQueueIndex : m_nextQueueIndex++ % m_queues.size();
+    }
+
+    {
+        auto& queue = *m_queues[queueIndex];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasksDone.wait(lock, [this] { return m_pendingTaskCount == 0; });
+
+    if (m_firstException)
+    {
+        auto exception = std::move(m_firstException);
+        m_firstException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+    return m_threads.size();
+}
+
+void ThreadPool::WorkerRoutine(size_t queueIndex)
+{
+    t_currentPool = this;
+    t_currentQueueIndex = queueIndex;
+
+    for (;;)
+    {
+        Task task;
+
+        if (!PopTask(queueIndex, task))
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this] { return m_stop || m_queuedTaskCount != 0; });
+
+            if (m_queuedTaskCount == 0)
+            {
+                return;
+            }
+
+            // A task was counted but may not be queued yet; look again.
+            continue;
+        }
+
+        std::exception_ptr exception;
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (exception && !m_firstException)
+            {
+                m_firstException = exception;
+            }
+
+            if (--m_pendingTaskCount == 0)
+            {
+                m_tasksDone.notify_all();
+            }
+        }
+    }
+}
+
+bool ThreadPool::PopTask(size_t queueIndex, Task& task)
+{
+    const size_t queueCount = m_queues.size();
+
+    for (size_t i = 0; i < queueCount; ++i)
+    {
+        auto& queue = *m_queues[(queueIndex + i) % queueCount];
+        const bool isOwnQueue = i == 0;
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+
+            if (isOwnQueue)
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            else
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_queuedTaskCount;
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Every worker owns a task queue. Tasks submitted from outside the pool are
+// spread over the queues in turn; tasks submitted by a task go to the queue
+// of the worker running it. Workers take their own tasks oldest first and,
+// once their queue is empty, steal the newest task of another worker, which
+// is usually the last piece of work split off by a busy task.
+//
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(Task task);
+
+    // Blocks until every submitted task has finished and rethrows the first
+    // exception thrown by any of them. Must not be called from a task.
+    void Wait();
+
+    size_t GetThreadCount() const;
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerRoutine(size_t queueIndex);
+    bool PopTask(size_t queueIndex, Task& task);
+
+private:
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    size_t m_nextQueueIndex = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_tasksDone;
+    size_t m_pendingTaskCount = 0;
+    size_t m_queuedTaskCount = 0;
+    std::exception_ptr m_firstException;
+    bool m_stop = false;
+};
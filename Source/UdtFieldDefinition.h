@@ -4,7 +4,7 @@
 #include <stack>
 #include <vector>
 
-class UdtFieldDefinition : public UdtFieldDefinitionBase
+class UdtFieldDefinition final : public UdtFieldDefinitionBase
 {
 public:
     void VisitBaseType(const Symbol& symbol) override;
@@ -0,0 +1,274 @@
+#include <winsock2.h>
+#include <afunix.h>
+
+#include "UnixSocket.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <mutex>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace
+{
+    const size_t ReadChunkSize = 16 * 1024;
+
+    bool InitializeWinsock()
+    {
+        static std::once_flag initialized;
+        static bool result = false;
+
+        std::call_once(initialized, []()
+        {
+            WSADATA wsaData;
+            result = WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+        });
+
+        return result;
+    }
+
+    bool MakeAddress(const std::filesystem::path& path, sockaddr_un& address)
+    {
+        const std::string pathString = path.string();
+
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (pathString.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+
+        memcpy(address.sun_path, pathString.c_str(), pathString.size());
+        return true;
+    }
+}
+
+UnixSocket::UnixSocket()
+    : m_socket(INVALID_SOCKET)
+{
+
+}
+
+UnixSocket::~UnixSocket()
+{
+    Close();
+}
+
+UnixSocket::UnixSocket(UnixSocket&& other) noexcept
+    : m_socket(other.m_socket)
+    , m_readBuffer(std::move(other.m_readBuffer))
+    , m_readOffset(other.m_readOffset)
+{
+    other.m_socket = INVALID_SOCKET;
+    other.m_readOffset = 0;
+}
+
+UnixSocket& UnixSocket::operator=(UnixSocket&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+
+        m_socket = other.m_socket;
+        m_readBuffer = std::move(other.m_readBuffer);
+        m_readOffset = other.m_readOffset;
+
+        other.m_socket = INVALID_SOCKET;
+        other.m_readOffset = 0;
+    }
+
+    return *this;
+}
+
+bool UnixSocket::Listen(const std::filesystem::path& path)
+{
+    Close();
+
+    sockaddr_un address;
+    if (!InitializeWinsock() || !MakeAddress(path, address))
+    {
+        return false;
+    }
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::remove(path, errorCode);
+
+    if (bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+        listen(m_socket, SOMAXCONN) == SOCKET_ERROR)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool UnixSocket::Accept(UnixSocket& client)
+{
+    const SOCKET clientSocket = accept(m_socket, nullptr, nullptr);
+    if (clientSocket == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    client.Close();
+    client.m_socket = clientSocket;
+    return true;
+}
+
+bool UnixSocket::Connect(const std::filesystem::path& path)
+{
+    Close();
+
+    sockaddr_un address;
+    if (!InitializeWinsock() || !MakeAddress(path, address))
+    {
+        return false;
+    }
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    if (connect(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void UnixSocket::Close()
+{
+    if (m_socket != INVALID_SOCKET)
+    {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    m_readBuffer.clear();
+    m_readOffset = 0;
+}
+
+bool UnixSocket::IsOpen() const
+{
+    return m_socket != INVALID_SOCKET;
+}
+
+bool UnixSocket::ReadLine(std::string& line, size_t maxSize, bool* isTooLong)
+{
+    if (isTooLong)
+    {
+        *isTooLong = false;
+    }
+
+    // Bytes past m_readOffset already searched; Fill moves the unread
+    // bytes but keeps them in order, so this stays valid across it.
+    size_t searchedSize = 0;
+
+    for (;;)
+    {
+        const size_t newLine = m_readBuffer.find('\n', m_readOffset + searchedSize);
+        if (newLine != std::string::npos)
+        {
+            size_t end = newLine;
+            if (end > m_readOffset && m_readBuffer[end - 1] == '\r')
+            {
+                --end;
+            }
+
+            line.assign(m_readBuffer, m_readOffset, end - m_readOffset);
+            m_readOffset = newLine + 1;
+            return true;
+        }
+
+        searchedSize = m_readBuffer.size() - m_readOffset;
+
+        if (searchedSize > maxSize)
+        {
+            if (isTooLong)
+            {
+                *isTooLong = true;
+            }
+
+            return false;
+        }
+
+        if (!Fill())
+        {
+            return false;
+        }
+    }
+}
+
+bool UnixSocket::Read(std::string& data, size_t size)
+{
+    while (m_readBuffer.size() - m_readOffset < size)
+    {
+        if (!Fill())
+        {
+            return false;
+        }
+    }
+
+    data.assign(m_readBuffer, m_readOffset, size);
+    m_readOffset += size;
+    return true;
+}
+
+bool UnixSocket::Write(const char* data, size_t size)
+{
+    while (size != 0)
+    {
+        const int chunkSize = static_cast<int>((std::min)(size, static_cast<size_t>(INT_MAX)));
+        const int sent = send(m_socket, data, chunkSize, 0);
+        if (sent == SOCKET_ERROR || sent == 0)
+        {
+            return false;
+        }
+
+        data += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+bool UnixSocket::Write(const std::string& data)
+{
+    return Write(data.data(), data.size());
+}
+
+bool UnixSocket::Fill()
+{
+    // Drop consumed bytes before growing the buffer.
+    if (m_readOffset != 0)
+    {
+        m_readBuffer.erase(0, m_readOffset);
+        m_readOffset = 0;
+    }
+
+    const size_t previousSize = m_readBuffer.size();
+    m_readBuffer.resize(previousSize + ReadChunkSize);
+
+    const int received = recv(m_socket, &m_readBuffer[previousSize], static_cast<int>(ReadChunkSize), 0);
+    if (received == SOCKET_ERROR || received == 0)
+    {
+        m_readBuffer.resize(previousSize);
+        return false;
+    }
+
+    m_readBuffer.resize(previousSize + received);
+    return true;
+}
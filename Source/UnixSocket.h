@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+
+//
+// Minimal blocking stream socket over AF_UNIX (Windows 10 1803+). Winsock
+// headers stay in the .cpp so this can be included next to windows.h.
+//
+class UnixSocket
+{
+public:
+    UnixSocket();
+    ~UnixSocket();
+
+    UnixSocket(UnixSocket&& other) noexcept;
+    UnixSocket& operator=(UnixSocket&& other) noexcept;
+
+    UnixSocket(const UnixSocket&) = delete;
+    UnixSocket& operator=(const UnixSocket&) = delete;
+
+    // Removes a stale socket file left by a previous run before binding.
+    bool Listen(const std::filesystem::path& path);
+    bool Accept(UnixSocket& client);
+    bool Connect(const std::filesystem::path& path);
+    void Close();
+    bool IsOpen() const;
+
+    // Reads up to and excluding the next '\n' (a trailing '\r' is dropped).
+    // Fails once more than maxSize bytes arrive without a '\n', setting
+    // *isTooLong; the rest of that line is left unread.
+    bool ReadLine(std::string& line, size_t maxSize = (std::numeric_limits<size_t>::max)(), bool* isTooLong = nullptr);
+    bool Read(std::string& data, size_t size);
+    bool Write(const char* data, size_t size);
+    bool Write(const std::string& data);
+
+private:
+    bool Fill();
+
+private:
+    uintptr_t m_socket;
+    std::string m_readBuffer;
+    size_t m_readOffset = 0;
+};
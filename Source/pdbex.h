@@ -0,0 +1,135 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// C interface of pdbex.dll, for tools that would otherwise run pdbex and
+// parse its output.
+//
+// A handle is opened on a PDB or on a layout file written with -f b, and
+// stays valid until it is closed. Opening a PDB loads it completely,
+// public symbols included, so every later call only reads and any number
+// of threads may use one handle at once. Strings returned through a
+// handle live as long as the handle.
+//
+// A handle on a PDB initializes COM on the opening thread, unless the
+// thread already is in the multithreaded apartment, and uninitializes it
+// when the handle is closed. Such a handle has to be closed on the thread
+// that opened it.
+//
+// The interface is stable: functions and structures are never changed or
+// removed once published, and additions raise PDBEX_API_VERSION.
+//
+
+#if defined(PDBEX_BUILD_LIBRARY)
+#define PDBEX_API __declspec(dllexport)
+#else
+#define PDBEX_API __declspec(dllimport)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PDBEX_API_VERSION 1
+
+#define PDBEX_INVALID_INDEX 0xffffffffu
+
+typedef struct pdbex_handle pdbex_handle;
+
+typedef enum pdbex_status
+{
+    PDBEX_OK = 0,
+    PDBEX_INVALID_ARGUMENT = 1,
+    PDBEX_OPEN_FAILED = 2,
+    PDBEX_NOT_FOUND = 3,
+    PDBEX_BUFFER_TOO_SMALL = 4,
+    PDBEX_NOT_SUPPORTED = 5,
+    PDBEX_INTERNAL_ERROR = 6,
+} pdbex_status;
+
+typedef enum pdbex_type_kind
+{
+    PDBEX_TYPE_STRUCT = 0,
+    PDBEX_TYPE_CLASS = 1,
+    PDBEX_TYPE_UNION = 2,
+    PDBEX_TYPE_INTERFACE = 3,
+} pdbex_type_kind;
+
+typedef enum pdbex_field_flags
+{
+    PDBEX_FIELD_STATIC = 0x0001,
+    PDBEX_FIELD_BITFIELD = 0x0002,
+    PDBEX_FIELD_POINTER = 0x0004,
+    PDBEX_FIELD_ARRAY = 0x0008,
+} pdbex_field_flags;
+
+typedef struct pdbex_type
+{
+    const char* name;
+    uint32_t index;
+    uint32_t size;
+    uint32_t kind;                      // pdbex_type_kind
+    uint32_t field_count;
+} pdbex_type;
+
+//
+// Members of unnamed nested types are flattened into their parent with
+// dotted names; base classes appear as members named after the base.
+//
+typedef struct pdbex_field
+{
+    const char* name;
+    const char* type_name;
+    uint32_t offset;                    // from the start of the owning type
+    uint32_t size;
+    uint32_t type_index;                // by-value (or array element) type, or PDBEX_INVALID_INDEX
+    uint16_t flags;                     // pdbex_field_flags
+    uint8_t bits;
+    uint8_t bit_position;
+} pdbex_field;
+
+//
+// name is not NUL-terminated; it is empty when no public symbol covers the
+// address.
+//
+typedef struct pdbex_address
+{
+    const char* name;
+    size_t name_length;
+    uint32_t section;
+    uint32_t offset;
+    uint32_t displacement;
+} pdbex_address;
+
+PDBEX_API uint32_t pdbex_get_api_version(void);
+
+// path is UTF-8.
+PDBEX_API pdbex_status pdbex_open(const char* path, pdbex_handle** handle);
+PDBEX_API void pdbex_close(pdbex_handle* handle);
+
+//
+// Types are the named structures, classes and unions with a definition,
+// numbered from 0.
+//
+PDBEX_API uint32_t pdbex_get_type_count(const pdbex_handle* handle);
+PDBEX_API pdbex_status pdbex_get_type(const pdbex_handle* handle, uint32_t type_index, pdbex_type* type);
+PDBEX_API pdbex_status pdbex_find_type(const pdbex_handle* handle, const char* name, pdbex_type* type);
+PDBEX_API pdbex_status pdbex_get_field(const pdbex_handle* handle, uint32_t type_index, uint32_t field_index, pdbex_field* field);
+
+// Offset of the last member of "Type.member.member".
+PDBEX_API pdbex_status pdbex_get_field_offset(const pdbex_handle* handle, const char* path, uint32_t* offset);
+
+//
+// Writes the C declarations of a type and everything it contains by value,
+// NUL-terminated. required_size receives the size including the NUL even
+// when the buffer is too small. Needs a handle opened on a PDB.
+//
+PDBEX_API pdbex_status pdbex_render_type(pdbex_handle* handle, const char* name, char* buffer, size_t buffer_size, size_t* required_size);
+
+// Resolves RVAs to public symbols. Needs a handle opened on a PDB.
+PDBEX_API pdbex_status pdbex_symbolize(pdbex_handle* handle, const uint32_t* rvas, size_t count, pdbex_address* addresses);
+
+#ifdef __cplusplus
+}
+#endif